@@ -0,0 +1,335 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+/*
+ * Benchmark serialization and deserialization of FrameSets of increasing complexity.
+ *
+ * FrameSets are built with a varying number of frames, polynomial order of the distortion PolyMap
+ * and size of a LutMap, then round-tripped through every channel type (Channel, FitsChan with NATIVE
+ * encoding and XmlChan), through StringStream, FileStream and CompressedFileStream (gzip, and zstd
+ * if available), as well as through Object::show and Object::fromString. Many objects are also read
+ * from one Channel or XmlChan, sequentially and with Channel::readAll. Results include bytes/sec,
+ * objects/sec, the size of compressed files and the peak resident set size of the process after each case.
+ *
+ * Run from the package root directory, e.g.:
+ *
+ *     benchmarks/benchChannel --output channel.json
+ */
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "ndarray.h"
+
+#include "astshim.h"
+#include "benchUtils.h"
+
+namespace {
+
+/// Parameters describing the complexity of a FrameSet
+struct Complexity {
+    int nFrames;
+    int polyOrder;
+    int lutSize;
+
+    std::string name() const {
+        return "nFrames=" + std::to_string(nFrames) + ",polyOrder=" + std::to_string(polyOrder) +
+               ",lutSize=" + std::to_string(lutSize);
+    }
+};
+
+/// Make a 2-in, 2-out PolyMap with all terms up to the specified total order
+ast::PolyMap makePolyMap(int order) {
+    std::vector<double> coeffVec;
+    for (int out = 1; out <= 2; ++out) {
+        for (int i = 0; i <= order; ++i) {
+            for (int j = 0; i + j <= order; ++j) {
+                bool const isLinear = (out == 1 && i == 1 && j == 0) || (out == 2 && i == 0 && j == 1);
+                coeffVec.insert(coeffVec.end(), {isLinear ? 1.0 : 1.0e-4 / (1 + i + j), static_cast<double>(out),
+                                                 static_cast<double>(i), static_cast<double>(j)});
+            }
+        }
+    }
+    std::size_t const rowLen = 4;
+    ast::Array2D coeffs = ndarray::allocate(ndarray::makeVector(coeffVec.size() / rowLen, rowLen));
+    std::copy(coeffVec.begin(), coeffVec.end(), coeffs.getData());
+    return ast::PolyMap(coeffs, 2);
+}
+
+/**
+Make a FrameDict with the specified complexity
+
+The frames are connected in series: each frame after the first is connected to the previous frame
+by a mapping that alternates between the PolyMap and a ParallelMap containing two LutMaps.
+*/
+std::shared_ptr<ast::FrameSet> makeFrameSet(Complexity const &complexity) {
+    auto const polyMap = makePolyMap(complexity.polyOrder);
+    std::vector<double> lut;
+    for (int i = 0; i < complexity.lutSize; ++i) {
+        lut.push_back(i + 0.01 * i * i);
+    }
+    auto const lutMap = ast::LutMap(lut, 0, 1);
+    auto const lutMap2 = lutMap.under(lutMap);
+
+    auto frameSet = std::make_shared<ast::FrameSet>(ast::Frame(2, "Domain=FRAME1"));
+    for (int i = 2; i <= complexity.nFrames; ++i) {
+        ast::Frame const frame(2, "Domain=FRAME" + std::to_string(i));
+        if (i % 2 == 0) {
+            frameSet->addFrame(ast::FrameSet::CURRENT, polyMap, frame);
+        } else {
+            frameSet->addFrame(ast::FrameSet::CURRENT, lutMap2, frame);
+        }
+    }
+    return frameSet;
+}
+
+/// A kind of channel, with the options used to construct it
+struct ChannelType {
+    std::string name;
+    std::string options;
+
+    std::unique_ptr<ast::Channel> makeChannel(ast::Stream &stream) const {
+        if (name == "Channel") {
+            return std::unique_ptr<ast::Channel>(new ast::Channel(stream, options));
+        } else if (name == "FitsChan") {
+            return std::unique_ptr<ast::Channel>(new ast::FitsChan(stream, options));
+        } else if (name == "XmlChan") {
+            return std::unique_ptr<ast::Channel>(new ast::XmlChan(stream, options));
+        }
+        throw std::invalid_argument("Unknown channel type " + name);
+    }
+};
+
+/// Write `obj` to a new channel of the specified type on a StringStream and return the text
+std::string writeToString(ChannelType const &chanType, ast::Object const &obj) {
+    ast::StringStream stream;
+    {
+        auto channel = chanType.makeChannel(stream);
+        channel->write(obj);
+    }  // a FitsChan writes its cards when destroyed
+    return stream.getSinkData();
+}
+
+/// The timing of an operation, and how much it raised the peak resident set size of the process
+struct RssTiming {
+    ast::bench::Timing timing;
+    double peakRssGrowthBytes;
+};
+
+/**
+Time `func` using ast::bench::timeIt, also measuring the growth of the peak RSS
+
+The peak RSS of the process never decreases, so report its growth during each operation
+rather than its value, which would be the same for every operation after the largest one.
+*/
+template <typename Func>
+RssTiming timeItWithRss(Func &&func, double minTime) {
+    double const peakRssBefore = ast::bench::peakRssBytes();
+    auto const timing = ast::bench::timeIt(std::forward<Func>(func), minTime);
+    return RssTiming{timing, ast::bench::peakRssBytes() - peakRssBefore};
+}
+
+/// Size of a file, in bytes
+double fileBytes(std::string const &path) {
+    std::ifstream file(path, std::ios_base::binary | std::ios_base::ate);
+    return static_cast<double>(file.tellg());
+}
+
+/// Round-trip `obj` through a channel type using StringStream and FileStream
+void benchChannel(std::string const &name, ChannelType const &chanType, ast::Object const &obj,
+                  ast::bench::Options const &opts, ast::bench::Reporter &reporter) {
+    std::string const text = writeToString(chanType, obj);
+    double const nBytes = text.size();
+    std::string const opPrefix = chanType.name + "(" + chanType.options + ")";
+
+    auto addResult = [&](std::string const &operation, RssTiming const &result) {
+        reporter.add(ast::bench::Result{name, opPrefix + "." + operation, {}}
+                             .addTiming(result.timing, 1, "objects")
+                             .add("bytes", nBytes)
+                             .add("bytesPerSecond", nBytes / result.timing.meanSec)
+                             .add("peakRssGrowthBytes", result.peakRssGrowthBytes));
+    };
+
+    addResult("write(StringStream)", timeItWithRss([&] { writeToString(chanType, obj); }, opts.minTime));
+    addResult("read(StringStream)", timeItWithRss(
+                                            [&] {
+                                                ast::StringStream stream(text);
+                                                chanType.makeChannel(stream)->read();
+                                            },
+                                            opts.minTime));
+
+    std::string const path = "benchChannel_" + std::to_string(getpid()) + ".tmp";
+    addResult("write(FileStream)", timeItWithRss(
+                                           [&] {
+                                               ast::FileStream stream(path, true);
+                                               chanType.makeChannel(stream)->write(obj);
+                                           },
+                                           opts.minTime));
+    addResult("read(FileStream)", timeItWithRss(
+                                          [&] {
+                                              ast::FileStream stream(path);
+                                              chanType.makeChannel(stream)->read();
+                                          },
+                                          opts.minTime));
+    std::remove(path.c_str());
+
+    // compressed files; bytes and bytesPerSecond refer to the uncompressed text, for comparison
+    for (auto compression : {ast::Compression::GZIP, ast::Compression::ZSTD}) {
+        if (!ast::CompressedFileStream::isAvailable(compression)) {
+            continue;
+        }
+        std::string const format = compression == ast::Compression::GZIP ? "gzip" : "zstd";
+        auto addCompressedResult = [&](std::string const &operation, RssTiming const &result) {
+            reporter.add(ast::bench::Result{name, opPrefix + "." + operation, {}}
+                                 .addTiming(result.timing, 1, "objects")
+                                 .add("bytes", nBytes)
+                                 .add("fileBytes", fileBytes(path))
+                                 .add("bytesPerSecond", nBytes / result.timing.meanSec)
+                                 .add("peakRssGrowthBytes", result.peakRssGrowthBytes));
+        };
+        addCompressedResult("write(CompressedFileStream(" + format + "))",
+                            timeItWithRss(
+                                    [&] {
+                                        ast::CompressedFileStream stream(path, true, compression);
+                                        chanType.makeChannel(stream)->write(obj);
+                                        stream.close();
+                                    },
+                                    opts.minTime));
+        addCompressedResult("read(CompressedFileStream(" + format + "))",
+                            timeItWithRss(
+                                    [&] {
+                                        ast::CompressedFileStream stream(path);
+                                        chanType.makeChannel(stream)->read();
+                                    },
+                                    opts.minTime));
+        std::remove(path.c_str());
+    }
+}
+
+/// Read many copies of `obj` from one channel, sequentially with read and in parallel with readAll
+void benchReadAll(std::string const &name, ChannelType const &chanType, ast::Object const &obj,
+                  ast::bench::Options const &opts, ast::bench::Reporter &reporter) {
+    int const nObjects = 64;
+    ast::StringStream writeStream;
+    {
+        auto channel = chanType.makeChannel(writeStream);
+        for (int i = 0; i < nObjects; ++i) {
+            channel->write(obj);
+        }
+    }
+    std::string const text = writeStream.getSinkData();
+    double const nBytes = text.size();
+    std::string const opPrefix = chanType.name + "(" + chanType.options + ")";
+
+    auto addResult = [&](std::string const &operation, RssTiming const &result) {
+        reporter.add(ast::bench::Result{name, opPrefix + "." + operation, {}}
+                             .addTiming(result.timing, nObjects, "objects")
+                             .add("bytes", nBytes)
+                             .add("bytesPerSecond", nBytes / result.timing.meanSec)
+                             .add("peakRssGrowthBytes", result.peakRssGrowthBytes));
+    };
+    addResult("read*" + std::to_string(nObjects) + "(StringStream)",
+              timeItWithRss(
+                      [&] {
+                          ast::StringStream stream(text);
+                          auto channel = chanType.makeChannel(stream);
+                          for (int i = 0; i < nObjects; ++i) {
+                              channel->read();
+                          }
+                      },
+                      opts.minTime));
+    addResult("readAll*" + std::to_string(nObjects) + "(StringStream)",
+              timeItWithRss(
+                      [&] {
+                          ast::StringStream stream(text);
+                          chanType.makeChannel(stream)->readAll();
+                      },
+                      opts.minTime));
+}
+
+/// Round-trip `obj` through Object::show and Object::fromString
+void benchShow(std::string const &name, ast::Object const &obj, ast::bench::Options const &opts,
+               ast::bench::Reporter &reporter) {
+    std::string const text = obj.show(false);
+    double const nBytes = text.size();
+    for (bool showComments : {true, false}) {
+        auto result = timeItWithRss([&] { obj.show(showComments); }, opts.minTime);
+        reporter.add(ast::bench::Result{name, showComments ? "show(comments)" : "show", {}}
+                             .addTiming(result.timing, 1, "objects")
+                             .add("bytes", obj.show(showComments).size())
+                             .add("bytesPerSecond", obj.show(showComments).size() / result.timing.meanSec)
+                             .add("peakRssGrowthBytes", result.peakRssGrowthBytes));
+    }
+    auto result = timeItWithRss([&] { ast::Object::fromString(text); }, opts.minTime);
+    reporter.add(ast::bench::Result{name, "fromString", {}}
+                         .addTiming(result.timing, 1, "objects")
+                         .add("bytes", nBytes)
+                         .add("bytesPerSecond", nBytes / result.timing.meanSec)
+                         .add("peakRssGrowthBytes", result.peakRssGrowthBytes));
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    auto const opts = ast::bench::parseArgs(argc, argv);
+    ast::bench::Reporter reporter("channel", opts);
+
+    std::vector<Complexity> const complexities = {
+            {2, 1, 2},      // minimal
+            {3, 3, 100},    // typical single-detector WCS
+            {5, 5, 100},    // typical camera geometry
+            {10, 5, 1000},  // many frames
+            {5, 9, 1000},   // high-order distortion
+            {5, 5, 100000}, // large lookup tables
+    };
+    std::vector<ChannelType> const chanTypes = {
+            {"Channel", ""},
+            {"Channel", "Comment=0, Full=-1"},
+            {"FitsChan", "Encoding=NATIVE"},
+            {"XmlChan", ""},
+    };
+
+    for (auto const &complexity : complexities) {
+        std::string const name = "FrameSet(" + complexity.name() + ")";
+        if (!opts.wanted(name)) {
+            continue;
+        }
+        auto const frameSet = makeFrameSet(complexity);
+        for (auto const &chanType : chanTypes) {
+            benchChannel(name, chanType, *frameSet, opts, reporter);
+            if (chanType.name != "FitsChan") {
+                benchReadAll(name, chanType, *frameSet, opts, reporter);
+            }
+        }
+        benchShow(name, *frameSet, opts, reporter);
+    }
+    reporter.write();
+    return 0;
+}
@@ -0,0 +1,358 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+/*
+ * Benchmark FITS header ingest and WCS construction with FitsChan.
+ *
+ * Synthetic headers are generated for several encodings (FITS-WCS TAN, TAN-SIP, TPV and TAB,
+ * DSS and NATIVE), padded with a varying number of non-WCS cards, plus the header in
+ * examples/simple.fits (as used by examples/readwcs.cc). For each header this separately times:
+ * - putCards: adding all cards to an empty FitsChan as a single string
+ * - streamIngest: constructing a FitsChan on a StringStream and reading all cards from it
+ * - getAllCardNames
+ * - read: constructing a FrameSet from the cards
+ * - write: writing that FrameSet to an empty FitsChan using the same encoding
+ *
+ * Run from the package root directory, e.g.:
+ *
+ *     benchmarks/benchFitsChan --output fitsChan.json
+ */
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "astshim.h"
+#include "benchUtils.h"
+
+namespace {
+
+/// A synthetic FITS header and the FitsChan options used to read and write it
+struct HeaderCase {
+    std::string name;
+    std::string options;
+    std::vector<std::string> cards;
+    bool canRead;  ///< can AST read a FrameSet from this header without additional data?
+};
+
+/// Format a FITS header card as exactly 80 characters
+std::string makeCard(std::string const &keyword, std::string const &value = "") {
+    std::string card = keyword;
+    card.resize(8, ' ');
+    if (!value.empty()) {
+        card += "= " + value;
+    }
+    card.resize(ast::detail::FITSLEN, ' ');
+    return card;
+}
+
+std::string numCard(std::string const &keyword, double value) {
+    char buf[30];
+    std::snprintf(buf, sizeof(buf), "%20.13G", value);
+    return makeCard(keyword, buf);
+}
+
+std::string strCard(std::string const &keyword, std::string const &value) {
+    return makeCard(keyword, "'" + value + "'");
+}
+
+/// Cards for a 2-d celestial TAN-based WCS with the specified projection code
+std::vector<std::string> celestialCards(std::string const &proj) {
+    return {
+            numCard("NAXIS", 2),
+            numCard("NAXIS1", 4000),
+            numCard("NAXIS2", 4000),
+            strCard("CTYPE1", "RA---" + proj),
+            strCard("CTYPE2", "DEC--" + proj),
+            numCard("CRPIX1", 2000.5),
+            numCard("CRPIX2", 2000.5),
+            numCard("CRVAL1", 150.1),
+            numCard("CRVAL2", 2.2),
+            numCard("CD1_1", -5.0e-5),
+            numCard("CD1_2", 1.0e-7),
+            numCard("CD2_1", -1.0e-7),
+            numCard("CD2_2", 5.0e-5),
+            strCard("RADESYS", "ICRS"),
+    };
+}
+
+std::vector<std::string> makeTanCards() { return celestialCards("TAN"); }
+
+std::vector<std::string> makeSipCards() {
+    auto cards = celestialCards("TAN-SIP");
+    for (std::string const prefix : {"A", "B", "AP", "BP"}) {
+        cards.push_back(numCard(prefix + "_ORDER", 3));
+        double const sign = (prefix.size() == 1) ? 1 : -1;
+        for (int i = 0; i <= 3; ++i) {
+            for (int j = 0; i + j <= 3; ++j) {
+                if (i + j >= 2) {
+                    double const coeff = sign * 1.0e-6 / (1 + i + 2 * j) * std::pow(1e-3, i + j - 2);
+                    cards.push_back(numCard(prefix + "_" + std::to_string(i) + "_" + std::to_string(j), coeff));
+                }
+            }
+        }
+    }
+    return cards;
+}
+
+std::vector<std::string> makeTpvCards() {
+    auto cards = celestialCards("TPV");
+    for (int axis = 1; axis <= 2; ++axis) {
+        for (int term = 0; term <= 10; ++term) {
+            double coeff = (term == 1) ? 1.0 : 1.0e-3 / (term + axis);
+            if (term == 3) {
+                continue;  // PVi_3 is the radial term, which is not used here
+            }
+            cards.push_back(numCard("PV" + std::to_string(axis) + "_" + std::to_string(term), coeff));
+        }
+    }
+    return cards;
+}
+
+std::vector<std::string> makeTabCards() {
+    return {
+            numCard("NAXIS", 1),
+            numCard("NAXIS1", 1000),
+            strCard("CTYPE1", "WAVE-TAB"),
+            strCard("CUNIT1", "m"),
+            numCard("CRPIX1", 1),
+            numCard("CRVAL1", 1),
+            numCard("CDELT1", 1),
+            strCard("PS1_0", "WCS-TAB"),
+            strCard("PS1_1", "COORDS"),
+            numCard("PV1_3", 1),
+    };
+}
+
+std::vector<std::string> makeDssCards() {
+    std::vector<std::string> cards = {
+            numCard("NAXIS", 2),
+            numCard("NAXIS1", 1000),
+            numCard("NAXIS2", 1000),
+            numCard("CNPIX1", 4090),
+            numCard("CNPIX2", 11450),
+            numCard("PLTRAH", 0),
+            numCard("PLTRAM", 51),
+            numCard("PLTRAS", 9.12),
+            strCard("PLTDECSN", "+"),
+            numCard("PLTDECD", 41),
+            numCard("PLTDECM", 35),
+            numCard("PLTDECS", 45.0),
+            numCard("PLTSCALE", 67.2),
+            numCard("XPIXELSZ", 25.28445),
+            numCard("YPIXELSZ", 25.28445),
+            numCard("PPO1", 0),
+            numCard("PPO2", 0),
+            numCard("PPO3", 177436.9),
+            numCard("PPO4", 0),
+            numCard("PPO5", 0),
+            numCard("PPO6", 177436.9),
+    };
+    std::vector<double> const amd = {67.19937, -0.0004928, -2.2e-5, 7.9e-6, 1.2e-5, 3.1e-6, 0,
+                                     -4.4e-7,  0,          1.1e-8,  0,      0,      0};
+    for (std::size_t i = 0; i < amd.size(); ++i) {
+        cards.push_back(numCard("AMDX" + std::to_string(i + 1), amd[i]));
+        cards.push_back(numCard("AMDY" + std::to_string(i + 1), (i == 1 ? -1 : 1) * amd[i]));
+    }
+    return cards;
+}
+
+/// Write `obj` to a FitsChan with the specified options and return the resulting cards
+std::vector<std::string> writeCards(ast::Object const &obj, std::string const &options) {
+    ast::StringStream stream;
+    {
+        ast::FitsChan channel(stream, options);
+        channel.write(obj);
+    }  // the cards are written to the stream when the FitsChan is destroyed
+    std::string const data = stream.getSinkData();
+    std::vector<std::string> cards;
+    for (std::size_t i = 0; i + ast::detail::FITSLEN <= data.size(); i += ast::detail::FITSLEN) {
+        cards.push_back(data.substr(i, ast::detail::FITSLEN));
+    }
+    return cards;
+}
+
+/// Read the cards of a FITS file header (e.g. examples/simple.fits), stopping at the END card
+std::vector<std::string> readFileCards(std::string const &path) {
+    std::ifstream is(path, std::ios::binary);
+    std::vector<std::string> cards;
+    std::string card(ast::detail::FITSLEN, ' ');
+    while (is.read(&card[0], ast::detail::FITSLEN)) {
+        if (card.compare(0, 8, "END     ") == 0) {
+            break;
+        }
+        cards.push_back(card);
+    }
+    return cards;
+}
+
+/// Concatenate cards into one string, as accepted by FitsChan::putCards
+std::string joinCards(std::vector<std::string> const &cards) {
+    std::string result;
+    result.reserve(cards.size() * ast::detail::FITSLEN);
+    for (auto const &card : cards) {
+        result += card;
+    }
+    return result;
+}
+
+std::vector<HeaderCase> makeCases() {
+    std::vector<HeaderCase> cases = {
+            {"FITS-WCS(TAN)", "Encoding=FITS-WCS", makeTanCards(), true},
+            {"FITS-WCS(TAN-SIP)", "Encoding=FITS-WCS", makeSipCards(), true},
+            {"FITS-WCS(TPV)", "Encoding=FITS-WCS", makeTpvCards(), true},
+            // reading -TAB requires the table extension, which FitsChan cannot be given from astshim
+            {"FITS-WCS(TAB)", "Encoding=FITS-WCS, TabOK=1", makeTabCards(), false},
+            {"DSS", "Encoding=DSS", makeDssCards(), true},
+    };
+
+    // make a NATIVE header by writing the TAN-SIP FrameSet with native encoding
+    ast::StringStream sipStream(joinCards(makeSipCards()));
+    ast::FitsChan sipChannel(sipStream);
+    auto sipFrameSet = sipChannel.read();
+    cases.push_back({"NATIVE", "Encoding=NATIVE", writeCards(*sipFrameSet, "Encoding=NATIVE"), true});
+
+    auto fileCards = readFileCards("examples/simple.fits");
+    if (fileCards.empty()) {
+        std::cerr << "Skipping examples/simple.fits: could not read the header" << std::endl;
+    } else {
+        cases.push_back({"simple.fits", "", fileCards, true});
+    }
+    return cases;
+}
+
+/// Return a copy of `cards` with `nExtra` non-WCS cards added, as found in large real-world headers
+std::vector<std::string> padCards(std::vector<std::string> const &cards, int nExtra) {
+    std::vector<std::string> result;
+    result.reserve(cards.size() + nExtra);
+    for (int i = 0; i < nExtra; ++i) {
+        char keyword[9];
+        std::snprintf(keyword, sizeof(keyword), "X%07d", i);
+        result.push_back(makeCard(keyword, std::to_string(i) + " / filler card"));
+    }
+    result.insert(result.end(), cards.begin(), cards.end());
+    return result;
+}
+
+void benchHeader(HeaderCase const &hcase, int nExtra, ast::bench::Options const &opts,
+                 ast::bench::Reporter &reporter) {
+    auto const cards = padCards(hcase.cards, nExtra);
+    auto const text = joinCards(cards);
+    double const nCards = cards.size();
+    std::string const name = hcase.name + "+" + std::to_string(nExtra);
+
+    // Use streams without a sink wherever possible, because a FitsChan writes all of its cards
+    // to its sink when it is destroyed, and that should not be included in the timing.
+    {
+        auto timing = ast::bench::timeIt(
+                [&] {
+                    ast::Stream stream;
+                    ast::FitsChan channel(stream, hcase.options);
+                    channel.putCards(text);
+                },
+                opts.minTime);
+        reporter.add(ast::bench::Result{name, "putCards", {}}.addTiming(timing, nCards, "cards"));
+    }
+    {
+        auto timing = ast::bench::timeIt(
+                [&] {
+                    std::istringstream is(text);
+                    ast::Stream stream(&is, nullptr);
+                    ast::FitsChan channel(stream, hcase.options);
+                    channel.getNCard();  // force the cards to be read from the stream
+                },
+                opts.minTime);
+        reporter.add(ast::bench::Result{name, "streamIngest", {}}.addTiming(timing, nCards, "cards"));
+    }
+    {
+        ast::Stream stream;
+        ast::FitsChan channel(stream, hcase.options);
+        channel.putCards(text);
+        auto timing = ast::bench::timeIt([&] { channel.getAllCardNames(); }, opts.minTime);
+        reporter.add(ast::bench::Result{name, "getAllCardNames", {}}.addTiming(timing, nCards, "cards"));
+    }
+    if (!hcase.canRead) {
+        return;
+    }
+
+    std::shared_ptr<ast::Object> obj;
+    ast::Stream stream;
+    try {
+        std::unique_ptr<ast::FitsChan> channel;
+        auto timing = ast::bench::timeWithSetup(
+                [&] {
+                    channel.reset(new ast::FitsChan(stream, hcase.options));
+                    channel->putCards(text);
+                    channel->clearCard();
+                },
+                [&] { obj = channel->read(); }, opts.minTime);
+        channel.reset();
+        reporter.add(ast::bench::Result{name, "read", {}}
+                             .addTiming(timing, 1, "objects")
+                             .add("cards", nCards)
+                             .add("cardsPerSecond", nCards / timing.meanSec));
+    } catch (std::exception const &e) {
+        std::cerr << name << ": read failed: " << e.what() << std::endl;
+        return;
+    }
+
+    try {
+        std::unique_ptr<ast::FitsChan> channel;
+        int nWritten = 0;
+        auto timing = ast::bench::timeWithSetup(
+                [&] { channel.reset(new ast::FitsChan(stream, hcase.options)); },
+                [&] { nWritten = channel->write(*obj); }, opts.minTime);
+        double const nCardsWritten = channel->getNCard();
+        channel.reset();
+        if (nWritten == 0) {
+            std::cerr << name << ": write failed: object cannot be written with this encoding" << std::endl;
+            return;
+        }
+        reporter.add(ast::bench::Result{name, "write", {}}
+                             .addTiming(timing, 1, "objects")
+                             .add("cards", nCardsWritten)
+                             .add("cardsPerSecond", nCardsWritten / timing.meanSec));
+    } catch (std::exception const &e) {
+        std::cerr << name << ": write failed: " << e.what() << std::endl;
+    }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    auto const opts = ast::bench::parseArgs(argc, argv);
+    ast::bench::Reporter reporter("fitsChan", opts);
+    for (auto const &hcase : makeCases()) {
+        if (!opts.wanted(hcase.name)) {
+            continue;
+        }
+        for (int nExtra : {0, 100, 1000, 10000}) {
+            benchHeader(hcase, nExtra, opts, reporter);
+        }
+    }
+    reporter.write();
+    return 0;
+}
@@ -0,0 +1,81 @@
+#!/usr/bin/env python
+"""Time how long a fresh Python interpreter takes to import astshim
+
+Each case runs a short script in a new subprocess, so that nothing is cached
+in the interpreter, and reports the wall-clock time of the whole process.
+The "baseline" case (an empty script) and "numpy" case (astshim's main
+dependency) let you subtract interpreter startup and numpy import time.
+
+The output is JSON in the same format as the C++ benchmark programs;
+it accepts the same `--output`, `--min-time` and `--filter` arguments.
+"""
+from __future__ import absolute_import, division, print_function
+
+import argparse
+import json
+import subprocess
+import sys
+import time
+
+# (name, script) pairs
+CASES = [
+    ("baseline", "pass"),
+    ("numpy", "import numpy"),
+    ("astshim", "import astshim"),
+    ("astshimFirstUse", "import astshim; astshim.Frame(2).getNAxes()"),
+]
+
+# always run each case at least this many times, to reduce noise
+MIN_ITERATIONS = 5
+
+
+def timeScript(script, minTime):
+    """Run `script` in new interpreters until at least `minTime` seconds
+    have passed and `MIN_ITERATIONS` runs have been made
+
+    Returns
+    -------
+    nIter : `int`
+        Number of runs.
+    meanSec : `float`
+        Mean wall-clock time per run (sec).
+    minSec : `float`
+        Minimum wall-clock time per run (sec).
+    """
+    times = []
+    while len(times) < MIN_ITERATIONS or sum(times) < minTime:
+        t0 = time.time()
+        subprocess.check_call([sys.executable, "-c", script])
+        times.append(time.time() - t0)
+    return len(times), sum(times) / len(times), min(times)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--output", default="", help="path of JSON output; stdout if omitted")
+    parser.add_argument("--min-time", type=float, default=2.0, help="minimum time per case (sec)")
+    parser.add_argument("--filter", default="", help="only run cases whose name contains this text")
+    args = parser.parse_args()
+
+    results = []
+    for name, script in CASES:
+        if args.filter and args.filter not in name:
+            continue
+        nIter, meanSec, minSec = timeScript(script, minTime=args.min_time)
+        result = dict(name=name, operation="import", iterations=nIter,
+                      meanSeconds=meanSec, minSeconds=minSec)
+        results.append(result)
+        print("import: %s import iterations=%d meanSeconds=%g minSeconds=%g" %
+              (name, nIter, meanSec, minSec), file=sys.stderr)
+
+    doc = dict(suite="import", results=results)
+    if args.output:
+        with open(args.output, "w") as outFile:
+            json.dump(doc, outFile, indent=4)
+    else:
+        json.dump(doc, sys.stdout, indent=4)
+        print()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,337 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+/*
+ * Benchmark Mapping operations for every Mapping subclass and for representative compound FrameSets.
+ *
+ * For each case this times applyForward over a sweep of point counts (1, 10, 100... up to --max-points),
+ * applyInverse (if available), tranGridForward (with and without linear approximation), linearApprox,
+ * polyTran (PolyMap and ChebyMap only) and simplified, and writes the results as JSON.
+ *
+ * Run from the package root directory, e.g.:
+ *
+ *     benchmarks/benchMapping --max-points 1e6 --output mapping.json
+ */
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "ndarray.h"
+
+#include "astshim.h"
+#include "benchUtils.h"
+
+namespace {
+
+/**
+A Mapping to benchmark and a box [lo, hi] along each input axis over which to evaluate it
+*/
+struct MappingCase {
+    std::string name;
+    std::shared_ptr<ast::Mapping> mapping;
+    double lo;
+    double hi;
+};
+
+/// Make a matrix of PolyMap or ChebyMap coefficients for a mild 2-dimensional distortion
+ast::Array2D makeDistortionCoeffs() {
+    std::vector<double> const coeffVec = {
+            1.0,   1, 1, 0,  // x' = x
+            0.1,   1, 2, 0,  //    + 0.1 x^2
+            -0.05, 1, 1, 1,  //    - 0.05 x y
+            0.02,  1, 3, 0,  //    + 0.02 x^3
+            1.0,   2, 0, 1,  // y' = y
+            -0.03, 2, 0, 2,  //    - 0.03 y^2
+            0.04,  2, 1, 1,  //    + 0.04 x y
+            0.01,  2, 0, 3,  //    + 0.01 y^3
+    };
+    std::size_t const rowLen = 4;
+    ast::Array2D coeffs = ndarray::allocate(ndarray::makeVector(coeffVec.size() / rowLen, rowLen));
+    std::copy(coeffVec.begin(), coeffVec.end(), coeffs.getData());
+    return coeffs;
+}
+
+/// Read the first object from a file written by a Channel, returning nullptr if the file cannot be read
+template <typename T>
+std::shared_ptr<T> readObject(std::string const &path) {
+    try {
+        ast::FileStream stream(path);
+        ast::Channel channel(stream);
+        return std::dynamic_pointer_cast<T>(channel.read());
+    } catch (std::exception const &e) {
+        std::cerr << "Skipping " << path << ": " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+/// Read a FrameSet from a FITS header file, returning nullptr if the file cannot be read
+std::shared_ptr<ast::FrameSet> readFitsWcs(std::string const &path) {
+    try {
+        ast::FileStream stream(path);
+        ast::FitsChan channel(stream);
+        return std::dynamic_pointer_cast<ast::FrameSet>(channel.read());
+    } catch (std::exception const &e) {
+        std::cerr << "Skipping " << path << ": " << e.what() << std::endl;
+        return nullptr;
+    }
+}
+
+std::vector<MappingCase> makeCases(ast::bench::Options const &opts) {
+    auto const coeffs = makeDistortionCoeffs();
+    std::vector<double> const lbnd = {-1, -1};
+    std::vector<double> const ubnd = {1, 1};
+    auto const polyMap = std::make_shared<ast::PolyMap>(coeffs, 2);
+    auto const fitPolyMap = std::make_shared<ast::PolyMap>(polyMap->polyTran(false, 1e-4, 1e-3, 10, lbnd, ubnd));
+    auto const iterPolyMap = std::make_shared<ast::PolyMap>(coeffs, 2, "IterInverse=1");
+    auto const chebyMap = std::make_shared<ast::ChebyMap>(coeffs, 2, lbnd, ubnd);
+
+    std::vector<double> lut;
+    for (int i = 0; i < 1000; ++i) {
+        lut.push_back(i + 0.1 * std::sin(i / 10.0));
+    }
+
+    std::vector<double> matrixVec = {1.1, 0.2, -0.3, 0.9};
+    auto const matrix = ast::arrayFromVector(matrixVec, 2);
+
+    auto slaMap = std::make_shared<ast::SlaMap>();
+    slaMap->add("EQGAL");
+    auto timeMap = std::make_shared<ast::TimeMap>();
+    timeMap->add("MJDTOJD", {0, 0});
+
+    auto const shiftMap = ast::ShiftMap({1.5, -2.5});
+    auto const zoomMap = ast::ZoomMap(2, 2.5);
+    auto const wcsMap = ast::WcsMap(2, ast::WcsType::TAN, 1, 2);
+
+    std::vector<MappingCase> cases = {
+            {"UnitMap", std::make_shared<ast::UnitMap>(2), -1, 1},
+            {"ZoomMap", zoomMap.copy(), -1, 1},
+            {"ShiftMap", shiftMap.copy(), -1, 1},
+            {"WinMap", std::make_shared<ast::WinMap>(std::vector<double>{0, 0}, std::vector<double>{1, 1},
+                                                     std::vector<double>{2, 3}, std::vector<double>{5, 7}),
+             -1, 1},
+            {"MatrixMap", std::make_shared<ast::MatrixMap>(matrix), -1, 1},
+            {"MatrixMap(diagonal)", std::make_shared<ast::MatrixMap>(std::vector<double>{1.1, 0.9}), -1, 1},
+            {"PermMap", std::make_shared<ast::PermMap>(std::vector<int>{2, 1}, std::vector<int>{2, 1}), -1, 1},
+            {"UnitNormMap", std::make_shared<ast::UnitNormMap>(std::vector<double>{0.1, 0.2}), -1, 1},
+            {"NormMap", std::make_shared<ast::NormMap>(ast::SkyFrame()), -10, 10},
+            {"PolyMap", polyMap, -1, 1},
+            {"PolyMap(fit inverse)", fitPolyMap, -1, 1},
+            {"PolyMap(iterative inverse)", iterPolyMap, -1, 1},
+            {"ChebyMap", chebyMap, -1, 1},
+            {"LutMap", std::make_shared<ast::LutMap>(lut, 0, 1), 0, 999},
+            {"MathMap", std::make_shared<ast::MathMap>(2, 2,
+                                                       std::vector<std::string>{"u = x + 0.1 * sin(y)",
+                                                                                "v = y + 0.1 * cos(x)"},
+                                                       std::vector<std::string>{"x", "y"}),
+             -1, 1},
+            {"PcdMap", std::make_shared<ast::PcdMap>(5e-3, std::vector<double>{0, 0}), -1, 1},
+            {"SphMap", std::make_shared<ast::SphMap>(), -1, 1},
+            {"WcsMap", wcsMap.copy(), 0.5, 1.5},
+            {"SlaMap", slaMap, 0, 1},
+            {"TimeMap", timeMap, 50000, 60000},
+            {"RateMap", std::make_shared<ast::RateMap>(*polyMap, 1, 1), -1, 1},
+            {"TranMap", std::make_shared<ast::TranMap>(*polyMap, *fitPolyMap), -1, 1},
+            {"CmpMap", std::make_shared<ast::CmpMap>(shiftMap, zoomMap, true), -1, 1},
+            {"SeriesMap", std::make_shared<ast::SeriesMap>(shiftMap.then(zoomMap).then(*fitPolyMap)), -1, 1},
+            {"ParallelMap", std::make_shared<ast::ParallelMap>(ast::ZoomMap(1, 3).under(ast::LutMap(lut, 0, 1))),
+             0, 999},
+    };
+
+    // radial optical distortion, as a compound mapping and as a single PolyMap
+    std::vector<double> const radialCenter = {0.1, -0.2};
+    std::vector<double> const radialCoeffs = {0, 1, 0, 2.5e-2, 0, -3e-3};
+    std::vector<double> radialPolyVec;
+    for (std::size_t power = 1; power < radialCoeffs.size(); power += 2) {
+        radialPolyVec.insert(radialPolyVec.end(), {radialCoeffs[power], 1, static_cast<double>(power)});
+    }
+    ast::PolyMap const radialPoly1d(ast::arrayFromVector(radialPolyVec, radialPolyVec.size() / 3), 1,
+                                    "IterInverse=1");
+    cases.push_back({"makeRadialMapping", ast::makeRadialMapping(radialCenter, radialPoly1d), -1, 1});
+    cases.push_back({"makeRadialPolyMap", ast::makeRadialPolyMap(radialCenter, radialCoeffs), -1, 1});
+
+    // a synthetic camera-like FrameDict: pixels -> focal plane (distorted) -> sky
+    auto pixelsToFocal = ast::ShiftMap({-1, -1}).then(ast::ZoomMap(2, 1e-3)).then(*fitPolyMap);
+    auto focalToSky = ast::ZoomMap(2, 1e-2).then(*wcsMap.inverted());
+    ast::FrameDict cameraDict(ast::Frame(2, "Domain=PIXELS"));
+    cameraDict.addFrame(ast::FrameSet::BASE, pixelsToFocal, ast::Frame(2, "Domain=FOCAL_PLANE"));
+    cameraDict.addFrame("FOCAL_PLANE", focalToSky, ast::SkyFrame("Domain=SKY"));
+    cases.push_back({"FrameDict(PIXELS->SKY)", cameraDict.copy(), 0, 2000});
+
+    auto dm13686 = readObject<ast::FrameSet>(opts.dataDir + "/frameSetDM13686.txt");
+    if (dm13686) {
+        cases.push_back({"FrameSet(frameSetDM13686)", dm13686, 0, 4000});
+    }
+    auto simpleFits = readFitsWcs("examples/simple.fits");
+    if (simpleFits) {
+        cases.push_back({"FrameSet(simple.fits)", simpleFits, 0, 1000});
+    }
+    return cases;
+}
+
+/// Benchmark applyForward and applyInverse into pre-allocated arrays over a sweep of point counts
+void benchApply(MappingCase const &mcase, ast::bench::Options const &opts, ast::bench::Reporter &reporter) {
+    int const nIn = mcase.mapping->getNIn();
+    int const nOut = mcase.mapping->getNOut();
+    for (auto nPts : ast::bench::decadeSweep(opts.maxPoints)) {
+        if (mcase.mapping->hasForward()) {
+            auto const from = ast::bench::makePoints(nIn, nPts, mcase.lo, mcase.hi);
+            ast::Array2D to = ndarray::allocate(ndarray::makeVector(static_cast<std::size_t>(nOut), nPts));
+            auto timing = ast::bench::timeIt([&] { mcase.mapping->applyForward(from, to); }, opts.minTime);
+            reporter.add(ast::bench::Result{mcase.name, "applyForward", {}}.addTiming(timing, nPts));
+        }
+        if (mcase.mapping->hasInverse()) {
+            // use the forward transform (if available) to generate valid inverse inputs
+            auto const to = ast::bench::makePoints(nIn, nPts, mcase.lo, mcase.hi);
+            ast::Array2D from = ndarray::allocate(ndarray::makeVector(static_cast<std::size_t>(nOut), nPts));
+            if (mcase.mapping->hasForward()) {
+                mcase.mapping->applyForward(to, from);
+            }
+            auto timing = ast::bench::timeIt([&] { mcase.mapping->applyInverse(from, to); }, opts.minTime);
+            reporter.add(ast::bench::Result{mcase.name, "applyInverse", {}}.addTiming(timing, nPts));
+        }
+    }
+}
+
+/**
+Benchmark transforming small batches of points, comparing the overload of applyForward that allocates
+a new result for each batch with the overload that reuses the buffers of a TransformWorkspace
+*/
+void benchBatches(MappingCase const &mcase, ast::bench::Options const &opts, ast::bench::Reporter &reporter) {
+    if (!mcase.mapping->hasForward()) {
+        return;
+    }
+    int const nIn = mcase.mapping->getNIn();
+    for (std::size_t nPts : {16, 256, 4096}) {
+        auto const from = ast::bench::makePoints(nIn, nPts, mcase.lo, mcase.hi);
+        auto timing = ast::bench::timeIt([&] { mcase.mapping->applyForward(from); }, opts.minTime);
+        reporter.add(ast::bench::Result{mcase.name, "applyForwardBatch", {}}.addTiming(timing, nPts));
+
+        ast::TransformWorkspace workspace(*mcase.mapping, nPts);
+        timing = ast::bench::timeIt([&] { mcase.mapping->applyForward(from, workspace); }, opts.minTime);
+        reporter.add(ast::bench::Result{mcase.name, "applyForwardBatchWorkspace", {}}.addTiming(timing, nPts));
+    }
+}
+
+/**
+Benchmark tranGridForward over a sweep of grid sizes
+
+The grid is in pixel coordinates [0, nSide - 1] along each axis, so the benchmarked mapping is
+a WinMap that scales the grid to [lo, hi] followed by the mapping of the case.
+*/
+void benchTranGrid(MappingCase const &mcase, ast::bench::Options const &opts, ast::bench::Reporter &reporter) {
+    int const nIn = mcase.mapping->getNIn();
+    int const nOut = mcase.mapping->getNOut();
+    if (!mcase.mapping->hasForward() || nIn > 3) {
+        return;
+    }
+    for (auto nPtsWanted : ast::bench::decadeSweep(opts.maxPoints)) {
+        int const nSide = std::max(2, static_cast<int>(std::round(std::pow(nPtsWanted, 1.0 / nIn))));
+        std::size_t nPts = 1;
+        for (int i = 0; i < nIn; ++i) {
+            nPts *= nSide;
+        }
+        auto const gridMap = ast::WinMap(std::vector<double>(nIn, 0), std::vector<double>(nIn, nSide - 1),
+                                         std::vector<double>(nIn, mcase.lo), std::vector<double>(nIn, mcase.hi))
+                                     .then(*mcase.mapping);
+        ast::PointI const lbnd(nIn, 0);
+        ast::PointI const ubnd(nIn, nSide - 1);
+        ast::Array2D to = ndarray::allocate(ndarray::makeVector(nPts, static_cast<std::size_t>(nOut)));
+        for (double tol : {0.0, 1e-3 * (mcase.hi - mcase.lo)}) {
+            auto timing = ast::bench::timeIt([&] { gridMap.tranGridForward(lbnd, ubnd, tol, nSide, to); },
+                                             opts.minTime);
+            reporter.add(ast::bench::Result{mcase.name, "tranGridForward", {}}
+                                 .addTiming(timing, nPts)
+                                 .add("tol", tol));
+        }
+    }
+}
+
+/// Benchmark linearApprox over the box of the case
+void benchLinearApprox(MappingCase const &mcase, ast::bench::Options const &opts,
+                       ast::bench::Reporter &reporter) {
+    int const nIn = mcase.mapping->getNIn();
+    if (!mcase.mapping->hasForward()) {
+        return;
+    }
+    ast::PointD const lbnd(nIn, mcase.lo);
+    ast::PointD const ubnd(nIn, mcase.hi);
+    double const tol = 1e30;  // accept any fit; the cost of the fit is what is being measured
+    try {
+        auto timing = ast::bench::timeIt([&] { mcase.mapping->linearApprox(lbnd, ubnd, tol); }, opts.minTime);
+        reporter.add(ast::bench::Result{mcase.name, "linearApprox", {}}.addTiming(timing));
+    } catch (std::runtime_error const &e) {
+        std::cerr << mcase.name << ": linearApprox failed: " << e.what() << std::endl;
+    }
+}
+
+/// Benchmark fitting an inverse with polyTran, for PolyMap and ChebyMap
+void benchPolyTran(MappingCase const &mcase, ast::bench::Options const &opts, ast::bench::Reporter &reporter) {
+    std::vector<double> const lbnd(mcase.mapping->getNIn(), mcase.lo);
+    std::vector<double> const ubnd(mcase.mapping->getNIn(), mcase.hi);
+    for (int maxorder : {4, 8}) {
+        ast::bench::Timing timing;
+        if (auto polyMap = std::dynamic_pointer_cast<ast::PolyMap>(mcase.mapping)) {
+            if (polyMap->getIterInverse()) {
+                return;
+            }
+            timing = ast::bench::timeIt([&] { polyMap->polyTran(false, 1e-6, 1e-3, maxorder, lbnd, ubnd); },
+                                        opts.minTime);
+        } else if (auto chebyMap = std::dynamic_pointer_cast<ast::ChebyMap>(mcase.mapping)) {
+            timing = ast::bench::timeIt([&] { chebyMap->polyTran(false, 1e-6, 1e-3, maxorder, lbnd, ubnd); },
+                                        opts.minTime);
+        } else {
+            return;
+        }
+        reporter.add(ast::bench::Result{mcase.name, "polyTran", {}}.addTiming(timing).add("maxorder",
+                                                                                           maxorder));
+    }
+}
+
+/// Benchmark simplified
+void benchSimplified(MappingCase const &mcase, ast::bench::Options const &opts,
+                     ast::bench::Reporter &reporter) {
+    auto timing = ast::bench::timeIt([&] { mcase.mapping->simplified(); }, opts.minTime);
+    reporter.add(ast::bench::Result{mcase.name, "simplified", {}}.addTiming(timing));
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    auto const opts = ast::bench::parseArgs(argc, argv);
+    ast::bench::Reporter reporter("mapping", opts);
+    for (auto const &mcase : makeCases(opts)) {
+        if (!opts.wanted(mcase.name)) {
+            continue;
+        }
+        benchApply(mcase, opts, reporter);
+        benchBatches(mcase, opts, reporter);
+        benchTranGrid(mcase, opts, reporter);
+        benchLinearApprox(mcase, opts, reporter);
+        benchPolyTran(mcase, opts, reporter);
+        benchSimplified(mcase, opts, reporter);
+    }
+    reporter.write();
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+/*
+ * Benchmark the effect of the global AST tuning parameters ObjectCaching and MemoryCaching
+ * on workloads that create and delete many small objects.
+ *
+ * Each workload is run with caching disabled, with each kind of caching enabled and with both enabled.
+ * Results include the time per object, the growth in peak resident set size
+ * and the resident set size retained after all objects are released
+ * (the cost of caching, until caching is disabled again, which frees the cached memory).
+ * AST does not report cache hit rates, so the benefit of caching is shown by the time per object.
+ *
+ * Run from the package root directory, e.g.:
+ *
+ *     benchmarks/benchTuning --output tuning.json
+ */
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ndarray.h"
+
+#include "astshim.h"
+#include "benchUtils.h"
+
+namespace {
+
+/// A workload that creates and deletes `nObjects` small objects
+struct Workload {
+    std::string name;
+    std::function<void(int nObjects)> run;
+};
+
+/// Caching configuration
+struct Config {
+    std::string name;
+    int objectCaching;
+    int memoryCaching;
+};
+
+std::vector<Workload> makeWorkloads() {
+    std::vector<Workload> workloads;
+
+    // a ShiftMap per source, each used to transform one point: typical of per-source processing
+    workloads.push_back({"perSourceShiftMap", [](int nObjects) {
+                             std::vector<double> const point = {1.0, 2.0};
+                             for (int i = 0; i < nObjects; ++i) {
+                                 ast::ShiftMap const shiftMap({0.1 * i, -0.1 * i});
+                                 shiftMap.applyForward(point);
+                             }
+                         }});
+
+    // per-source ShiftMaps combined with a fixed mapping, then simplified
+    workloads.push_back({"perSourceSeriesMap", [](int nObjects) {
+                             ast::ZoomMap const zoomMap(2, 1.5);
+                             for (int i = 0; i < nObjects; ++i) {
+                                 ast::ShiftMap const shiftMap({0.1 * i, -0.1 * i});
+                                 shiftMap.then(zoomMap).simplified();
+                             }
+                         }});
+
+    // many small objects alive at once, then released together
+    workloads.push_back({"batchOfMappings", [](int nObjects) {
+                             std::vector<std::unique_ptr<ast::Mapping>> mappings;
+                             mappings.reserve(nObjects);
+                             for (int i = 0; i < nObjects; ++i) {
+                                 mappings.emplace_back(new ast::ShiftMap({0.1 * i, -0.1 * i}));
+                             }
+                         }});
+
+    // small objects created from their serialized form
+    workloads.push_back({"fromString", [](int nObjects) {
+                             std::string const text = ast::ZoomMap(2, 1.5).show(false);
+                             for (int i = 0; i < nObjects; ++i) {
+                                 ast::Object::fromString(text);
+                             }
+                         }});
+    return workloads;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    auto const opts = ast::bench::parseArgs(argc, argv);
+    ast::bench::Reporter reporter("tuning", opts);
+
+    std::vector<Config> const configs = {
+            {"none", 0, 0},
+            {"ObjectCaching", 1, 0},
+            {"MemoryCaching", 0, 1},
+            {"ObjectCaching+MemoryCaching", 1, 1},
+    };
+    std::vector<std::size_t> const objectCounts = {1000, 100000};
+
+    for (auto const &workload : makeWorkloads()) {
+        if (!opts.wanted(workload.name)) {
+            continue;
+        }
+        for (std::size_t nObjects : objectCounts) {
+            if (nObjects > opts.maxPoints) {
+                continue;
+            }
+            for (auto const &config : configs) {
+                double const rssBefore = ast::bench::currentRssBytes();
+                double const peakRssBefore = ast::bench::peakRssBytes();
+                ast::bench::Timing timing;
+                double rssRetained = 0;
+                {
+                    ast::ScopedTune objectCaching(ast::TuneParam::ObjectCaching, config.objectCaching);
+                    ast::ScopedTune memoryCaching(ast::TuneParam::MemoryCaching, config.memoryCaching);
+                    timing = ast::bench::timeIt([&] { workload.run(static_cast<int>(nObjects)); }, opts.minTime);
+                    rssRetained = ast::bench::currentRssBytes() - rssBefore;
+                }  // restoring the tuning parameters frees the caches
+                reporter.add(ast::bench::Result{workload.name + "(nObjects=" + std::to_string(nObjects) + ")",
+                                                config.name,
+                                                {}}
+                                     .addTiming(timing, nObjects, "objects")
+                                     .add("peakRssGrowthBytes", ast::bench::peakRssBytes() - peakRssBefore)
+                                     .add("retainedRssBytes", rssRetained)
+                                     .add("rssAfterRestoreBytes",
+                                          ast::bench::currentRssBytes() - rssBefore));
+            }
+        }
+    }
+    reporter.write();
+    return 0;
+}
@@ -0,0 +1,336 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_BENCHMARKS_BENCHUTILS_H
+#define ASTSHIM_BENCHMARKS_BENCHUTILS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "ndarray.h"
+
+#include "astshim/base.h"
+
+/*
+ * Helpers shared by the astshim benchmark programs.
+ *
+ * Each benchmark program accumulates a list of Results and writes them as a single JSON document,
+ * so that results can be tracked from release to release by continuous integration.
+ */
+namespace ast {
+namespace bench {
+
+/**
+Command-line options common to all benchmark programs
+
+Recognized arguments are:
+- `--output <path>`: write the JSON results to this file instead of stdout
+- `--min-time <seconds>`: minimum total time to spend timing each case (default 0.2)
+- `--max-points <n>`: largest number of points in a sweep (default 1e8)
+- `--filter <text>`: only run cases whose name contains this text
+- `--data-dir <path>`: directory containing test data (default "tests/data")
+*/
+struct Options {
+    std::string output = "";
+    double minTime = 0.2;
+    std::size_t maxPoints = 100000000;
+    std::string filter = "";
+    std::string dataDir = "tests/data";
+
+    /// Return true if the case with the specified name should be run
+    bool wanted(std::string const &name) const {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+};
+
+/**
+Parse the command-line arguments common to all benchmark programs
+
+@throws std::invalid_argument if an argument is not recognized or is missing its value
+*/
+inline Options parseArgs(int argc, char **argv) {
+    Options opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string const arg = argv[i];
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for argument " + arg);
+        }
+        std::string const value = argv[++i];
+        if (arg == "--output") {
+            opts.output = value;
+        } else if (arg == "--min-time") {
+            opts.minTime = std::stod(value);
+        } else if (arg == "--max-points") {
+            opts.maxPoints = static_cast<std::size_t>(std::stod(value));
+        } else if (arg == "--filter") {
+            opts.filter = value;
+        } else if (arg == "--data-dir") {
+            opts.dataDir = value;
+        } else {
+            throw std::invalid_argument("Unrecognized argument " + arg);
+        }
+    }
+    return opts;
+}
+
+/**
+Return point counts 1, 10, 100... up to and including `maxPoints`
+*/
+inline std::vector<std::size_t> decadeSweep(std::size_t maxPoints) {
+    std::vector<std::size_t> nPtsList;
+    for (std::size_t nPts = 1; nPts <= maxPoints; nPts *= 10) {
+        nPtsList.push_back(nPts);
+    }
+    return nPtsList;
+}
+
+/**
+Timing of a benchmark case: the number of iterations and the mean and best time per iteration
+*/
+struct Timing {
+    int nIter;
+    double meanSec;
+    double minSec;
+};
+
+/**
+Call `func` repeatedly until at least `minTime` seconds have elapsed (and at least once)
+
+The first call is treated as a warm-up and is not included in the statistics,
+unless it alone takes longer than `minTime`.
+*/
+template <typename Func>
+Timing timeIt(Func &&func, double minTime) {
+    using Clock = std::chrono::steady_clock;
+    auto elapsed = [](Clock::time_point t0) {
+        return std::chrono::duration<double>(Clock::now() - t0).count();
+    };
+    auto const t0 = Clock::now();
+    func();
+    double const warmup = elapsed(t0);
+    if (warmup >= minTime) {
+        return Timing{1, warmup, warmup};
+    }
+    Timing timing{0, 0.0, warmup};
+    double total = 0;
+    while (total < minTime) {
+        auto const t1 = Clock::now();
+        func();
+        double const dt = elapsed(t1);
+        total += dt;
+        timing.minSec = std::min(timing.minSec, dt);
+        ++timing.nIter;
+    }
+    timing.meanSec = total / timing.nIter;
+    return timing;
+}
+
+/**
+Like timeIt, but call `setup` (untimed) before each call to `func`
+
+Use this when `func` consumes or modifies state that must be rebuilt for every call,
+for example reading an object from a channel.
+*/
+template <typename Setup, typename Func>
+Timing timeWithSetup(Setup &&setup, Func &&func, double minTime) {
+    using Clock = std::chrono::steady_clock;
+    Timing timing{0, 0.0, 0.0};
+    double total = 0;
+    while (total < minTime || timing.nIter == 0) {
+        setup();
+        auto const t0 = Clock::now();
+        func();
+        double const dt = std::chrono::duration<double>(Clock::now() - t0).count();
+        timing.minSec = timing.nIter == 0 ? dt : std::min(timing.minSec, dt);
+        total += dt;
+        ++timing.nIter;
+    }
+    timing.meanSec = total / timing.nIter;
+    return timing;
+}
+
+/**
+Peak resident set size of this process, in bytes
+*/
+inline double peakRssBytes() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<double>(usage.ru_maxrss);
+#else
+    return static_cast<double>(usage.ru_maxrss) * 1024.0;
+#endif
+}
+
+/**
+Current resident set size of this process, in bytes, or 0 if unknown (it is only available on Linux)
+*/
+inline double currentRssBytes() {
+    std::ifstream statm("/proc/self/statm");
+    double totalPages = 0;
+    double residentPages = 0;
+    if (!(statm >> totalPages >> residentPages)) {
+        return 0;
+    }
+    return residentPages * static_cast<double>(sysconf(_SC_PAGESIZE));
+}
+
+/**
+Make an array of points with dimensions (nAxes, nPts) uniformly distributed in [lo, hi)
+*/
+inline Array2D makePoints(int nAxes, std::size_t nPts, double lo, double hi, unsigned int seed = 1) {
+    Array2D points = ndarray::allocate(ndarray::makeVector(static_cast<std::size_t>(nAxes), nPts));
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> distribution(lo, hi);
+    double *data = points.getData();
+    for (std::size_t i = 0, n = nAxes * nPts; i < n; ++i) {
+        data[i] = distribution(generator);
+    }
+    return points;
+}
+
+/**
+The result of one benchmark case: a name, an operation, and a list of named values
+*/
+struct Result {
+    std::string name;
+    std::string operation;
+    std::vector<std::pair<std::string, double>> values;
+
+    /// Add the standard timing values, plus a rate for `nItems` items per iteration
+    Result &addTiming(Timing const &timing, double nItems = 0, std::string const &itemName = "points") {
+        values.emplace_back("iterations", timing.nIter);
+        values.emplace_back("meanSeconds", timing.meanSec);
+        values.emplace_back("minSeconds", timing.minSec);
+        if (nItems > 0) {
+            values.emplace_back(itemName, nItems);
+            values.emplace_back(itemName + "PerSecond", nItems / timing.meanSec);
+        }
+        return *this;
+    }
+
+    /// Add a named value
+    Result &add(std::string const &key, double value) {
+        values.emplace_back(key, value);
+        return *this;
+    }
+};
+
+/// Format a string as a quoted JSON string
+inline std::string jsonString(std::string const &str) {
+    std::ostringstream os;
+    os << '"';
+    for (char c : str) {
+        switch (c) {
+            case '"':
+                os << "\\\"";
+                break;
+            case '\\':
+                os << "\\\\";
+                break;
+            case '\n':
+                os << "\\n";
+                break;
+            case '\t':
+                os << "\\t";
+                break;
+            default:
+                os << c;
+        }
+    }
+    os << '"';
+    return os.str();
+}
+
+/**
+Accumulate benchmark results and write them as JSON
+
+The JSON document has the form:
+
+    {"suite": "<suite>", "results": [
+        {"name": "<name>", "operation": "<operation>", "<key>": <value>, ...},
+        ...
+    ]}
+*/
+class Reporter {
+public:
+    Reporter(std::string const &suite, Options const &opts) : _suite(suite), _opts(opts), _results() {}
+
+    /// Add a result and write a one-line summary to stderr so progress is visible
+    void add(Result const &result) {
+        _results.push_back(result);
+        std::cerr << _suite << ": " << result.name << " " << result.operation;
+        for (auto const &keyValue : result.values) {
+            std::cerr << " " << keyValue.first << "=" << keyValue.second;
+        }
+        std::cerr << std::endl;
+    }
+
+    /// Write all results as JSON to `opts.output`, or stdout if that is empty
+    void write() const {
+        if (_opts.output.empty()) {
+            _write(std::cout);
+        } else {
+            std::ofstream os(_opts.output);
+            if (!os) {
+                throw std::runtime_error("Could not open " + _opts.output + " for writing");
+            }
+            _write(os);
+        }
+    }
+
+private:
+    void _write(std::ostream &os) const {
+        os.precision(10);
+        os << "{\"suite\": " << jsonString(_suite) << ", \"results\": [";
+        for (std::size_t i = 0; i < _results.size(); ++i) {
+            auto const &result = _results[i];
+            os << (i == 0 ? "\n" : ",\n") << "    {\"name\": " << jsonString(result.name)
+               << ", \"operation\": " << jsonString(result.operation);
+            for (auto const &keyValue : result.values) {
+                os << ", " << jsonString(keyValue.first) << ": " << keyValue.second;
+            }
+            os << "}";
+        }
+        os << "\n]}" << std::endl;
+    }
+
+    std::string _suite;
+    Options _opts;
+    std::vector<Result> _results;
+};
+
+}  // namespace bench
+}  // namespace ast
+
+#endif
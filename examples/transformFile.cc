@@ -0,0 +1,142 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+/*
+Transform the coordinates in a binary file using a Mapping, writing the results to another binary file.
+
+Usage:
+
+    transformFile [options] <mapping-path> <input-path> <output-path>
+
+where:
+- <mapping-path> is a file containing the mapping: either a FITS header (if the name ends in ".fits"),
+  in which case the mapping of the WCS FrameSet is used, or an AST object written by Channel
+  (e.g. by Object::show), which must be a Mapping (e.g. a FrameSet).
+- <input-path> is a binary file of native-endian doubles, nIn per point (nOut if --inverse)
+- <output-path> is the output file, which is created or replaced
+
+Options:
+- `--inverse`: apply the inverse transform
+- `--layout interleaved|columns`: "interleaved" (the default) for x0, y0, x1, y1...,
+    "columns" for x0, x1, ..., y0, y1, ...
+- `--block-size <n>`: number of points per block
+- `--threads <n>`: number of threads; 0 (the default) for one per core
+- `--bad-value <value>`: value written for bad output coordinates (default nan)
+- `--keep-nan`: do not treat NaN input coordinates as bad
+*/
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "astshim.h"
+
+namespace {
+
+void printUsage(std::ostream &os) {
+    os << "Usage: transformFile [--inverse] [--layout interleaved|columns] [--block-size <n>]\n"
+          "                     [--threads <n>] [--bad-value <value>] [--keep-nan]\n"
+          "                     <mapping-path> <input-path> <output-path>"
+       << std::endl;
+}
+
+std::shared_ptr<ast::Mapping> readMapping(std::string const &path) {
+    std::string const fitsSuffix = ".fits";
+    bool const isFits = path.size() >= fitsSuffix.size() &&
+                        path.compare(path.size() - fitsSuffix.size(), fitsSuffix.size(), fitsSuffix) == 0;
+    auto stream = ast::FileStream(path);
+    std::shared_ptr<ast::Object> obj;
+    if (isFits) {
+        auto channel = ast::FitsChan(stream);
+        obj = channel.read();
+    } else {
+        auto channel = ast::Channel(stream);
+        obj = channel.read();
+    }
+    auto mapping = std::dynamic_pointer_cast<ast::Mapping>(obj);
+    if (!mapping) {
+        throw std::runtime_error("No mapping found in " + path);
+    }
+    return mapping;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    ast::ColumnSpec spec;
+    std::vector<std::string> paths;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string const arg = argv[i];
+            if (arg == "--inverse") {
+                spec.forward = false;
+            } else if (arg == "--keep-nan") {
+                spec.nanInputIsBad = false;
+            } else if (arg == "--help") {
+                printUsage(std::cout);
+                return 0;
+            } else if (arg.compare(0, 2, "--") == 0) {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument("Missing value for argument " + arg);
+                }
+                std::string const value = argv[++i];
+                if (arg == "--layout") {
+                    if (value == "interleaved") {
+                        spec.layout = ast::ColumnLayout::INTERLEAVED;
+                    } else if (value == "columns") {
+                        spec.layout = ast::ColumnLayout::COLUMNS;
+                    } else {
+                        throw std::invalid_argument("Unknown layout " + value);
+                    }
+                } else if (arg == "--block-size") {
+                    spec.blockSize = std::stoul(value);
+                } else if (arg == "--threads") {
+                    spec.nThreads = std::stoi(value);
+                } else if (arg == "--bad-value") {
+                    spec.badOutput = std::stod(value);
+                } else {
+                    throw std::invalid_argument("Unknown argument " + arg);
+                }
+            } else {
+                paths.push_back(arg);
+            }
+        }
+        if (paths.size() != 3) {
+            throw std::invalid_argument("Expected 3 paths but got " + std::to_string(paths.size()));
+        }
+    } catch (std::exception const &e) {
+        std::cerr << e.what() << std::endl;
+        printUsage(std::cerr);
+        return 1;
+    }
+
+    try {
+        auto mapping = readMapping(paths[0]);
+        auto const result = ast::transformFile(*mapping, paths[1], paths[2], spec);
+        std::cout << "Transformed " << result.nPoints << " points in " << result.nBlocks << " blocks; "
+                  << result.nBadPoints << " points are bad" << std::endl;
+    } catch (std::exception const &e) {
+        std::cerr << "transformFile failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
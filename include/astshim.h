@@ -4,15 +4,28 @@
 #include "astshim/base.h"
 #include "astshim/Object.h"
 #include "astshim/Stream.h"
+#include "astshim/CompressedFileStream.h"
 #include "astshim/Channel.h"
+#include "astshim/ChannelReader.h"
 #include "astshim/MapBox.h"
 #include "astshim/MapSplit.h"
 #include "astshim/QuadApprox.h"
+#include "astshim/ThreadPool.h"
 #include "astshim/Mapping.h"
+#include "astshim/TransformWorkspace.h"
+#include "astshim/FactorizedMapping.h"
 #include "astshim/Frame.h"
 #include "astshim/FrameSet.h"
 #include "astshim/FrameDict.h"
+#include "astshim/MappingRegistry.h"
+#include "astshim/FrameSetRouter.h"
 #include "astshim/functional.h"
+#include "astshim/Instrumentation.h"
+#include "astshim/Census.h"
+#include "astshim/tuning.h"
+#include "astshim/transformFile.h"
+#include "astshim/batchApply.h"
+#include "astshim/FitCache.h"
 
 // channels
 #include "astshim/FitsChan.h"
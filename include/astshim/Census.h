@@ -0,0 +1,132 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_CENSUS_H
+#define ASTSHIM_CENSUS_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "astshim/base.h"
+
+namespace ast {
+
+class Object;
+
+/**
+Census counts for live AST objects of one class (and creation site, if recorded)
+*/
+struct CensusEntry {
+    std::string className;  ///< AST class name, e.g. "FrameSet"
+    /**
+    Creation site: a summary of the call stack when the object was wrapped.
+    Only recorded if astshim is built with ASTSHIM_CENSUS_SITES defined; otherwise blank.
+    */
+    std::string site;
+    std::size_t count = 0;  ///< number of live objects
+    std::size_t bytes = 0;  ///< total in-memory size of the live objects, in bytes
+};
+
+/**
+Enable or disable the census of live AST objects.
+
+While the census is enabled, each AST object that is wrapped by an astshim @ref Object
+(whether created, copied or read from a @ref Channel) is recorded until the last
+astshim reference to it is released. Objects recorded while the census was enabled
+are still removed when released after the census is disabled.
+
+Object sizes are given by @ref Object_ObjSize "ObjSize", which includes the size of any
+component objects (such as the mappings in a @ref SeriesMap), and are measured when
+the object is recorded unless `remeasure` is specified when calling @ref getCensus.
+
+Components held internally by AST (e.g. the frames of a @ref FrameSet)
+are included in the size of their parent object but are not counted separately.
+
+The census is disabled by default, unless environment variable `ASTSHIM_CENSUS`
+is set to a non-empty value other than "0" when astshim is loaded.
+
+@param[in] enable  Possible values are:
+                -  -1 (or any negative value) to return the current value without changing it.
+                -   0 to disable the census,
+                -   1 (or any positive value) to enable the census.
+@return the previous value (or current value if `enable` is negative).
+*/
+bool census(int enable = -1);
+
+/**
+Return the census of live AST objects, grouped by class name and creation site
+
+@param[in] remeasure  If true then measure the current size of each object,
+    else use the size measured when the object was recorded (which is much faster,
+    but misses growth of objects such as a @ref FrameSet to which frames are added).
+    Remeasuring also updates the recorded sizes. Objects that are in use by another thread
+    (e.g. the per-thread copies made by asynchronous or batched transforms) cannot be measured,
+    so they keep their recorded sizes.
+@return census entries sorted by decreasing total bytes
+*/
+std::vector<CensusEntry> getCensus(bool remeasure = false);
+
+/**
+Get the total size (bytes) of all live objects in the census, as recorded
+*/
+std::size_t getCensusBytes();
+
+/**
+Get the maximum value of @ref getCensusBytes since the census was enabled
+or the high-water mark was last reset
+*/
+std::size_t getCensusHighWaterMark();
+
+/**
+Reset the high-water mark to the current value of @ref getCensusBytes
+*/
+void resetCensusHighWaterMark();
+
+/**
+Return the total in-memory size of a collection of objects, in bytes
+
+Each underlying AST object is counted once, even if it is referenced by more than one
+of the supplied objects. Sizes include the size of component objects.
+
+@param[in] objects  Objects to measure; null pointers are ignored
+*/
+std::size_t deepSize(std::vector<std::shared_ptr<Object const>> const &objects);
+
+namespace detail {
+
+/**
+Record an AST object that has been wrapped by an astshim @ref Object, if the census is enabled
+*/
+void censusAdd(AstObject const *rawObj);
+
+/**
+Remove an AST object from the census, if it was recorded
+
+This is cheap if no objects are recorded.
+*/
+void censusRemove(AstObject const *rawObj);
+
+}  // namespace detail
+}  // namespace ast
+
+#endif
@@ -24,6 +24,7 @@
 
 #include <memory>
 #include <ostream>
+#include <vector>
 
 #include "astshim/base.h"
 #include "astshim/Object.h"
@@ -31,7 +32,9 @@
 
 namespace ast {
 
+class ChannelReader;
 class KeyMap;
+class ThreadPool;
 
 /**
 Channel provides input/output of AST objects.
@@ -59,13 +62,14 @@ Note that a channel cannot be deep-copied because the contained stream cannot be
 */
 class Channel : public Object {
     friend class Object;
+    friend class ChannelReader;
 
 public:
     /**
     Construct a channel that uses a provided @ref Stream
 
     @param[in] stream  Stream for channel I/O:
-        - For file I/O: provide a @ref FileStream
+        - For file I/O: provide a @ref FileStream, or a @ref CompressedFileStream for compressed files
         - For string I/O (e.g. unit tests): provide a @ref StringStream
         - For standard I/O provide `Stream(&std::cin, &std::cout))`
             where either stream can be nullptr if not wanted
@@ -107,6 +111,23 @@ public:
     /// Read an object from a channel.
     std::shared_ptr<Object> read();
 
+    /**
+    Read all remaining objects from a channel, decoding them in parallel
+
+    This is equivalent to calling @ref read until there are no more objects, but faster for
+    channels holding many objects; see @ref ChannelReader for details and for reading objects
+    one at a time with bounded memory use.
+
+    @param[in] pool  Pool on which to decode objects; if null then use the default pool
+    @param[in] maxLookahead  Maximum number of objects to scan ahead of the one being collected;
+                    0 for the ChannelReader default
+
+    @throws std::invalid_argument if this is a FitsChan
+    @throws std::runtime_error if an object cannot be decoded
+    */
+    std::vector<std::shared_ptr<Object>> readAll(std::shared_ptr<ThreadPool> const &pool = nullptr,
+                                                 std::size_t maxLookahead = 0);
+
     /// Set @ref Channel_Comment "Comment": include textual comments in output?
     void setComment(bool skip) { setB("Comment", skip); }
 
@@ -176,7 +197,13 @@ protected:
     */
     explicit Channel(AstChannel *chan);
 
+    /// Get the number of bytes sourced from the stream so far; used for instrumentation
+    std::size_t getNBytesSourced() const { return _stream._nBytesSourced; }
+
 private:
+    /// Implement read, returning null if there are no more objects
+    std::shared_ptr<Object> _read();
+
     Stream _stream;  ///< stream read and/or written read by the channel
 };
 
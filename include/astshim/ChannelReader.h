@@ -0,0 +1,143 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_CHANNELREADER_H
+#define ASTSHIM_CHANNELREADER_H
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "astshim/Channel.h"
+#include "astshim/Object.h"
+#include "astshim/ThreadPool.h"
+
+namespace ast {
+namespace detail {
+class XmlSplitter;
+}  // namespace detail
+
+/**
+Read the objects in a @ref Channel one at a time, decoding them in parallel
+
+A channel may hold many objects back to back. @ref Channel.read decodes one object per call,
+in the calling thread. A ChannelReader instead scans the text of the channel, which is cheap,
+to split it into the text of each top-level object, then decodes the objects in parallel
+on a @ref ThreadPool. Objects are returned in the order they appear in the channel.
+
+At most `maxLookahead` objects are scanned ahead of the one most recently returned,
+so memory use is bounded even for very large files.
+
+A plain @ref Channel is split at the "Begin" line of each top-level object and the matching "End" line.
+An @ref XmlChan is read in blocks of fixed size, even if it has no line breaks, and split
+by an incremental tokenizer at the elements of AST objects
+(see detail::XmlSplitter), even if they are nested in other elements, e.g. a wrapper document.
+Each object is decoded as soon as its end tag has been read, rather than after reading the whole document.
+Other top-level elements are decoded too, without the AST objects nested in them, since an XmlChan
+may be able to read objects from them (e.g. IVOA descriptions); objects read this way
+are returned after the AST objects that the element contained.
+Each piece of text is read until it has no more objects, so the objects returned are the same
+as those returned by calling @ref Channel.read until there are no more objects,
+except for the order of objects in such mixed elements.
+@ref FitsChan is not supported.
+
+The attributes of the channel that affect reading (@ref Channel_Skip "Skip",
+@ref Channel_Strict "Strict" and @ref Channel_ReportLevel "ReportLevel") are used to decode each object.
+
+The channel must outlive the reader and must not be used while the reader is.
+*/
+class ChannelReader {
+public:
+    /// The default `maxLookahead` is this times the number of threads in the pool
+    static std::size_t constexpr DEFAULT_LOOKAHEAD_PER_THREAD = 4;
+
+    /**
+    Construct a ChannelReader
+
+    @param[in] channel  Channel to read; must be a Channel or XmlChan
+    @param[in] pool  Pool on which to decode objects; if null then use the default pool
+                    (see @ref getDefaultThreadPool)
+    @param[in] maxLookahead  Maximum number of objects to scan ahead; 0 for
+                    `DEFAULT_LOOKAHEAD_PER_THREAD` times the number of threads in the pool
+
+    @throws std::invalid_argument if `channel` is a FitsChan
+    */
+    explicit ChannelReader(Channel &channel, std::shared_ptr<ThreadPool> const &pool = nullptr,
+                           std::size_t maxLookahead = 0);
+
+    ChannelReader(ChannelReader const &) = delete;
+    ChannelReader(ChannelReader &&) = delete;
+    ChannelReader &operator=(ChannelReader const &) = delete;
+    ChannelReader &operator=(ChannelReader &&) = delete;
+
+    /// Waits for objects still being decoded
+    ~ChannelReader();
+
+    /// Get the maximum number of objects to scan ahead
+    std::size_t getMaxLookahead() const { return _maxLookahead; }
+
+    /// Get the number of objects returned so far
+    std::size_t getNRead() const { return _nRead; }
+
+    /**
+    Return the next object, or null if there are no more objects
+
+    @throws std::runtime_error if an object cannot be decoded. Objects after it
+        may still be read by calling next again.
+    @throws std::runtime_error if the channel's stream cannot be read (e.g. a truncated compressed file),
+        once the objects before the error have been returned.
+    */
+    std::shared_ptr<Object> next();
+
+private:
+    // Scan the text of the next object into `text`; return false if there are no more objects
+    bool _scan(std::string &text);
+
+    // Implementation of _scan for XmlChan
+    bool _scanXml(std::string &text);
+
+    // Scan and submit objects until maxLookahead are pending or there are no more objects
+    void _fill();
+
+    // Decode all objects in `text`; the results are unlocked, so the thread that uses them must lock them
+    static std::vector<std::shared_ptr<Object>> _decode(std::string const &text, bool isXml,
+                                                        std::string const &options);
+
+    Channel &_channel;
+    std::shared_ptr<ThreadPool> _pool;
+    std::size_t _maxLookahead;
+    std::string _options;  // options for the channels used to decode objects
+    std::unique_ptr<detail::XmlSplitter> _xmlSplitter;  // null unless reading an XmlChan
+    std::vector<char> _xmlBlock;                        // block of XML read from the channel
+    std::deque<std::future<std::vector<std::shared_ptr<Object>>>> _pending;  // one entry per piece of text
+    std::deque<std::shared_ptr<Object>> _decoded;  // decoded objects not yet returned
+    bool _isEnd;  // has the end of the channel been reached?
+    std::exception_ptr _scanError;  // error that stopped scanning, if any; thrown after the objects before it
+    std::size_t _nRead;
+};
+
+}  // namespace ast
+
+#endif
@@ -0,0 +1,117 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_COMPRESSEDFILESTREAM_H
+#define ASTSHIM_COMPRESSEDFILESTREAM_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "astshim/Stream.h"
+
+namespace ast {
+
+/**
+Compression formats for @ref CompressedFileStream
+*/
+enum class Compression {
+    NONE,  ///< No compression: plain text, as read and written by @ref FileStream
+    GZIP,  ///< gzip; only if astshim was built with zlib (see CompressedFileStream::isAvailable)
+    ZSTD,  ///< Zstandard; only if astshim was built with zstd (see CompressedFileStream::isAvailable)
+};
+
+namespace detail {
+class CompressedFileBuf;
+}  // namespace detail
+
+/**
+Compressed file-based source or sink (not both) for channels
+
+This is a drop-in replacement for @ref FileStream that compresses the data it writes
+and decompresses the data it reads, without holding the whole file in memory:
+data passes through input and output buffers of a fixed size.
+When reading, the compression format is detected from the start of the file,
+so compressed and uncompressed files can be read with the same code.
+Concatenated compressed streams (e.g. from `cat a.gz b.gz`) are read as one.
+
+When writing, the end of the compressed stream is only written when @ref close is called
+or when this stream and all channels using it have been destroyed. Call @ref close
+to report errors (destruction ignores them) and to complete the file at a known time,
+e.g. from Python. Destroy a @ref FitsChan before closing its stream, since it writes its cards
+when it is destroyed.
+*/
+class CompressedFileStream : public Stream {
+public:
+    /// Default size of the input and output buffers, in bytes
+    static std::size_t constexpr DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    /**
+    Construct a CompressedFileStream for reading or writing, but not both
+
+    @param[in] path  Path to file as a string
+    @param[in] doWrite  If true then write to the file, otherwise read from the file
+    @param[in] compression  Compression format for writing; ignored when reading,
+                    since the format is detected from the file
+    @param[in] level  Compression level for writing, with the meaning used by the format
+                    (1-9 for gzip, 1-22 for zstd); negative for the format's default level
+    @param[in] bufferSize  Size of each input or output buffer, in bytes
+
+    @throws std::runtime_error if the file cannot be opened, or if the compression format
+        (requested or detected) is not available.
+    @throws std::invalid_argument if bufferSize is 0
+    */
+    explicit CompressedFileStream(std::string const &path, bool doWrite = false,
+                                  Compression compression = Compression::GZIP, int level = -1,
+                                  std::size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+    virtual ~CompressedFileStream();
+
+    /// Get the path to the file, as a string
+    std::string getPath() const { return _path; }
+
+    /// Get the compression format: as requested when writing, as detected when reading
+    Compression getCompression() const { return _compression; }
+
+    /**
+    Finish writing or reading and close the file
+
+    When writing, this compresses any buffered data and writes the end of the compressed stream.
+    Channels using this stream can no longer read or write it. Calling close again has no effect.
+
+    @throws std::runtime_error if the data cannot be written, or if an error occurred while reading
+        (e.g. the file is truncated or corrupt). Reading errors are also reported by the channel
+        that was reading, when it reaches the error.
+    */
+    void close();
+
+    /// Return true if the specified compression format is available in this build of astshim
+    static bool isAvailable(Compression compression);
+
+private:
+    std::string _path;  ///< Path to file
+    Compression _compression;
+    std::shared_ptr<detail::CompressedFileBuf> _buf;  ///< the buffer used by the source or sink stream
+};
+
+}  // namespace ast
+
+#endif
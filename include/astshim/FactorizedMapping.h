@@ -0,0 +1,159 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_FACTORIZEDMAPPING_H
+#define ASTSHIM_FACTORIZEDMAPPING_H
+
+#include <cstddef>
+#include <vector>
+
+#include "ndarray.h"
+
+#include "astshim/base.h"
+#include "astshim/Mapping.h"
+#include "astshim/MapSplit.h"
+
+namespace ast {
+
+/**
+A mapping evaluated as independent groups of axes
+
+Many mappings are separable: for example the spatial and spectral parts of a 3-D WCS,
+or a ZoomMap or WinMap, whose axes are all independent. A FactorizedMapping uses
+@ref Mapping::factorize to find the independent groups of axes once, then transforms points
+by applying each group's (simplified) mapping to just the rows of its axes. This avoids the
+PermMaps and compound mappings that AST would otherwise evaluate for every point.
+
+Rows of a group's axes that are adjacent are used in place; other rows are copied.
+
+A FactorizedMapping holds its own copies of the group mappings.
+Like other AST objects, it is not thread safe.
+*/
+class FactorizedMapping {
+public:
+    /**
+    Construct a FactorizedMapping
+
+    @param[in] mapping  Mapping to factorize
+    */
+    explicit FactorizedMapping(Mapping const &mapping);
+
+    FactorizedMapping(FactorizedMapping const &) = default;
+    FactorizedMapping(FactorizedMapping &&) = default;
+    FactorizedMapping &operator=(FactorizedMapping const &) = default;
+    FactorizedMapping &operator=(FactorizedMapping &&) = default;
+
+    ~FactorizedMapping() = default;
+
+    /// Get the number of input axes
+    int getNIn() const { return _nIn; }
+
+    /// Get the number of output axes
+    int getNOut() const { return _nOut; }
+
+    /// Get the independent groups of axes, as returned by @ref Mapping::factorize
+    std::vector<MapSplit> const &getFactors() const { return _factors; }
+
+    /// Get the number of independent groups of axes
+    std::size_t getNFactors() const { return _factors.size(); }
+
+    /// Does the mapping have more than one independent group of axes?
+    bool isSeparable() const { return _factors.size() > 1; }
+
+    /**
+    Replace the mapping of each group with one input and one output by a lookup table
+
+    This can speed up groups whose mappings are costly to evaluate, such as spectral or time
+    conversions. Each such group is tabulated using @ref tabulate1D over the range of its input;
+    groups that cannot be tabulated to the specified accuracy are left unchanged.
+    Accuracy is only assured within the specified range.
+
+    @param[in] lbnd  Lower bound of the input range, with one value per input axis of the whole mapping
+    @param[in] ubnd  Upper bound of the input range, with one value per input axis of the whole mapping
+    @param[in] tol  Maximum absolute error of each output
+    @param[in] maxEntries  Maximum number of entries in each lookup table
+    @return the number of groups that were tabulated
+
+    @throws std::invalid_argument if `lbnd` or `ubnd` has the wrong length, or `tol` <= 0
+    */
+    int tabulate1DFactors(PointD const &lbnd, PointD const &ubnd, double tol, int maxEntries = 1 << 20);
+
+    /// Is the forward transform defined for all groups?
+    bool hasForward() const;
+
+    /// Is the inverse transform defined for all groups?
+    bool hasInverse() const;
+
+    /**
+    Perform a forward transformation, putting the results into a pre-allocated 2-D array
+
+    @param[in] from  input coordinates, with dimensions (nIn, nPts)
+    @param[out] to  transformed coordinates, with dimensions (nOut, nPts)
+
+    @throws std::invalid_argument if `from` or `to` has the wrong dimensions
+    */
+    void applyForward(ConstArray2D const &from, Array2D const &to) const { _tran(from, true, to); }
+
+    /**
+    Perform a forward transformation, returning a new 2-D array
+
+    @param[in] from  input coordinates, with dimensions (nIn, nPts)
+    @return the transformed coordinates, with dimensions (nOut, nPts)
+    */
+    Array2D applyForward(ConstArray2D const &from) const {
+        Array2D to = ndarray::allocate(getNOut(), from.getSize<1>());
+        _tran(from, true, to);
+        return to;
+    }
+
+    /**
+    Perform an inverse transformation, putting the results into a pre-allocated 2-D array
+
+    @param[in] from  input coordinates, with dimensions (nOut, nPts)
+    @param[out] to  transformed coordinates, with dimensions (nIn, nPts)
+
+    @throws std::invalid_argument if `from` or `to` has the wrong dimensions
+    */
+    void applyInverse(ConstArray2D const &from, Array2D const &to) const { _tran(from, false, to); }
+
+    /**
+    Perform an inverse transformation, returning a new 2-D array
+
+    @param[in] from  input coordinates, with dimensions (nOut, nPts)
+    @return the transformed coordinates, with dimensions (nIn, nPts)
+    */
+    Array2D applyInverse(ConstArray2D const &from) const {
+        Array2D to = ndarray::allocate(getNIn(), from.getSize<1>());
+        _tran(from, false, to);
+        return to;
+    }
+
+private:
+    void _tran(ConstArray2D const &from, bool doForward, Array2D const &to) const;
+
+    int _nIn;
+    int _nOut;
+    std::vector<MapSplit> _factors;
+};
+
+}  // namespace ast
+
+#endif
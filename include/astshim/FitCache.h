@@ -0,0 +1,192 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_FITCACHE_H
+#define ASTSHIM_FITCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "astshim/base.h"
+
+namespace ast {
+
+class Object;
+
+/**
+A persistent on-disk cache of fitted inverses and approximations
+
+Fitting an inverse with PolyMap.polyTran or ChebyMap.polyTran, or computing Mapping.linearApprox
+or a QuadApprox, for the same instrument model happens again in every process. A FitCache
+saves each result in a directory, keyed by a hash of the serialized mapping and the fit parameters,
+so later processes (or later calls) read the result instead of computing it.
+
+The cache is opt-in: the methods listed above use the default cache (see @ref getDefaultFitCache),
+which is only set if you call @ref setDefaultFitCache or set environment variable `ASTSHIM_FIT_CACHE`
+to the path of a directory.
+
+Each result is stored in its own file in a compact binary form: a small header with checksums,
+followed by the result (the serialized mapping for polyTran, the coefficients for the approximations).
+Files are written to a temporary name and then renamed, so readers never see partial files,
+and processes may share a cache directory. Files that cannot be read or fail their checksums are
+treated as missing. When the total size of the files exceeds a limit, the least recently used files
+are deleted. Errors reading or writing the cache are counted but never reported to the caller,
+since the result can always be computed instead.
+
+Files use the native byte order, so do not share a cache directory between machines of different
+architectures.
+*/
+class FitCache {
+public:
+    /// Default maximum total size of the files in the cache, in bytes
+    static std::size_t constexpr DEFAULT_MAX_BYTES = 100 * 1024 * 1024;
+
+    /**
+    Construct a FitCache
+
+    @param[in] directory  Directory in which to store results; created (with its parents) if necessary
+    @param[in] maxBytes  Maximum total size of the files in the cache, in bytes
+
+    @throws std::runtime_error if the directory does not exist and cannot be created
+    */
+    explicit FitCache(std::string const &directory, std::size_t maxBytes = DEFAULT_MAX_BYTES);
+
+    FitCache(FitCache const &) = delete;
+    FitCache(FitCache &&) = delete;
+    FitCache &operator=(FitCache const &) = delete;
+    FitCache &operator=(FitCache &&) = delete;
+
+    ~FitCache() = default;
+
+    /// Get the cache directory
+    std::string const &getDirectory() const { return _directory; }
+
+    /// Get the maximum total size of the files in the cache, in bytes
+    std::size_t getMaxBytes() const { return _maxBytes; }
+
+    /**
+    Get a result from the cache, or compute it and save it in the cache
+
+    @param[in] key  Description of the computation, e.g. as made by @ref makeKey;
+                    the result is only reused for the same key
+    @param[in] compute  Function that computes the result, serialized as a string of bytes
+    @return the result
+    */
+    std::string getOrCompute(std::string const &key, std::function<std::string()> const &compute);
+
+    /**
+    Make a key for a computation on an object
+
+    @param[in] operation  Name of the operation, e.g. "polyTran"
+    @param[in] object  Object the operation uses, e.g. the mapping to fit
+    @param[in] params  The other parameters of the operation, formatted as text
+                    with enough precision to distinguish different values
+    */
+    static std::string makeKey(std::string const &operation, Object const &object, std::string const &params);
+
+    /// Get the number of results read from the cache
+    std::size_t getNHits() const { return _nHits; }
+
+    /// Get the number of results computed because they were not in the cache
+    std::size_t getNMisses() const { return _nMisses; }
+
+    /// Get the number of results written to the cache
+    std::size_t getNWrites() const { return _nWrites; }
+
+    /// Get the number of errors reading or writing the cache (including invalid files)
+    std::size_t getNErrors() const { return _nErrors; }
+
+    /// Get the total size of the files in the cache, in bytes
+    std::size_t getBytes() const;
+
+    /**
+    Delete the least recently used files until the total size is at most `maxBytes`
+
+    Also delete temporary files more than an hour old, which were left by processes
+    that died while writing a result. This is called automatically after each write.
+    */
+    void trim();
+
+    /// Delete all files in the cache
+    void clear();
+
+private:
+    // Return the path of the file for a key
+    std::string _getPath(std::string const &key) const;
+
+    // Read the result for `key` from `path` into `result`; return false if not found or invalid
+    bool _read(std::string const &path, std::string const &key, std::string &result);
+
+    // Write the result for `key` to `path`
+    void _write(std::string const &path, std::string const &key, std::string const &result);
+
+    std::string _directory;
+    std::size_t _maxBytes;
+    std::atomic<std::size_t> _nHits;
+    std::atomic<std::size_t> _nMisses;
+    std::atomic<std::size_t> _nWrites;
+    std::atomic<std::size_t> _nErrors;
+};
+
+/**
+Get the default fit cache, or null if there is none
+
+Unless set by @ref setDefaultFitCache, the default cache is null unless environment variable
+`ASTSHIM_FIT_CACHE` is set to the path of a directory when this is first called,
+in which case a cache in that directory is created, with maximum size given by environment variable
+`ASTSHIM_FIT_CACHE_MAX_BYTES` (default: @ref FitCache::DEFAULT_MAX_BYTES).
+*/
+std::shared_ptr<FitCache> getDefaultFitCache();
+
+/**
+Set the default fit cache
+
+@param[in] cache  The new default cache; null to disable caching
+*/
+void setDefaultFitCache(std::shared_ptr<FitCache> cache);
+
+namespace detail {
+
+/**
+Format the numeric parameters of a fit for FitCache::makeKey, with enough precision to distinguish all values
+*/
+std::string formatFitParams(std::vector<double> const &values);
+
+/**
+Serialize doubles as bytes, for storing in a FitCache
+*/
+std::string packDoubles(std::vector<double> const &values);
+
+/**
+Deserialize doubles packed by packDoubles
+
+@throws std::runtime_error if the number of bytes is not a multiple of the size of a double
+*/
+std::vector<double> unpackDoubles(std::string const &bytes);
+
+}  // namespace detail
+}  // namespace ast
+
+#endif
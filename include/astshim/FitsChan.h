@@ -612,10 +612,7 @@ public:
                     This is the format produced by the fits_hdr2str function in the
                     CFITSIO library.
     */
-    void putCards(std::string const &cards) {
-        astPutCards(getRawPtr(), cards.c_str());
-        assertOK();
-    }
+    void putCards(std::string const &cards);
 
     /**
     Store a FITS header card in a @ref FitsChan.
@@ -657,10 +654,7 @@ public:
 
     -  This is a no-op if the @ref Stream has no source.
     */
-    void readFits() {
-        astReadFits(getRawPtr());
-        assertOK();
-    }
+    void readFits();
 
     /**
     Keep the current card when an @ref Object is read that uses the card.
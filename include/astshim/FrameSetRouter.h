@@ -0,0 +1,203 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_FRAMESETROUTER_H
+#define ASTSHIM_FRAMESETROUTER_H
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ndarray.h"
+
+#include "astshim/base.h"
+#include "astshim/FrameDict.h"
+#include "astshim/FrameSet.h"
+#include "astshim/Mapping.h"
+#include "astshim/MappingRegistry.h"
+
+namespace ast {
+
+/**
+Cache of simplified mappings between the frames of a @ref FrameSet
+
+Code that transforms points between many pairs of frames of one FrameSet (e.g. a camera model
+with frames PIXELS, FOCAL_PLANE, FIELD_ANGLE and SKY) pays for FrameSet::getMapping on every call:
+AST searches the frame graph and builds a new compound mapping, which the caller usually simplifies.
+A FrameSetRouter does that work once per pair of frames: it keeps its own copy of the FrameSet and caches
+the simplified mapping for each pair, computing it on first use or up front with @ref precompute.
+
+Frames are specified by index or by (case blind) domain, as for @ref FrameDict;
+all frames with non-empty domains must have unique domains.
+
+The FrameSet is copied, so later changes to the original do not affect the router.
+Like other AST objects, a FrameSetRouter is not thread safe.
+*/
+class FrameSetRouter {
+public:
+    /**
+    Construct a router from a FrameSet or FrameDict
+
+    No mappings are computed; use @ref precompute or @ref precomputeAll to compute them up front.
+
+    @param[in] frameSet  FrameSet or FrameDict to route; it is deep copied.
+    @param[in] simplify  Simplify each mapping when it is computed?
+    @param[in] registry  Registry in which to intern each mapping when it is computed, or null.
+                Routers for FrameSets that share components (e.g. the same camera distortion)
+                can share a registry so that they share identical mappings.
+
+    @throws std::invalid_argument if two frames in the FrameSet have the same non-empty domain.
+    */
+    explicit FrameSetRouter(FrameSet const &frameSet, bool simplify = true,
+                            std::shared_ptr<MappingRegistry> registry = nullptr);
+
+    FrameSetRouter(FrameSetRouter const &) = delete;
+    FrameSetRouter(FrameSetRouter &&) = default;
+    FrameSetRouter &operator=(FrameSetRouter const &) = delete;
+    FrameSetRouter &operator=(FrameSetRouter &&) = default;
+
+    ~FrameSetRouter() = default;
+
+    /// Get the number of frames
+    int getNFrame() const { return _frameDict->getNFrame(); }
+
+    /// Get the domain names of all frames that have one
+    std::set<std::string> getAllDomains() const { return _frameDict->getAllDomains(); }
+
+    /// Return true if a frame has the specified domain
+    bool hasDomain(std::string const &domain) const { return _frameDict->hasDomain(domain); }
+
+    /**
+    Get the index of a frame specified by domain
+
+    @throws std::out_of_range if no frame has the specified domain
+    */
+    int getIndex(std::string const &domain) const { return _frameDict->getIndex(domain); }
+
+    /// Are mappings simplified when they are computed?
+    bool getSimplify() const { return _simplify; }
+
+    /// Get the registry in which mappings are interned; null if none
+    std::shared_ptr<MappingRegistry> getRegistry() const { return _registry; }
+
+    /**
+    Get the mapping from one frame to another, computing and caching it if necessary
+
+    @param[in] from  Index of the frame to transform from; may be FrameSet::BASE or FrameSet::CURRENT
+    @param[in] to  Index of the frame to transform to; may be FrameSet::BASE or FrameSet::CURRENT
+    @return the cached mapping, which is shared with the router and must not be modified
+
+    @throws std::out_of_range if either index is not valid
+    */
+    std::shared_ptr<Mapping const> getMapping(int from, int to) const;
+
+    /// Variant of @ref getMapping(int, int) const "getMapping(int, int)" with frames specified by domain
+    std::shared_ptr<Mapping const> getMapping(std::string const &from, std::string const &to) const {
+        return getMapping(getIndex(from), getIndex(to));
+    }
+
+    /**
+    Is the mapping from one frame to another cached?
+
+    This does not count as a lookup for the statistics.
+    */
+    bool isMaterialized(int from, int to) const {
+        return _mappings.count(std::make_pair(_getFrameIndex(from), _getFrameIndex(to))) > 0;
+    }
+
+    /// Variant of @ref isMaterialized(int, int) const "isMaterialized(int, int)" with frames
+    /// specified by domain
+    bool isMaterialized(std::string const &from, std::string const &to) const {
+        return isMaterialized(getIndex(from), getIndex(to));
+    }
+
+    /**
+    Compute and cache the mappings for the specified pairs of frames, if not already cached
+
+    @param[in] pairs  Pairs of (from, to) domains
+
+    @throws std::out_of_range if any domain is not found; the pairs before it are cached
+    */
+    void precompute(std::vector<std::pair<std::string, std::string>> const &pairs);
+
+    /**
+    Compute and cache the mappings between every ordered pair of distinct frames, if not already cached
+
+    This computes NFrame * (NFrame - 1) mappings, so it is best suited to FrameSets with few frames.
+    */
+    void precomputeAll();
+
+    /**
+    Transform points from one frame to another
+
+    @param[in] from  Domain of frame to transform from
+    @param[in] to  Domain of frame to transform to
+    @param[in] points  Points to transform, with dimensions (nAxes of `from` frame, nPts)
+    @return the transformed points, with dimensions (nAxes of `to` frame, nPts)
+
+    @throws std::out_of_range if either domain is not found
+    @throws std::invalid_argument if `points` has the wrong number of axes
+    */
+    Array2D transform(std::string const &from, std::string const &to, ConstArray2D const &points) const {
+        return getMapping(from, to)->applyForward(points);
+    }
+
+    /// Variant of @ref transform with frames specified by index
+    Array2D transform(int from, int to, ConstArray2D const &points) const {
+        return getMapping(from, to)->applyForward(points);
+    }
+
+    /// Get the number of cached mappings
+    std::size_t getNMaterialized() const { return _mappings.size(); }
+
+    /// Get the number of calls to getMapping (including those made by transform) that found a cached mapping
+    std::size_t getNHits() const { return _nHits; }
+
+    /// Get the number of calls to getMapping (including those made by transform) that computed a mapping
+    std::size_t getNMisses() const { return _nMisses; }
+
+    /// Discard all cached mappings and reset the statistics
+    void clear();
+
+private:
+    /**
+    Return a frame index in the range [1, NFrame], replacing FrameSet::BASE and FrameSet::CURRENT
+
+    @throws std::out_of_range if the index is not valid
+    */
+    int _getFrameIndex(int index) const;
+
+    std::shared_ptr<FrameDict> _frameDict;
+    bool _simplify;
+    std::shared_ptr<MappingRegistry> _registry;
+    // cached mappings, indexed by (from, to) frame index
+    mutable std::map<std::pair<int, int>, std::shared_ptr<Mapping const>> _mappings;
+    mutable std::size_t _nHits;
+    mutable std::size_t _nMisses;
+};
+
+}  // namespace ast
+
+#endif
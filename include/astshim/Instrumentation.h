@@ -0,0 +1,237 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_INSTRUMENTATION_H
+#define ASTSHIM_INSTRUMENTATION_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "astshim/base.h"
+
+namespace ast {
+
+class Object;
+
+/**
+Accumulated instrumentation counters for one kind of operation
+on one class of @ref Object with one value of @ref Object_Ident "Ident".
+
+See @ref instrumentation for the list of operations that are instrumented.
+*/
+struct OpStats {
+    std::string operation;       ///< name of the operation, e.g. "tranForward"
+    std::string className;       ///< class name of the object, e.g. "PolyMap" or "FitsChan"
+    std::string ident;           ///< @ref Object_Ident "Ident" of the object; blank if not set
+    std::uint64_t calls = 0;     ///< number of calls
+    std::uint64_t points = 0;    ///< number of points transformed
+    std::uint64_t nanoseconds = 0;  ///< total wall-clock time spent in the calls, in nanoseconds
+    std::uint64_t bytes = 0;     ///< number of bytes read or written
+};
+
+/**
+Enable or disable collection of instrumentation counters.
+
+When enabled, astshim keeps counts of calls, points, elapsed time and bytes
+for the following operations, broken down by class name and by the
+@ref Object_Ident "Ident" attribute of the object (so you can tag objects of interest
+using `setIdent`):
+- "tranForward", "tranInverse": Mapping.applyForward and applyInverse
+- "tranGridForward", "tranGridInverse": Mapping.tranGridForward and tranGridInverse
+- "linearApprox": Mapping.linearApprox
+- "polyTran": ChebyMap.polyTran and PolyMap.polyTran
+- "simplified": Mapping.simplified
+- "mapBox": computing a @ref MapBox
+- "convert", "findFrame": Frame.convert and Frame.findFrame
+- "read", "write": Channel.read and Channel.write, including subclasses such as FitsChan and XmlChan
+- "readAll": Channel.readAll (each object it decodes is also counted as "read")
+- "putCards", "readFits", "findFits": FitsChan header ingest and lookup
+- "transformFile": @ref transformFile (the blocks it transforms are also counted as "tranForward"
+    or "tranInverse")
+- "batchApply": @ref batchApply, counted once per call using the mapping of the first job
+    (the pieces of each job it transforms are also counted as "tranForward" or "tranInverse")
+
+Counters are updated atomically, so they may be read while other threads are running operations.
+Each thread caches the counters for the objects it has recently used, so when enabled most
+operations just add to the counters, without looking up the class name or ident or taking a lock.
+When disabled the overhead is a single relaxed atomic load per operation.
+
+Instrumentation is disabled by default, unless environment variable `ASTSHIM_INSTRUMENT`
+is set to a non-empty value other than "0" when astshim is loaded.
+
+@param[in] enable  Possible values are:
+                -  -1 (or any negative value) to return the current value without changing it.
+                -   0 to disable instrumentation,
+                -   1 (or any positive value) to enable instrumentation.
+@return the previous value (or current value if `enable` is negative).
+*/
+bool instrumentation(int enable = -1);
+
+/**
+Return a snapshot of the instrumentation counters
+
+@return counters for each combination of operation, class name and ident
+    that has been seen since the counters were last reset, sorted by operation, class name and ident.
+*/
+std::vector<OpStats> getInstrumentationStats();
+
+/**
+Reset all instrumentation counters to zero
+*/
+void resetInstrumentationStats();
+
+/**
+Enable or disable recording of trace events.
+
+When enabled, each of the operations listed for @ref instrumentation records an event
+containing its start time, duration, thread ID and arguments (class name, ident, number of points,
+number of input and output axes, tolerance and bytes, where relevant).
+Events are saved in a fixed-size ring buffer owned by the thread that ran the operation,
+so recording is lock-free; each thread retains its most recent 16384 events.
+Use @ref getTraceJson or @ref writeTrace to export the events.
+
+Timestamps are measured with `std::chrono::steady_clock` (`CLOCK_MONOTONIC` on Linux),
+which is the clock used by most tracing tools, so events can be merged with spans
+recorded by other software.
+
+Tracing is disabled by default, unless environment variable `ASTSHIM_TRACE`
+is set to a non-empty value other than "0" when astshim is loaded.
+When disabled the overhead is a single relaxed atomic load per operation (shared with instrumentation).
+
+@param[in] enable  Possible values are:
+                -  -1 (or any negative value) to return the current value without changing it.
+                -   0 to disable tracing,
+                -   1 (or any positive value) to enable tracing.
+@return the previous value (or current value if `enable` is negative).
+*/
+bool tracing(int enable = -1);
+
+/**
+Return recorded trace events in Chrome trace event format
+
+The result is a JSON object with a "traceEvents" list of complete ("ph": "X") events,
+which can be loaded by chrome://tracing and https://ui.perfetto.dev.
+Recorded events are not cleared; use @ref clearTrace for that.
+*/
+std::string getTraceJson();
+
+/**
+Write recorded trace events to a file in Chrome trace event format; see @ref getTraceJson
+
+@param[in] path  Path of file to write; an existing file is overwritten
+@throws std::runtime_error if the file cannot be written
+*/
+void writeTrace(std::string const &path);
+
+/**
+Discard all recorded trace events
+*/
+void clearTrace();
+
+namespace detail {
+
+struct OpCounters;
+
+/**
+Note that attributes of an AST object are being set or cleared, which may change its @ref Object_Ident "Ident"
+
+OpScope caches the counters for each object pointer, so this must be called whenever
+the ident that a pointer maps to could change. It is a no-op unless instrumentation is enabled.
+
+@param[in] rawPtr  AST object
+@param[in] attribs  Name of the attribute, or a list of settings as for @ref Object::set;
+                the cache is only invalidated if it mentions Ident.
+*/
+void noteAttributeChange(AstObject const *rawPtr, std::string const &attribs);
+
+/**
+Note that an AST object is about to be annulled
+
+OpScope caches the counters for each object pointer, so the cache for this pointer is invalidated
+if annulling will free the object, since another object may then reuse its address.
+It is a no-op unless instrumentation is enabled.
+*/
+void noteObjectAnnul(AstObject const *rawPtr);
+
+/**
+Record one call to an instrumented operation
+
+Construct an OpScope at the start of the operation; the elapsed time is recorded
+and the trace event (if tracing) is saved when it is destroyed.
+This is a no-op if instrumentation and tracing are both disabled.
+*/
+class OpScope {
+public:
+    /**
+    Construct an OpScope
+
+    @param[in] operation  Name of operation; see @ref instrumentation for the standard names
+    @param[in] object  Object on which the operation is performed;
+                    used to obtain the class name and ident.
+    @param[in] nPoints  Number of points processed
+    */
+    explicit OpScope(char const *operation, Object const &object, std::uint64_t nPoints = 0);
+
+    ~OpScope();
+
+    OpScope(OpScope const &) = delete;
+    OpScope(OpScope &&) = delete;
+    OpScope &operator=(OpScope const &) = delete;
+    OpScope &operator=(OpScope &&) = delete;
+
+    /// Is this operation being recorded?
+    bool isActive() const { return _flags != 0; }
+
+    /// Add to the number of points processed
+    void addPoints(std::uint64_t nPoints) { _points += nPoints; }
+
+    /// Add to the number of bytes read or written
+    void addBytes(std::uint64_t nBytes) { _bytes += nBytes; }
+
+    /// Set the number of input and output axes; only used for tracing
+    void setAxes(int nIn, int nOut) {
+        _nIn = nIn;
+        _nOut = nOut;
+    }
+
+    /// Set the tolerance; only used for tracing
+    void setTol(double tol) { _tol = tol; }
+
+private:
+    unsigned int _flags;      // bit 0 set if instrumenting, bit 1 set if tracing
+    char const *_operation;
+    OpCounters *_counters;    // null if not instrumenting
+    std::string _className;   // only set if tracing
+    std::string _ident;       // only set if tracing
+    std::chrono::steady_clock::time_point _start;
+    std::uint64_t _points;
+    std::uint64_t _bytes;
+    int _nIn;                 // 0 if unknown
+    int _nOut;                // 0 if unknown
+    double _tol;              // nan if unknown
+};
+
+}  // namespace detail
+}  // namespace ast
+
+#endif
@@ -22,6 +22,7 @@
 #ifndef ASTSHIM_MAPSPLIT_H
 #define ASTSHIM_MAPSPLIT_H
 
+#include <memory>
 #include <vector>
 
 #include "ndarray.h"
@@ -56,6 +57,19 @@ public:
     */
     explicit MapSplit(Mapping const &map, std::vector<int> const &in);
 
+    /**
+    Construct a MapSplit from its parts, without checking that they are consistent
+
+    This is used to describe a mapping that cannot be split, e.g. by Mapping::factorize.
+
+    @param[in] splitMap  The split mapping
+    @param[in] origIn  Indices of the inputs of the original mapping that feed `splitMap`
+    @param[in] origOut  Indices of the outputs of the original mapping fed by `splitMap`
+    */
+    explicit MapSplit(std::shared_ptr<Mapping> splitMap, std::vector<int> const &origIn,
+                      std::vector<int> const &origOut)
+            : splitMap(splitMap), origIn(origIn), origOut(origOut) {}
+
     MapSplit(MapSplit const &) = default;
     MapSplit(MapSplit &&) = default;
     MapSplit &operator=(MapSplit const &) = default;
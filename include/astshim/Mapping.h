@@ -22,6 +22,9 @@
 #ifndef ASTSHIM_MAPPING_H
 #define ASTSHIM_MAPPING_H
 
+#include <exception>
+#include <functional>
+#include <future>
 #include <memory>
 #include <vector>
 
@@ -29,12 +32,29 @@
 
 #include "astshim/base.h"
 #include "astshim/detail/utils.h"
+#include "astshim/MapSplit.h"
+#include "astshim/MappingCost.h"
 #include "astshim/Object.h"
+#include "astshim/ThreadPool.h"
 
 namespace ast {
 
 class ParallelMap;
 class SeriesMap;
+class TransformWorkspace;
+
+namespace detail {
+class BatchUnit;
+}  // namespace detail
+
+/**
+Function called when an asynchronous transform finishes
+
+@param[in] result  The transformed points; empty if the transform failed
+@param[in] error  The exception thrown by the transform, or null if it succeeded;
+                @ref OperationCancelled if it was cancelled
+*/
+using TransformCallback = std::function<void(Array2D const &result, std::exception_ptr error)>;
 
 /**
 An abstract base class for objects which transform one set of coordinates to another.
@@ -58,6 +78,7 @@ Mapping also has the following attributes:
 */
 class Mapping : public Object {
     friend class Object;
+    friend class detail::BatchUnit;
 
 public:
     virtual ~Mapping() {}
@@ -245,11 +266,50 @@ public:
       This restriction does not apply to the simplification of Frames.
     * The returned mapping is always independent of the original (a deep copy), unlike astSimplify.
     */
-    std::shared_ptr<Mapping> simplified() const {
-        AstObject *rawSimpMap = reinterpret_cast<AstObject *>(astSimplify(getRawPtr()));
-        assertOK(rawSimpMap);
-        return Object::fromAstObject<Mapping>(rawSimpMap, true);
-    }
+    std::shared_ptr<Mapping> simplified() const;
+
+    /**
+    Describe the structure of the simplified mapping and estimate its cost.
+
+    This can be used to decide whether to evaluate a mapping exactly or to approximate it,
+    e.g. using tranGridForward or by fitting a ChebyMap using polyTran.
+
+    The mapping is simplified, then decomposed into a tree of MappingCost nodes
+    (a FrameSet is replaced by its base to current mapping).
+    Each node is annotated with a modelled cost and, if `nPoints` > 0, a measured cost.
+    To measure costs, `nPoints` points uniformly distributed within the box
+    [`lbnd`, `ubnd`] are transformed by the mapping and by each component of the tree,
+    with the output of each component of a SeriesMap providing the input to the next.
+
+    @param[in] forward  If true explain the forward transform, else the inverse transform.
+    @param[in] nPoints  Number of sample points used to measure costs; if 0 then only the model is used.
+    @param[in] lbnd  Lower bound of the sample box, with one value per input axis
+                (output axis if `forward` false); if empty then use 0 for every axis.
+    @param[in] ubnd  Upper bound of the sample box, with one value per input axis
+                (output axis if `forward` false); if empty then use 1000 for every axis.
+    @return the root of the tree
+
+    @throws std::invalid_argument if `lbnd` or `ubnd` is not empty and has the wrong length,
+        or if `nPoints` < 0.
+    */
+    MappingCost explain(bool forward = true, int nPoints = 1000, PointD const &lbnd = PointD(),
+                        PointD const &ubnd = PointD()) const;
+
+    /**
+    Break this mapping into independent groups of axes
+
+    Each group is a subset of inputs that feeds a subset of outputs that depend on no other inputs,
+    found using @ref MapSplit. For example a mapping from (x, y, wavelength) to (RA, Dec, frequency)
+    whose spatial and spectral parts are independent has two groups. Each group is as small as
+    could be found; a mapping whose axes are all independent (e.g. a ZoomMap) has one group per axis.
+    Use @ref FactorizedMapping to transform points using the groups.
+
+    @return one MapSplit per group, in order of the smallest input of each group.
+        The groups' inputs and outputs together cover every input and output of this mapping exactly once.
+        If this mapping cannot be split then the result has a single MapSplit that contains
+        a simplified copy of this mapping and all of its inputs and outputs.
+    */
+    std::vector<MapSplit> factorize() const;
 
     /**
     Perform a forward transformation on 2-D array, putting the results into a pre-allocated 2-D array
@@ -285,6 +345,33 @@ public:
         return to;
     }
 
+    /**
+    Perform a forward transformation on a 2-D array of float, putting the results into a pre-allocated array
+
+    AST computes in double precision, so the points are converted to double (and the results back to float)
+    in small blocks as they are transformed, rather than by making double copies of the whole arrays.
+
+    @param[in] from  input coordinates, with dimensions (nPts, nIn)
+    @param[out] to  transformed coordinates, with dimensions (nPts, nOut)
+    */
+    void applyForward(ConstFloatArray2D const &from, FloatArray2D const &to) const {
+        _tranFloat(from, true, to);
+    }
+
+    /**
+    Perform a forward transformation on a 2-D array of float, returning the results as a new array
+
+    See @ref applyForward(ConstFloatArray2D const &, FloatArray2D const &) const for details.
+
+    @param[in] from  input coordinates, with dimensions (nPts, nIn)
+    @return the results as a new array with dimensions (nPts, nOut)
+    */
+    FloatArray2D applyForward(ConstFloatArray2D const &from) const {
+        FloatArray2D to = ndarray::allocate(getNOut(), from.getSize<1>());
+        _tranFloat(from, true, to);
+        return to;
+    }
+
     /**
     Perform an inverse transformation on a 2-D array, putting the results into a pre-allocated 2-D array
 
@@ -305,6 +392,32 @@ public:
         return to;
     }
 
+    /**
+    Perform an inverse transformation on a 2-D array of float, putting the results into a pre-allocated array
+
+    See @ref applyForward(ConstFloatArray2D const &, FloatArray2D const &) const for details.
+
+    @param[in] from  input coordinates, with dimensions (nPts, nOut)
+    @param[out] to  transformed coordinates, with dimensions (nPts, nIn)
+    */
+    void applyInverse(ConstFloatArray2D const &from, FloatArray2D const &to) const {
+        _tranFloat(from, false, to);
+    }
+
+    /**
+    Perform an inverse transformation on a 2-D array of float, returning the results as a new array
+
+    See @ref applyForward(ConstFloatArray2D const &, FloatArray2D const &) const for details.
+
+    @param[in] from  output coordinates, with dimensions (nPts, nOut)
+    @return the results as a new array with dimensions (nPts, nIn)
+    */
+    FloatArray2D applyInverse(ConstFloatArray2D const &from) const {
+        FloatArray2D to = ndarray::allocate(getNIn(), from.getSize<1>());
+        _tranFloat(from, false, to);
+        return to;
+    }
+
     /**
     Perform an inverse transformation on a vector, returning the results as a new vector
 
@@ -319,6 +432,172 @@ public:
         return to;
     }
 
+    /**
+    Perform a forward transformation on a 2-D array, putting the results into a workspace's output buffer
+
+    Use this instead of @ref applyForward(ConstArray2D const &) const "applyForward(from)"
+    when transforming many batches of points, to avoid allocating a new array for each batch.
+
+    @param[in] from  input coordinates, with dimensions (nIn, nPts); this may be a view
+                    of the workspace's input buffer
+    @param[in,out] workspace  workspace that provides the output buffer
+    @return the results, with dimensions (nOut, nPts); a view of the workspace's output buffer
+        that is overwritten by the next transform that uses the workspace
+
+    @throws std::invalid_argument if `workspace` was made for a mapping with a different
+        number of inputs or outputs.
+    */
+    Array2D applyForward(ConstArray2D const &from, TransformWorkspace &workspace) const;
+
+    /**
+    Perform an inverse transformation on a 2-D array, putting the results into a workspace's output buffer
+
+    See @ref applyForward(ConstArray2D const &, TransformWorkspace &) const "applyForward(from, workspace)",
+    swapping nIn and nOut.
+    */
+    Array2D applyInverse(ConstArray2D const &from, TransformWorkspace &workspace) const;
+
+    /**
+    Perform a forward transformation on a 2-D array in place
+
+    AST may read an input axis after it has written an output axis (e.g. @ref MatrixMap),
+    so the results are computed into a scratch buffer and then copied back into `data`.
+    That copy is much cheaper than allocating a new array, and no allocation is needed at all
+    if you supply a @ref TransformWorkspace.
+
+    @param[in,out] data  coordinates to transform, with dimensions (nIn, nPts);
+                    replaced by the transformed coordinates
+
+    @throws std::invalid_argument if nIn != nOut.
+    */
+    void applyForwardInPlace(Array2D const &data) const;
+
+    /**
+    Perform a forward transformation on a 2-D array in place, using a workspace's output buffer as scratch
+
+    @param[in,out] data  coordinates to transform, with dimensions (nIn, nPts);
+                    replaced by the transformed coordinates. This must not be a view
+                    of the workspace's output buffer.
+    @param[in,out] workspace  workspace whose output buffer is used as scratch
+
+    @throws std::invalid_argument if nIn != nOut or if `workspace` was made for a mapping with a different
+        number of inputs or outputs.
+    */
+    void applyForwardInPlace(Array2D const &data, TransformWorkspace &workspace) const;
+
+    /**
+    Perform an inverse transformation on a 2-D array in place
+
+    See @ref applyForwardInPlace(Array2D const &) const "applyForwardInPlace(data)"
+    */
+    void applyInverseInPlace(Array2D const &data) const;
+
+    /**
+    Perform an inverse transformation on a 2-D array in place, using a workspace's output buffer as scratch
+
+    See @ref applyForwardInPlace(Array2D const &, TransformWorkspace &) const
+        "applyForwardInPlace(data, workspace)"
+    */
+    void applyInverseInPlace(Array2D const &data, TransformWorkspace &workspace) const;
+
+    /**
+    Start a forward transformation of a 2-D array on a thread pool, returning a future for the results
+
+    The mapping is copied, so later changes to it do not affect the transform,
+    and the copy is used by a worker thread, so you need not lock or unlock anything.
+    `from` must not be modified until the transform finishes.
+
+    @param[in] from  input coordinates, with dimensions (nIn, nPts)
+    @param[in] token  token that may be used to cancel the transform; the transform checks it
+                    before it starts and between chunks of points
+    @param[in] pool  thread pool on which to run the transform; if null then use @ref getDefaultThreadPool
+    @return a future for the results, with dimensions (nOut, nPts). If the transform fails or is cancelled
+        then getting the result rethrows the exception (@ref OperationCancelled if cancelled).
+
+    @throws std::invalid_argument if `from` has the wrong number of rows; this is checked immediately.
+    */
+    std::future<Array2D> applyForwardAsync(ConstArray2D const &from,
+                                           CancellationToken const &token = CancellationToken(),
+                                           std::shared_ptr<ThreadPool> const &pool = nullptr) const {
+        return _submitTask(_makeTranTask(from, true, token), pool);
+    }
+
+    /**
+    Start a forward transformation of a 2-D array on a thread pool, calling a function when it finishes
+
+    See @ref applyForwardAsync(ConstArray2D const &, CancellationToken const &,
+    std::shared_ptr<ThreadPool> const &) const "applyForwardAsync(from, token, pool)" for details.
+
+    @param[in] from  input coordinates, with dimensions (nIn, nPts)
+    @param[in] callback  function to call, on a worker thread, when the transform finishes or fails;
+                    exceptions thrown by `callback` are ignored
+    @param[in] token  token that may be used to cancel the transform
+    @param[in] pool  thread pool on which to run the transform; if null then use @ref getDefaultThreadPool
+    */
+    void applyForwardAsync(ConstArray2D const &from, TransformCallback const &callback,
+                           CancellationToken const &token = CancellationToken(),
+                           std::shared_ptr<ThreadPool> const &pool = nullptr) const {
+        _postTask(_makeTranTask(from, true, token), callback, pool);
+    }
+
+    /**
+    Start an inverse transformation of a 2-D array on a thread pool, returning a future for the results
+
+    See @ref applyForwardAsync(ConstArray2D const &, CancellationToken const &,
+    std::shared_ptr<ThreadPool> const &) const "applyForwardAsync(from, token, pool)",
+    swapping nIn and nOut.
+    */
+    std::future<Array2D> applyInverseAsync(ConstArray2D const &from,
+                                           CancellationToken const &token = CancellationToken(),
+                                           std::shared_ptr<ThreadPool> const &pool = nullptr) const {
+        return _submitTask(_makeTranTask(from, false, token), pool);
+    }
+
+    /**
+    Start an inverse transformation of a 2-D array on a thread pool, calling a function when it finishes
+
+    See @ref applyForwardAsync(ConstArray2D const &, TransformCallback const &, CancellationToken const &,
+    std::shared_ptr<ThreadPool> const &) const "applyForwardAsync(from, callback, token, pool)",
+    swapping nIn and nOut.
+    */
+    void applyInverseAsync(ConstArray2D const &from, TransformCallback const &callback,
+                           CancellationToken const &token = CancellationToken(),
+                           std::shared_ptr<ThreadPool> const &pool = nullptr) const {
+        _postTask(_makeTranTask(from, false, token), callback, pool);
+    }
+
+    /**
+    Start transforming a grid of points in the forward direction on a thread pool,
+    returning a future for the results
+
+    See the overload of tranGridForward that returns a new array for the grid arguments, and
+    @ref applyForwardAsync(ConstArray2D const &, CancellationToken const &,
+    std::shared_ptr<ThreadPool> const &) const "applyForwardAsync(from, token, pool)"
+    for the other arguments. The token is only checked before the transform starts.
+    */
+    std::future<Array2D> tranGridForwardAsync(PointI const &lbnd, PointI const &ubnd, double tol, int maxpix,
+                                              std::size_t nPts,
+                                              CancellationToken const &token = CancellationToken(),
+                                              std::shared_ptr<ThreadPool> const &pool = nullptr) const {
+        return _submitTask(_makeTranGridTask(lbnd, ubnd, tol, maxpix, nPts, token), pool);
+    }
+
+    /**
+    Start transforming a grid of points in the forward direction on a thread pool,
+    calling a function when it finishes
+
+    See @ref tranGridForwardAsync(PointI const &, PointI const &, double, int, std::size_t,
+    CancellationToken const &, std::shared_ptr<ThreadPool> const &) const "tranGridForwardAsync"
+    and @ref applyForwardAsync(ConstArray2D const &, TransformCallback const &, CancellationToken const &,
+    std::shared_ptr<ThreadPool> const &) const "applyForwardAsync(from, callback, token, pool)".
+    */
+    void tranGridForwardAsync(PointI const &lbnd, PointI const &ubnd, double tol, int maxpix,
+                              std::size_t nPts, TransformCallback const &callback,
+                              CancellationToken const &token = CancellationToken(),
+                              std::shared_ptr<ThreadPool> const &pool = nullptr) const {
+        _postTask(_makeTranGridTask(lbnd, ubnd, tol, maxpix, nPts, token), callback, pool);
+    }
+
     /**
     Transform a grid of points in the forward direction
 
@@ -366,7 +645,8 @@ public:
     See the overload of tranGridForward that outputs the data as the last argument
     for more information
     */
-    Array2D tranGridForward(PointI const &lbnd, PointI const &ubnd, double tol, int maxpix, int nPts) const {
+    Array2D tranGridForward(PointI const &lbnd, PointI const &ubnd, double tol, int maxpix,
+                            std::size_t nPts) const {
         Array2D to = ndarray::allocate(nPts, getNOut());
         _tranGrid(lbnd, ubnd, tol, maxpix, true, to);
         return to;
@@ -387,7 +667,8 @@ public:
 
     See tranGridForward for the arguments, swapping nIn and nOut
     */
-    Array2D tranGridInverse(PointI const &lbnd, PointI const &ubnd, double tol, int maxpix, int nPts) const {
+    Array2D tranGridInverse(PointI const &lbnd, PointI const &ubnd, double tol, int maxpix,
+                            std::size_t nPts) const {
         Array2D to = ndarray::allocate(nPts, getNIn());
         _tranGrid(lbnd, ubnd, tol, maxpix, false, to);
         return to;
@@ -434,14 +715,89 @@ private:
     @param[in] from  input coordinates, with dimensions (nPts, nIn)
     @param[in] doForward  if true then perform a forward transform, else inverse
     @param[out] to  transformed coordinates, must be pre-allocated with dimensions (nPts, nOut)
+    @param[in] nanInputIsBad  treat NaN input coordinates as bad? (see TransformWorkspace::setNanInputIsBad)
     */
-    void _tran(ConstArray2D const &from, bool doForward, Array2D const &to) const;
+    void _tran(ConstArray2D const &from, bool doForward, Array2D const &to, bool nanInputIsBad = false) const;
+
+    /**
+    Implement applyForward and applyInverse for arrays of float
+
+    Points are converted to double in blocks small enough to stay in cache, transformed,
+    and converted back to float, replacing AST__BAD with NaN.
+    */
+    void _tranFloat(ConstFloatArray2D const &from, bool doForward, FloatArray2D const &to) const;
+
+    /**
+    Transform points [begin, end) of `from` into the same points of `to`
+
+    This is the unit of work of all the array transforms. The points are passed to AST in pieces
+    small enough to stay in cache (and never more than detail::getMaxTranChunk() points),
+    and AST__BAD is replaced with NaN in each piece of `to` right after it is transformed,
+    rather than in a separate pass over the whole array. If `nanInputIsBad` is true
+    then NaN is replaced with AST__BAD in a copy of each piece of `from` before it is transformed.
+    Only points [begin, end) of `to` are written. Unlike _tran, this does not check its arguments.
+    */
+    void _tranRange(ConstArray2D const &from, bool doForward, Array2D const &to, std::size_t begin,
+                    std::size_t end, bool nanInputIsBad = false) const;
+
+    /**
+    Make a task that performs an asynchronous applyForward or applyInverse
+
+    The task uses its own copy of this mapping, which is unlocked so that the thread running
+    the task can lock it.
+
+    @throws std::invalid_argument if `from` has the wrong number of rows.
+    */
+    std::function<Array2D()> _makeTranTask(ConstArray2D const &from, bool doForward,
+                                           CancellationToken const &token) const;
+
+    /**
+    Make a task that performs an asynchronous tranGridForward
+
+    See _makeTranTask for details.
+    */
+    std::function<Array2D()> _makeTranGridTask(PointI const &lbnd, PointI const &ubnd, double tol, int maxpix,
+                                               std::size_t nPts, CancellationToken const &token) const;
+
+    /// Submit a task from _makeTranTask or _makeTranGridTask, returning a future for its result
+    static std::future<Array2D> _submitTask(std::function<Array2D()> task,
+                                            std::shared_ptr<ThreadPool> const &pool);
+
+    /// Post a task from _makeTranTask or _makeTranGridTask that calls `callback` when done
+    static void _postTask(std::function<Array2D()> task, TransformCallback const &callback,
+                          std::shared_ptr<ThreadPool> const &pool);
+
+    /**
+    Implement applyForwardInPlace and applyInverseInPlace
+
+    @param[in,out] data  coordinates to transform; replaced by the transformed coordinates
+    @param[in] doForward  if true then perform a forward transform, else inverse
+    @param[in] workspace  workspace to use for scratch; if null then a scratch array is allocated
+    */
+    void _tranInPlace(Array2D const &data, bool doForward, TransformWorkspace *workspace) const;
 
     /**
     Implementat tranGridForward and tranGridInverse, which see.
     */
     void _tranGrid(PointI const &lbnd, PointI const &ubnd, double tol, int maxpix, bool doForward,
                    Array2D const &to) const;
+
+    /**
+    Implement _tranGrid for grids with more points than AST can transform in one call
+
+    Transform the grid in chunks of at most detail::getMaxTranChunk() points by splitting it
+    along `axis` and, if necessary, recursively along faster-varying axes.
+
+    @param[in,out] lbnd, ubnd  Grid bounds; the bounds for axes > `axis` must already be fixed
+                (lbnd = ubnd). Restored before returning.
+    @param[in] axis  Axis to split along
+    @param[in] offset  Index of the first output point of this part of the grid
+    @param[in] tol, maxpix, doForward  See _tranGrid
+    @param[out] to  Output array for the whole grid
+    @return offset of the next output point
+    */
+    std::size_t _tranGridChunks(PointI &lbnd, PointI &ubnd, int axis, std::size_t offset, double tol,
+                                int maxpix, bool doForward, Array2D const &to) const;
 };
 
 }  // namespace ast
@@ -0,0 +1,72 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_MAPPINGCOST_H
+#define ASTSHIM_MAPPINGCOST_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ast {
+
+/**
+Description of the structure and cost of a Mapping, as returned by Mapping::explain
+
+Each MappingCost describes one node of a simplified mapping tree:
+compound mappings (SeriesMap and ParallelMap) have two children, and all other mappings are leaves.
+
+Costs are in nanoseconds per point. The modelled cost is a rough estimate based on
+the class of mapping and its complexity (e.g. the number of polynomial terms);
+for compound mappings it is the sum of the modelled costs of the children.
+The measured cost is obtained by timing the transformation of sample points.
+*/
+struct MappingCost {
+    std::string className;  ///< class name, e.g. "SeriesMap" or "PolyMap"
+    std::string ident;      ///< @ref Object_Ident "Ident" of the mapping; blank if not set
+    int nIn = 0;            ///< number of input axes (in the direction explained)
+    int nOut = 0;           ///< number of output axes (in the direction explained)
+    /**
+    Class-specific properties that affect the cost, including:
+    - "order": maximum polynomial order (PolyMap and ChebyMap)
+    - "nTerms": total number of polynomial terms for all outputs (PolyMap and ChebyMap)
+    - "iterative": 1 if the transform is computed iteratively (PolyMap), else 0
+    - "lutSize": number of lookup table entries (LutMap)
+    - "nExpressions": number of expressions (MathMap)
+    */
+    std::map<std::string, double> properties;
+    double modelledCost = 0;  ///< modelled cost (ns/point); nan if the transform is not defined
+    double measuredCost = 0;  ///< measured cost (ns/point); nan if not measured or not defined
+    std::vector<MappingCost> children;  ///< the two component mappings of a SeriesMap or ParallelMap
+
+    /// Get the best estimate of the cost (ns/point): measured if available, else modelled
+    double getCost() const;
+
+    /**
+    Return a multi-line description of the tree, with one line per node
+    indented to show the structure.
+    */
+    std::string toString() const;
+};
+
+}  // namespace ast
+
+#endif
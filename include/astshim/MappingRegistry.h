@@ -0,0 +1,122 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_MAPPINGREGISTRY_H
+#define ASTSHIM_MAPPINGREGISTRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "astshim/base.h"
+#include "astshim/Mapping.h"
+
+namespace ast {
+
+/**
+A registry of shared, immutable mappings, so that structurally identical mappings are stored once
+
+Caches of WCS often hold many mappings that are identical apart from a few components:
+for example the camera distortion of every exposure of a night. Interning each mapping
+(or each component that is likely to repeat) in a registry replaces duplicates
+by a single shared instance. Two mappings are considered identical if they have the same
+serialized form (as given by Object::show without comments), so a mapping is identical
+to a deep copy of itself but not to a different mapping that happens to transform points the same way.
+Serialized forms are compared using two independent 64-bit hashes, so a false match is vanishingly unlikely.
+
+The interned mappings are immutable; to change one, make a copy (which is independent of the registry)
+and change that. From Python, @ref intern returns a copy of the shared instance, since Python
+cannot prevent changes to it. See FrameSetRouter for a way to intern the mappings between frames
+of a FrameSet.
+
+Like other AST objects, a registry is not thread safe.
+*/
+class MappingRegistry {
+public:
+    MappingRegistry() = default;
+
+    MappingRegistry(MappingRegistry const &) = delete;
+    MappingRegistry(MappingRegistry &&) = default;
+    MappingRegistry &operator=(MappingRegistry const &) = delete;
+    MappingRegistry &operator=(MappingRegistry &&) = default;
+
+    ~MappingRegistry() = default;
+
+    /**
+    Return the shared instance of a mapping, adding a copy of it to the registry if it is new
+
+    @param[in] mapping  Mapping to intern; it is not modified or retained
+    @return the shared, immutable instance that is identical to `mapping`
+    */
+    std::shared_ptr<Mapping const> intern(Mapping const &mapping);
+
+    /// Get the number of distinct mappings in the registry
+    std::size_t getNEntries() const { return _nEntries; }
+
+    /// Get the number of calls to @ref intern
+    std::size_t getNLookups() const { return _nLookups; }
+
+    /// Get the number of calls to @ref intern that found an identical mapping in the registry
+    std::size_t getNHits() const { return _nLookups - _nMisses; }
+
+    /// Get the total in-memory size of the distinct mappings in the registry, in bytes
+    std::size_t getBytes() const { return _bytes; }
+
+    /**
+    Get the memory saved by interning, in bytes
+
+    This is the total in-memory size of the mappings passed to @ref intern
+    that were replaced by an existing shared instance.
+    */
+    std::size_t getBytesSaved() const { return _bytesSaved; }
+
+    /**
+    Remove mappings that are only referenced by the registry
+
+    @return the number of mappings removed
+    */
+    std::size_t purge();
+
+    /// Remove all mappings and reset the statistics
+    void clear();
+
+private:
+    struct Entry {
+        std::shared_ptr<Mapping const> mapping;
+        std::size_t bytes;
+        std::uint64_t checksum;  // a second, independent hash of the serialized form
+    };
+
+    // entries indexed by a hash of their serialized form; entries with the same hash are kept in a list
+    // and told apart by their checksums, so that lookups need not serialize the stored mappings
+    std::unordered_map<std::size_t, std::vector<Entry>> _entries;
+    std::size_t _nEntries = 0;
+    std::size_t _nLookups = 0;
+    std::size_t _nMisses = 0;
+    std::size_t _bytes = 0;
+    std::size_t _bytesSaved = 0;
+};
+
+}  // namespace ast
+
+#endif
@@ -61,7 +61,9 @@ public:
     virtual ~Object() {}
 
     /// Copy constructor: make a deep copy
-    Object(Object const &object) : _objPtr(object.getRawPtrCopy(), &detail::annulAstObject) {}
+    Object(Object const &object) : _objPtr(object.getRawPtrCopy(), &detail::annulAstObject) {
+        detail::censusAdd(getRawPtr());
+    }
     Object(Object &&) = default;
     Object &operator=(Object const &) = delete;
     Object &operator=(Object &&) = default;
@@ -117,6 +119,7 @@ public:
     indicating that no value has been set.
     */
     void clear(std::string const &attrib) {
+        detail::noteAttributeChange(getRawPtr(), attrib);
         astClear(getRawPtr(), attrib.c_str());
         assertOK();
     }
@@ -438,6 +441,7 @@ protected:
     @throws std::runtime_error if the attribute is read-only
     */
     void set(std::string const &setting) {
+        detail::noteAttributeChange(getRawPtr(), setting);
         astSet(getRawPtr(), "%s", setting.c_str());
         assertOK();
     }
@@ -462,6 +466,7 @@ protected:
     @throws std::runtime_error if the attribute does not exist or the value cannot be converted
     */
     void setC(std::string const &attrib, std::string const &value) {
+        detail::noteAttributeChange(getRawPtr(), attrib);
         astSetC(getRawPtr(), attrib.c_str(), value.c_str());
         assertOK();
     }
@@ -22,6 +22,7 @@
 #ifndef ASTSHIM_SOURCESINK_H
 #define ASTSHIM_SOURCESINK_H
 
+#include <exception>
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -49,7 +50,13 @@ public:
                         may be nullptr if sinking not needed
     */
     explicit Stream(std::istream *istreamPtr, std::ostream *ostreamPtr)
-            : _istreamPtr(), _ostreamPtr(), _sourceStr(), _isFits(false) {
+            : _istreamPtr(),
+              _ostreamPtr(),
+              _sourceStr(),
+              _isFits(false),
+              _nBytesSourced(0),
+              _nBytesSunk(0),
+              _sourceError() {
         if (istreamPtr) {
             _istreamPtr = std::make_shared<std::istream>(istreamPtr->rdbuf());
         }
@@ -80,23 +87,58 @@ public:
         or in an error state.
         The Stream owns the string buffer, and it will be invalidated on the next
         call to this function.
+
+    This is called from AST, so it does not throw: if reading throws an exception
+    then the exception is saved (see @ref rethrowSourceError) and nullptr is returned.
     */
     char const *source() {
         if ((_istreamPtr) && (*_istreamPtr)) {
-            if (_isFits) {
-                // http://codereview.stackexchange.com/a/28759
-                _sourceStr.resize(detail::FITSLEN);
-                _istreamPtr->read(&_sourceStr[0], detail::FITSLEN);
-            } else {
-                std::getline(*_istreamPtr, _sourceStr);
+            try {
+                if (_isFits) {
+                    // http://codereview.stackexchange.com/a/28759
+                    _sourceStr.resize(detail::FITSLEN);
+                    _istreamPtr->read(&_sourceStr[0], detail::FITSLEN);
+                } else {
+                    std::getline(*_istreamPtr, _sourceStr);
+                }
+            } catch (...) {
+                _sourceError = std::current_exception();
+                return nullptr;
             }
             if (*_istreamPtr) {
+                _nBytesSourced += _sourceStr.size();
                 return _sourceStr.c_str();
             }
         }
         return nullptr;
     }
 
+    /**
+    Source (read) up to `size` bytes from the stream, ignoring line breaks
+
+    This lets code that splits the text itself (such as @ref ChannelReader for XML)
+    read in blocks of bounded size, even if the text has no line breaks.
+
+    @param[out] buffer  buffer to receive the data; it is not null terminated
+    @param[in] size  maximum number of bytes to read
+    @return the number of bytes read; 0 if there is no source stream or the source stream
+        is exhausted or in an error state.
+    */
+    std::size_t sourceBlock(char *buffer, std::size_t size) {
+        if (!_istreamPtr || !*_istreamPtr) {
+            return 0;
+        }
+        try {
+            _istreamPtr->read(buffer, size);
+        } catch (...) {
+            _sourceError = std::current_exception();
+            return 0;
+        }
+        auto const nRead = static_cast<std::size_t>(_istreamPtr->gcount());
+        _nBytesSourced += nRead;
+        return nRead;
+    }
+
     /**
     Sink (write) to the stream
 
@@ -110,8 +152,10 @@ public:
     bool sink(char const *cstr) {
         if (_ostreamPtr) {
             (*_ostreamPtr) << cstr;
+            _nBytesSunk += std::char_traits<char>::length(cstr);
             if (!_isFits) {
                 (*_ostreamPtr) << std::endl;
+                ++_nBytesSunk;
             }
             return static_cast<bool>(*_ostreamPtr);
         } else {
@@ -119,6 +163,23 @@ public:
         }
     }
 
+    /// Did reading the source stream throw an exception? See @ref rethrowSourceError
+    bool hasSourceError() const { return static_cast<bool>(_sourceError); }
+
+    /**
+    Throw the exception that stopped @ref source or @ref sourceBlock, if any
+
+    Streams whose buffers report errors by throwing (such as @ref CompressedFileStream)
+    would otherwise look as if they had simply ended, so channels call this when there is
+    no more data, to report the error instead. The error is not cleared, since the source stream
+    cannot be read any further.
+    */
+    void rethrowSourceError() const {
+        if (_sourceError) {
+            std::rethrow_exception(_sourceError);
+        }
+    }
+
     friend class Channel;
 
     /// get isfits
@@ -134,6 +195,9 @@ protected:
     /// so @ref source can return a `char *` that won't disappear right away
     std::string _sourceStr;
     bool _isFits;  ///< is this a FITS stream?
+    std::size_t _nBytesSourced;  ///< number of bytes sourced; used for instrumentation
+    std::size_t _nBytesSunk;     ///< number of bytes sunk; used for instrumentation
+    std::exception_ptr _sourceError;  ///< exception thrown while reading the source stream, if any
 };
 
 /**
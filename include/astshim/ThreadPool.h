@@ -0,0 +1,209 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_THREADPOOL_H
+#define ASTSHIM_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace ast {
+
+/**
+Exception thrown by an asynchronous operation that was cancelled using a @ref CancellationToken
+*/
+class OperationCancelled : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+A flag that can be used to cancel asynchronous operations
+
+Copies share the same flag, so keep a copy of the token passed to an asynchronous operation
+and call cancel on it to ask that operation to stop. Operations check the flag before they start
+and between chunks of work, and report cancellation by throwing @ref OperationCancelled.
+*/
+class CancellationToken {
+public:
+    CancellationToken() : _cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+    CancellationToken(CancellationToken const &) = default;
+    CancellationToken(CancellationToken &&) = default;
+    CancellationToken &operator=(CancellationToken const &) = default;
+    CancellationToken &operator=(CancellationToken &&) = default;
+
+    ~CancellationToken() = default;
+
+    /// Ask operations that use this token to stop
+    void cancel() { *_cancelled = true; }
+
+    /// Has cancel been called?
+    bool isCancelled() const { return *_cancelled; }
+
+    /// Throw @ref OperationCancelled if cancel has been called
+    void throwIfCancelled() const {
+        if (isCancelled()) {
+            throw OperationCancelled("Operation cancelled");
+        }
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> _cancelled;
+};
+
+/**
+A pool of worker threads that run tasks, with work stealing and an optional bound on queued tasks
+
+Each worker has its own queue. Tasks submitted by a worker (e.g. one task splitting its work into more)
+go onto that worker's queue, and other tasks are distributed among the queues in turn.
+A worker runs the most recently added task from its own queue and, when that is empty,
+steals the oldest task from another worker's queue.
+
+If `maxQueued` is positive then @ref submit and @ref post block while that many tasks are waiting
+to run, which stops a fast producer from queuing an unbounded amount of work.
+Tasks submitted by a worker never block, to avoid deadlock.
+
+Destroying the pool waits for all queued tasks to finish.
+
+Asynchronous astshim operations such as @ref Mapping::applyForwardAsync use
+@ref getDefaultThreadPool unless you supply a pool.
+*/
+class ThreadPool {
+public:
+    /**
+    Construct a thread pool
+
+    @param[in] nThreads  Number of worker threads; 0 for one per available core
+    @param[in] maxQueued  Maximum number of tasks waiting to run before submit blocks;
+                        0 for no limit
+
+    @throws std::invalid_argument if `nThreads` < 0
+    */
+    explicit ThreadPool(int nThreads = 0, std::size_t maxQueued = 0);
+
+    ThreadPool(ThreadPool const &) = delete;
+    ThreadPool(ThreadPool &&) = delete;
+    ThreadPool &operator=(ThreadPool const &) = delete;
+    ThreadPool &operator=(ThreadPool &&) = delete;
+
+    /// Wait for all queued tasks to finish, then stop the worker threads
+    ~ThreadPool();
+
+    /// Get the number of worker threads
+    int getNThreads() const { return static_cast<int>(_threads.size()); }
+
+    /// Get the maximum number of tasks that may wait to run before submit blocks; 0 if no limit
+    std::size_t getMaxQueued() const { return _maxQueued; }
+
+    /// Get the number of tasks waiting to run (not including tasks that are running)
+    std::size_t getNQueued() const;
+
+    /**
+    Submit a task, returning a future for its result
+
+    Exceptions thrown by the task are stored in the future.
+
+    @param[in] func  Callable that takes no arguments
+    @return a future for the result of `func()`
+    */
+    template <typename Func>
+    auto submit(Func func) -> std::future<decltype(func())> {
+        using Result = decltype(func());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(func));
+        auto future = task->get_future();
+        _push([task] { (*task)(); });
+        return future;
+    }
+
+    /**
+    Submit a task whose result is not wanted
+
+    @param[in] func  Callable that takes no arguments; any exception it throws is ignored,
+                    so handle exceptions inside the task
+    */
+    void post(std::function<void()> func) { _push(std::move(func)); }
+
+    /**
+    Is the calling thread one of the workers of this pool?
+    */
+    bool isWorkerThread() const;
+
+private:
+    // Queue of one worker; protected by its own mutex so workers rarely contend
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    // Add a task to a queue, blocking if the pool is full and the caller is not a worker
+    void _push(std::function<void()> task);
+
+    // Pop a task from the back of queue `index`, or steal one from the front of another queue
+    bool _tryPop(std::size_t index, std::function<void()> &task);
+
+    // Main loop of worker `index`
+    void _run(std::size_t index);
+
+    std::size_t const _maxQueued;
+    std::vector<std::unique_ptr<WorkerQueue>> _queues;
+    std::vector<std::thread> _threads;
+    std::atomic<std::size_t> _nextQueue;
+    mutable std::mutex _mutex;  // protects _nQueued, _nReady and _stop
+    std::condition_variable _notEmpty;
+    std::condition_variable _notFull;
+    std::size_t _nQueued;  // tasks accepted by _push and not yet started
+    std::size_t _nReady;   // tasks in the queues that no worker has claimed yet
+    bool _stop;
+};
+
+/**
+Get the thread pool used by asynchronous astshim operations when no pool is specified
+
+The pool is created when first needed. Its number of threads is set by environment variable
+`ASTSHIM_NUM_THREADS` (default: one per core) and its maximum number of queued tasks
+by `ASTSHIM_MAX_QUEUED` (default: no limit).
+*/
+std::shared_ptr<ThreadPool> getDefaultThreadPool();
+
+/**
+Replace the thread pool used by asynchronous astshim operations when no pool is specified
+
+Operations already submitted to the old pool are not affected; the old pool is destroyed
+(after finishing its tasks) when the last reference to it goes away.
+
+@param[in] pool  New default pool; if null then a new pool is created when next needed,
+                as described in @ref getDefaultThreadPool.
+*/
+void setDefaultThreadPool(std::shared_ptr<ThreadPool> pool);
+
+}  // namespace ast
+
+#endif
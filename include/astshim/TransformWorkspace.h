@@ -0,0 +1,161 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_TRANSFORMWORKSPACE_H
+#define ASTSHIM_TRANSFORMWORKSPACE_H
+
+#include <cstddef>
+
+#include "ndarray.h"
+
+#include "astshim/base.h"
+
+namespace ast {
+
+class Mapping;
+
+/**
+Reusable buffers for transforming many batches of points with one @ref Mapping
+
+Code that transforms a long stream of small batches spends much of its time allocating
+and zeroing new arrays. A TransformWorkspace owns an input and an output buffer that are sized
+for a particular mapping and reused for every batch; they only grow (reallocate) when asked
+for more points than they can hold. Pass a workspace to @ref Mapping::applyForward(ConstArray2D const &,
+TransformWorkspace &) const "Mapping::applyForward", @ref Mapping::applyInverse(ConstArray2D const &,
+TransformWorkspace &) const "Mapping::applyInverse" or the in-place transforms.
+
+Typical use:
+
+    TransformWorkspace workspace(mapping, batchSize);
+    for (...) {
+        auto from = workspace.getInput(nPoints);
+        // ...fill `from` with the next batch of points...
+        auto to = mapping.applyForward(from, workspace);
+        // ...use `to`...
+    }
+
+@warning The arrays returned by getInput, getOutput and by the transform methods that take a workspace
+are views into the workspace's buffers. Their contents are overwritten by the next call that uses the
+same buffer, so copy any data you want to keep. The views remain valid memory even after the workspace
+grows or is destroyed, but no longer share data with it.
+
+A workspace also holds options for the transforms that use it; see @ref setNanInputIsBad.
+
+A workspace is not thread safe; use one workspace per thread.
+*/
+class TransformWorkspace {
+public:
+    /**
+    Construct a workspace for a mapping
+
+    @param[in] mapping  Mapping the workspace will be used with; only its number of inputs and outputs
+                        are recorded, so the workspace may also be used with any mapping that has
+                        the same number of inputs and outputs.
+    @param[in] nPoints  Number of points to reserve space for; the buffers grow as needed.
+    */
+    explicit TransformWorkspace(Mapping const &mapping, std::size_t nPoints = 0);
+
+    TransformWorkspace(TransformWorkspace const &) = default;
+    TransformWorkspace(TransformWorkspace &&) = default;
+    TransformWorkspace &operator=(TransformWorkspace const &) = default;
+    TransformWorkspace &operator=(TransformWorkspace &&) = default;
+
+    ~TransformWorkspace() = default;
+
+    /// Get the number of inputs of the mapping this workspace is for
+    int getNIn() const { return _nIn; }
+
+    /// Get the number of outputs of the mapping this workspace is for
+    int getNOut() const { return _nOut; }
+
+    /// Get the number of points the buffers can hold without reallocating
+    std::size_t getCapacity() const { return _capacity; }
+
+    /// Get the number of times the buffers have been allocated; useful for tuning the initial size
+    int getNAllocations() const { return _nAllocations; }
+
+    /// Do transforms using this workspace treat NaN input coordinates as bad?
+    bool getNanInputIsBad() const { return _nanInputIsBad; }
+
+    /**
+    Set whether transforms using this workspace treat NaN input coordinates as bad
+
+    AST only recognizes `AST__BAD` as a bad coordinate value and may transform NaN into
+    a finite (but meaningless) result. If this is enabled then transforms using this workspace
+    replace NaN input coordinates with `AST__BAD` before transforming them, so those points
+    become NaN in the output, just as points that AST cannot transform do.
+    The input arrays are not modified.
+
+    This is disabled by default, because it costs an extra pass over the input.
+    */
+    void setNanInputIsBad(bool nanInputIsBad) { _nanInputIsBad = nanInputIsBad; }
+
+    /**
+    Make sure the buffers can hold at least `nPoints` points
+
+    Existing buffer contents are not preserved if the buffers grow.
+    */
+    void reserve(std::size_t nPoints);
+
+    /**
+    Get a view of the input buffer, growing it if necessary
+
+    @param[in] nPoints  Number of points
+    @param[in] forward  If true return a view suitable for a forward transform, with dimensions
+                        (nIn, nPoints), else for an inverse transform, with dimensions (nOut, nPoints)
+    */
+    Array2D getInput(std::size_t nPoints, bool forward = true);
+
+    /**
+    Get a view of the output buffer, growing it if necessary
+
+    @param[in] nPoints  Number of points
+    @param[in] forward  If true return a view suitable for a forward transform, with dimensions
+                        (nOut, nPoints), else for an inverse transform, with dimensions (nIn, nPoints)
+    */
+    Array2D getOutput(std::size_t nPoints, bool forward = true);
+
+    /**
+    Throw std::invalid_argument unless this workspace is compatible with a mapping
+
+    @param[in] mapping  Mapping to check
+    */
+    void assertCompatible(Mapping const &mapping) const;
+
+private:
+    using Buffer = ndarray::Array<double, 1, 1>;
+
+    // Return a contiguous view of the start of `buffer` with dimensions (nAxes, nPoints)
+    static Array2D _view(Buffer const &buffer, int nAxes, std::size_t nPoints);
+
+    int _nIn;
+    int _nOut;
+    std::size_t _capacity;
+    int _nAllocations;
+    bool _nanInputIsBad;
+    // Both buffers hold max(nIn, nOut) * capacity values
+    Buffer _input;
+    Buffer _output;
+};
+
+}  // namespace ast
+
+#endif
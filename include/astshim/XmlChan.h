@@ -42,6 +42,10 @@ by @ref Channel and @ref Object
 @ref XmlChan_XmlFormat "XmlFormat": system for formatting Objects as XML.
 @ref XmlChan_XmlLength "XmlLength": controls output buffer length; 0 for no limit.
 @ref XmlChan_XmlPrefix "XmlPrefix": the namespace prefix to use when writing.
+
+To read a large document holding many objects, use @ref Channel.readAll or @ref ChannelReader,
+which split the document into the elements of its AST objects as it is read and decode each one
+as soon as it is complete.
 */
 class XmlChan : public Channel {
 public:
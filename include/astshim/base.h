@@ -45,6 +45,14 @@ using Array2D = ndarray::Array<double, 2, 2>;
 */
 using ConstArray2D = ndarray::Array<const double, 2, 2>;
 /**
+2D array of float; used for lists of points stored in single precision
+*/
+using FloatArray2D = ndarray::Array<float, 2, 2>;
+/**
+2D array of const float; used for lists of const points stored in single precision
+*/
+using ConstFloatArray2D = ndarray::Array<const float, 2, 2>;
+/**
 Vector of ints; typically used for the bounds of Mapping.tranGridForward and inverse
 */
 using PointI = std::vector<int>;
@@ -0,0 +1,77 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_BATCHAPPLY_H
+#define ASTSHIM_BATCHAPPLY_H
+
+#include <memory>
+#include <vector>
+
+#include "astshim/base.h"
+#include "astshim/Mapping.h"
+#include "astshim/ThreadPool.h"
+
+namespace ast {
+
+/**
+One transform for @ref batchApply: a mapping and the points to transform with it
+*/
+struct BatchJob {
+    /**
+    Construct a job
+
+    @param[in] mapping  Mapping to apply; it must outlive the call to batchApply
+    @param[in] from  Points to transform, with dimensions (nIn, nPts) for a forward transform,
+                    or (nOut, nPts) for an inverse transform
+    */
+    BatchJob(Mapping const &mapping, ConstArray2D const &from) : mapping(&mapping), from(from) {}
+
+    Mapping const *mapping;  ///< mapping to apply
+    ConstArray2D from;       ///< points to transform
+};
+
+/**
+Apply many mappings, each to its own set of points, using a thread pool
+
+This is intended for workloads such as transforming the sources of each detector of a camera
+with that detector's WCS, where the jobs vary widely in size. The work is divided into units of
+roughly equal numbers of points: large jobs are split into chunks and small jobs are packed together.
+The units run on the thread pool, each with its own copies of the mappings it uses.
+
+Several jobs may use the same mapping.
+
+@param[in] jobs  Transforms to perform
+@param[in] forward  Perform forward transforms? If false, perform inverse transforms.
+@param[in] pool  Thread pool to use; if null then use @ref getDefaultThreadPool.
+                Do not call batchApply from a task running on the same pool.
+@return the transformed points, one array per job, in the same order as `jobs`
+
+@throws std::invalid_argument if any job has a null mapping or the wrong number of input axes;
+    this is checked before any work starts.
+@throws std::runtime_error if any transform fails (e.g. the mapping does not have the requested
+    transform); the exception from the first failing unit of work is rethrown after all units finish.
+*/
+std::vector<Array2D> batchApply(std::vector<BatchJob> const &jobs, bool forward = true,
+                                std::shared_ptr<ThreadPool> const &pool = nullptr);
+
+}  // namespace ast
+
+#endif
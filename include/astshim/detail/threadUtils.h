@@ -0,0 +1,99 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_DETAIL_THREADUTILS_H
+#define ASTSHIM_DETAIL_THREADUTILS_H
+
+#include <memory>
+
+#include "astshim/Mapping.h"
+
+namespace ast {
+namespace detail {
+
+/**
+A copy of a mapping for use by another thread
+
+AST objects may only be used by the thread that has locked them, and a new object is locked by the thread
+that creates it. So this copies the mapping and unlocks the copy; the thread that uses it locks it for
+the lifetime of a @ref MappingForThread::Lock "Lock". The destructor locks the copy for the destroying
+thread, so it can be annulled by whichever thread releases the last reference.
+*/
+class MappingForThread {
+public:
+    /**
+    Lock the copy for the calling thread; unlock it again on destruction
+
+    The copy must be unlocked before another thread can lock it (including to destroy it),
+    so hold the lock only while using the mapping.
+    */
+    class Lock {
+    public:
+        explicit Lock(MappingForThread &mapping) : _mapping(*mapping._mapping) { _mapping.lock(true); }
+
+        Lock(Lock const &) = delete;
+        Lock(Lock &&) = delete;
+        Lock &operator=(Lock const &) = delete;
+        Lock &operator=(Lock &&) = delete;
+
+        ~Lock() {
+            try {
+                _mapping.unlock();
+            } catch (...) {
+                // nothing useful can be done in a destructor
+            }
+        }
+
+        /// Get the locked copy
+        Mapping &get() const { return _mapping; }
+
+    private:
+        Mapping &_mapping;
+    };
+
+    /**
+    Copy a mapping
+
+    @param[in] mapping  Mapping to copy; must be locked by the calling thread
+    */
+    explicit MappingForThread(Mapping const &mapping) : _mapping(mapping.copy()) { _mapping->unlock(); }
+
+    MappingForThread(MappingForThread const &) = delete;
+    MappingForThread(MappingForThread &&) = delete;
+    MappingForThread &operator=(MappingForThread const &) = delete;
+    MappingForThread &operator=(MappingForThread &&) = delete;
+
+    ~MappingForThread() {
+        try {
+            _mapping->lock(true);
+        } catch (...) {
+            // nothing useful can be done; annulling the copy will report an AST error
+        }
+    }
+
+private:
+    std::shared_ptr<Mapping> _mapping;
+};
+
+}  // namespace detail
+}  // namespace ast
+
+#endif
@@ -30,6 +30,8 @@
 #include <vector>
 
 #include "astshim/base.h"
+#include "astshim/Census.h"
+#include "astshim/Instrumentation.h"
 
 namespace ast {
 namespace detail {
@@ -39,6 +41,8 @@ static const int FITSLEN = 80;
 /// A wrapper around astAnnul; intended as a custom deleter for std::unique_ptr
 inline void annulAstObject(AstObject *object) {
     if (object != nullptr) {
+        censusRemove(object);
+        noteObjectAnnul(object);
         astAnnul(object);
         assertOK();
     }
@@ -53,22 +57,54 @@ inline void assertEqual(T1 val1, std::string const &descr1, T2 val2, std::string
     }
 }
 
+/**
+Replace `AST__BAD` with a quiet NaN in a contiguous block of values
+
+The loop has no data-dependent branches, so the compiler can vectorize it.
+
+@param[in,out] data  Values to convert
+@param[in] size  Number of values
+*/
+void astBadToNan(double *data, std::size_t size);
+
+/**
+Copy a contiguous block of values, replacing NaN with `AST__BAD`
+
+@param[in] from  Values to copy
+@param[in] size  Number of values
+@param[out] to  Destination for the converted values; must not overlap `from`
+*/
+void nanToAstBad(double const *from, std::size_t size, double *to);
+
 /**
 Replace `AST__BAD` with a quiet NaN in a vector
 */
-inline void astBadToNan(std::vector<double> &p) {
-    for (auto &val : p) {
-        if (val == AST__BAD) {
-            val = std::numeric_limits<double>::quiet_NaN();
-        }
-    }
-}
+inline void astBadToNan(std::vector<double> &p) { astBadToNan(p.data(), p.size()); }
 
 /**
 Replace `AST__BAD` with a quiet NaN in a 2-D array
 */
 void astBadToNan(ast::Array2D const &arr);
 
+/**
+Get the maximum number of points passed to a single AST transform call
+
+AST counts points with an `int`, so Mapping transforms larger arrays in chunks of at most this many points.
+The default is the largest `int`.
+*/
+std::size_t getMaxTranChunk();
+
+/**
+Set the maximum number of points passed to a single AST transform call
+
+This exists so that the chunking can be tested with small arrays; there is no other reason to change it.
+
+@param[in] maxChunk  Maximum number of points per chunk; 0 restores the default.
+
+@throws std::invalid_argument if `maxChunk` is larger than the largest `int`.
+*/
+void setMaxTranChunk(std::size_t maxChunk);
+
 /**
 Format an axis-specific attribute by appending the axis index
 
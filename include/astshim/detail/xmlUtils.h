@@ -0,0 +1,151 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_DETAIL_XMLUTILS_H
+#define ASTSHIM_DETAIL_XMLUTILS_H
+
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace ast {
+namespace detail {
+
+/// The XML namespace of AST objects written by XmlChan
+extern char const *const AST_XML_NAMESPACE;
+
+/**
+Split XML text into the text of the AST objects it contains, incrementally
+
+Text is added a piece at a time, e.g. one line at a time as read from a Stream. As soon as the element
+of an AST object is complete (from the start of its start tag to the end of its end tag) its text
+is available from @ref pop. The elements of AST objects are those in the AST namespace
+(@ref AST_XML_NAMESPACE) and, if no namespace applies, those whose name is that of an AST class.
+Only the outermost such elements are split out; objects nested in them are their components.
+Namespace declarations that an object inherits from enclosing elements are added to its start tag,
+so that the text can be decoded on its own.
+
+Other top-level elements are also returned, once complete, since an XmlChan may be able to read
+objects from them (e.g. IVOA descriptions); the text of AST objects nested in them is removed,
+and such an element is not returned at all if it contained nothing but AST objects.
+Text outside top-level elements (whitespace, comments, processing instructions and declarations)
+is discarded.
+
+This is a tokenizer, not a parser: it recognizes tags, quoted attribute values, comments,
+CDATA sections, processing instructions and declarations, but does not check that end tags
+match start tags; the parser that later reads each piece of text does that.
+*/
+class XmlSplitter {
+public:
+    XmlSplitter()
+            : _state(State::TEXT),
+              _quote('\0'),
+              _markup(),
+              _scopes(),
+              _objectDepth(0),
+              _object(),
+              _element(),
+              _elementHasObject(false),
+              _elementHasOther(false),
+              _segments() {}
+
+    /**
+    Add text
+
+    @param[in] text  Text to add; may contain any number of elements or parts of elements
+    @param[in] size  Number of characters of text
+    */
+    void add(char const *text, std::size_t size);
+
+    /// Add text
+    void add(std::string const &text) { add(text.data(), text.size()); }
+
+    /// Return true if there is any complete text to pop
+    bool hasSegment() const { return !_segments.empty(); }
+
+    /**
+    Remove and return the oldest complete text: that of an AST object or of another top-level element
+
+    @throws std::out_of_range if there is no complete text
+    */
+    std::string pop();
+
+    /// Return true if an element has been started but not completed
+    bool isInElement() const { return !_scopes.empty() || !_markup.empty(); }
+
+    /**
+    Remove and return the text of an incomplete element, e.g. at the end of a truncated document
+
+    This is the incomplete AST object, if there is one, else the incomplete top-level element.
+    */
+    std::string popIncomplete();
+
+private:
+    enum class State {
+        TEXT,     // outside markup
+        TAG,      // in a tag or a construct whose type is not yet known, starting with "<"
+        COMMENT,  // in <!-- ... -->
+        CDATA,    // in <![CDATA[ ... ]]>
+        PI,       // in <? ... ?>
+    };
+
+    // A namespace declaration: xmlns="uri" (with an empty prefix) or xmlns:prefix="uri"
+    struct NamespaceDecl {
+        std::string prefix;
+        std::string uri;  // as written, without quotes
+        char quote;       // quote character used for uri
+    };
+
+    // Handle the end of the markup in _markup
+    void _endMarkup();
+
+    // Handle the start tag in _markup
+    void _startTag(bool isEmptyElement);
+
+    // Is the element with this qualified name and these namespace declarations an AST object?
+    bool _isAstObject(std::string const &name, std::vector<NamespaceDecl> const &decls) const;
+
+    // Add the namespace declarations inherited from open elements, but not overridden by `decls`,
+    // to the start tag in `tag`
+    void _addInheritedDecls(std::vector<NamespaceDecl> const &decls, std::string &tag) const;
+
+    // Append text to the current AST object or top-level element, if any
+    void _append(std::string const &text);
+
+    // Does _markup end with `suffix`?
+    bool _markupEndsWith(char const *suffix, std::size_t size) const;
+
+    State _state;
+    char _quote;                                  // quote character if in a quoted attribute value, else '\0'
+    std::string _markup;                          // text of the current markup (tag, comment...)
+    std::vector<std::vector<NamespaceDecl>> _scopes;  // declarations of each open element, outermost first
+    std::size_t _objectDepth;                     // nesting level of the current AST object, or 0 if none
+    std::string _object;                          // text of the current AST object
+    std::string _element;                         // text of the current top-level element, less AST objects
+    bool _elementHasObject;                       // did the current top-level element contain AST objects?
+    bool _elementHasOther;                        // ... or any other elements?
+    std::deque<std::string> _segments;            // complete text of AST objects and top-level elements
+};
+
+}  // namespace detail
+}  // namespace ast
+
+#endif
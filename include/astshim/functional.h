@@ -23,10 +23,13 @@
 #define ASTSHIM_FUNCTIONAL_H
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "astshim/FrameSet.h"
+#include "astshim/LutMap.h"
 #include "astshim/Mapping.h"
+#include "astshim/PolyMap.h"
 
 /*
  * This header declares operations that treat ast objects (particularly Mapping
@@ -82,6 +85,71 @@ std::shared_ptr<FrameSet> append(FrameSet const& first, FrameSet const& second);
  */
 std::shared_ptr<Mapping> makeRadialMapping(std::vector<double> const& center, Mapping const& mapping1d);
 
+/**
+ * Construct a radially symmetric polynomial distortion as a single PolyMap
+ *
+ * The forward transform moves each point radially about `center`, from radius r to radius
+ *
+ *     r' = coeffs[1] r + coeffs[3] r^3 + coeffs[5] r^5 + ...
+ *
+ * This is the same transform as @ref makeRadialMapping with a 1-dimensional polynomial `mapping1d`,
+ * but because only odd powers of r are allowed it can be expanded into a polynomial in the
+ * input coordinates, so it is evaluated by AST in one pass, with no normalisation or compound mappings.
+ * Like any PolyMap it can be persisted using a Channel and given an inverse by iteration
+ * (the default) or by fitting with PolyMap.polyTran.
+ *
+ * @param[in] center  Center of radial symmetry
+ * @param[in] coeffs  Coefficients of the radial polynomial: coeffs[i] is the coefficient of r^i.
+ *                  Elements with even index (including 0) must be 0.
+ * @param[in] options  Comma-separated list of attribute assignments for the PolyMap
+ * @returns a PolyMap that is radially symmetric about the center and has nIn = nOut = center.size()
+ *
+ * @throws std::invalid_argument if center is empty or any even-index coefficient is nonzero
+ */
+std::shared_ptr<PolyMap> makeRadialPolyMap(std::vector<double> const& center,
+                                           std::vector<double> const& coeffs,
+                                           std::string const& options = "IterInverse=1");
+
+/**
+ * A lookup table that approximates a 1-dimensional mapping, as returned by @ref tabulate1D
+ */
+struct Tabulation1D {
+    std::shared_ptr<LutMap> lutMap;  ///< the lookup table
+    double start;                    ///< input value of the first table entry
+    double inc;                      ///< spacing of the table entries
+    int nEntries;                    ///< number of table entries
+    double maxError;                 ///< maximum absolute error of `lutMap` found by verification
+    int nIterations;                 ///< number of table spacings tried
+};
+
+/**
+ * Tabulate a smooth 1-dimensional mapping into a LutMap, with a specified accuracy
+ *
+ * Use this to replace a costly but smooth mapping (e.g. a MathMap, a TimeMap chain or the
+ * `mapping1d` of @ref makeRadialMapping) that will be evaluated many times over a known range.
+ *
+ * The table spacing is chosen adaptively: starting with a coarse table, the error of the LutMap is measured
+ * at three points within each interval between table entries (one quarter, one half and three quarters
+ * of the way across) and, if the largest error exceeds `tol`, a finer spacing is estimated
+ * (the error of linear interpolation scales as the square of the spacing) and the process repeats.
+ *
+ * The LutMap extrapolates linearly outside [lo, hi], so its accuracy is only known within that range.
+ * It has an inverse if its entries are monotonic.
+ *
+ * @param[in] mapping  Mapping to tabulate; must have one input and one output and a forward transform
+ * @param[in] lo  Lower end of the input range
+ * @param[in] hi  Upper end of the input range
+ * @param[in] tol  Maximum absolute error of the output
+ * @param[in] maxEntries  Maximum number of table entries
+ * @returns the table, with the error it achieves
+ *
+ * @throws std::invalid_argument if mapping has nIn or nOut != 1, if lo >= hi,
+ *     if tol <= 0 or if maxEntries < 2
+ * @throws std::runtime_error if the mapping gives an invalid (NaN) value within [lo, hi],
+ *     or if `tol` cannot be reached with `maxEntries` entries.
+ */
+Tabulation1D tabulate1D(Mapping const& mapping, double lo, double hi, double tol, int maxEntries = 1 << 20);
+
 }  // namespace ast
 
 #endif  // ASTSHIM_FUNCTIONAL_H
@@ -0,0 +1,97 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_TRANSFORMFILE_H
+#define ASTSHIM_TRANSFORMFILE_H
+
+#include <cstddef>
+#include <limits>
+#include <string>
+
+#include "astshim/Mapping.h"
+
+namespace ast {
+
+/**
+Layout of the coordinates in a binary column file read or written by @ref transformFile
+*/
+enum class ColumnLayout {
+    INTERLEAVED,  ///< one record per point: x0, y0, x1, y1, ...
+    COLUMNS       ///< one column per axis (structure of arrays): x0, x1, ..., y0, y1, ...
+};
+
+/**
+Options for @ref transformFile
+*/
+struct ColumnSpec {
+    /// Layout of the input and output files
+    ColumnLayout layout = ColumnLayout::INTERLEAVED;
+    /// Apply the forward transform? If false then apply the inverse transform.
+    bool forward = true;
+    /// Number of points transformed at a time by each thread; peak memory use is proportional to this
+    std::size_t blockSize = 65536;
+    /// Number of threads; 0 for one per available core
+    int nThreads = 0;
+    /// Number of blocks ahead of the one being transformed to ask the operating system to read
+    int prefetchBlocks = 2;
+    /// Treat NaN input coordinates as bad? AST only recognizes AST__BAD as bad,
+    /// so otherwise a NaN may propagate in surprising ways or give a finite result.
+    bool nanInputIsBad = true;
+    /// Value written for output coordinates that cannot be computed; use AST__BAD to match AST
+    double badOutput = std::numeric_limits<double>::quiet_NaN();
+};
+
+/**
+Summary of the work done by @ref transformFile
+*/
+struct TransformFileResult {
+    std::size_t nPoints = 0;     ///< number of points transformed
+    std::size_t nBlocks = 0;     ///< number of blocks the points were divided into
+    std::size_t nBadPoints = 0;  ///< number of points with at least one bad output coordinate
+};
+
+/**
+Transform the coordinates in a binary file, writing the results to another binary file
+
+The input file must contain only native-endian 64-bit floats, arranged as specified
+by `spec.layout`, with nIn (or nOut for the inverse transform) coordinates per point.
+The output file is created (or replaced) and has the same layout, with nOut (or nIn) coordinates per point.
+
+Both files are memory-mapped and transformed in blocks of `spec.blockSize` points by a pool of threads,
+each with its own copy of the mapping. Pages are released as soon as each block is finished,
+so peak memory use depends on the block size and number of threads but not on the size of the files.
+
+@param[in] mapping  Mapping to apply
+@param[in] inputPath  Path of input file
+@param[in] outputPath  Path of output file; must differ from `inputPath`
+@param[in] spec  Layout and processing options
+@return a summary of the work done
+
+@throws std::invalid_argument if `spec` is invalid, if the mapping does not have
+    the requested transform, or if the size of the input file is not a whole number of points.
+@throws std::runtime_error if a file cannot be opened, resized or mapped, or if the transform fails.
+*/
+TransformFileResult transformFile(Mapping const &mapping, std::string const &inputPath,
+                                  std::string const &outputPath, ColumnSpec const &spec = ColumnSpec());
+
+}  // namespace ast
+
+#endif
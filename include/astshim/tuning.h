@@ -0,0 +1,157 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#ifndef ASTSHIM_TUNING_H
+#define ASTSHIM_TUNING_H
+
+#include <string>
+
+#include "astshim/base.h"
+
+namespace ast {
+
+/**
+Integer-valued global AST tuning parameters, as used by @ref tune
+*/
+enum class TuneParam {
+    /**
+    Controls whether memory used by deleted AST objects is cached for re-use by new objects
+    of the same class: 0 to disable caching (the default), non-zero to enable it.
+    Enabling this can speed up code that creates and deletes many small objects,
+    at the cost of retaining the memory. Disabling it frees all cached memory.
+    */
+    ObjectCaching,
+    /**
+    Controls whether small blocks of memory freed by AST are cached for re-use by
+    subsequent allocations of the same size: 0 to disable caching (the default), non-zero to enable it.
+    Disabling it frees all cached memory.
+    */
+    MemoryCaching,
+};
+
+/**
+String-valued global AST tuning parameters, as used by @ref tune
+
+These specify the characters used to delete the previous character
+when formatting text with graphical escape sequences; see @ref escapes.
+*/
+enum class TuneStringParam {
+    HRDel,  ///< string used to represent a high-resolution deletion
+    MRDel,  ///< string used to represent a medium-resolution deletion
+    LRDel,  ///< string used to represent a low-resolution deletion
+};
+
+/**
+Get the value of an integer-valued global AST tuning parameter
+
+@param[in] param  Parameter to get
+*/
+int tune(TuneParam param);
+
+/**
+Set an integer-valued global AST tuning parameter
+
+@param[in] param  Parameter to set
+@param[in] value  New value
+@return the previous value
+
+@note Tuning parameters are global: they affect all AST objects in the process.
+Prefer @ref ScopedTune to restore the previous value automatically.
+*/
+int tune(TuneParam param, int value);
+
+/**
+Get the value of a string-valued global AST tuning parameter
+
+@param[in] param  Parameter to get
+*/
+std::string tune(TuneStringParam param);
+
+/**
+Set a string-valued global AST tuning parameter
+
+@param[in] param  Parameter to set
+@param[in] value  New value
+@return the previous value
+*/
+std::string tune(TuneStringParam param, std::string const &value);
+
+/// Return the AST name of a tuning parameter, e.g. "ObjectCaching"
+std::string getTuneName(TuneParam param);
+
+/// Return the AST name of a tuning parameter, e.g. "HRDel"
+std::string getTuneName(TuneStringParam param);
+
+/**
+Temporarily override a global AST tuning parameter
+
+The parameter is set when the ScopedTune is constructed and restored to its previous value
+when the ScopedTune is destroyed (or @ref restore is called), for example:
+
+    {
+        ast::ScopedTune caching(ast::TuneParam::ObjectCaching, 1);
+        // ... create and delete many small objects ...
+    }  // ObjectCaching restored here
+*/
+class ScopedTune {
+public:
+    /**
+    Override an integer-valued tuning parameter
+
+    @param[in] param  Parameter to set
+    @param[in] value  New value
+    */
+    explicit ScopedTune(TuneParam param, int value);
+
+    /**
+    Override a string-valued tuning parameter
+
+    @param[in] param  Parameter to set
+    @param[in] value  New value
+    */
+    explicit ScopedTune(TuneStringParam param, std::string const &value);
+
+    ~ScopedTune();
+
+    ScopedTune(ScopedTune const &) = delete;
+    ScopedTune(ScopedTune &&) = delete;
+    ScopedTune &operator=(ScopedTune const &) = delete;
+    ScopedTune &operator=(ScopedTune &&) = delete;
+
+    /**
+    Restore the previous value now, instead of when this is destroyed
+
+    Calling this more than once has no further effect.
+    */
+    void restore();
+
+private:
+    bool _isString;
+    bool _restored;
+    TuneParam _param;
+    TuneStringParam _stringParam;
+    int _oldValue;
+    std::string _oldStringValue;
+};
+
+}  // namespace ast
+
+#endif
@@ -23,48 +23,35 @@
 """lsst.astshim
 """
 from __future__ import absolute_import
-from .base import *
-from .object import *
-from .stream import *
-from .channel import *
-from .mapping import *
-from .frame import *
-from .frameSet import *
-from .frameDict import *
+import sys
+import types
+
+# all bindings live in a single extension module (fast to import);
+# the keyMap package adds pure-Python extensions to KeyMap
+from . import _astshimLib
+from ._astshimLib import *
 from .keyMap import *
-# misc
-from .mapBox import *
-from .mapSplit import *
-from .quadApprox import *
-from .functional import *
-# channels
-from .fitsChan import *
-from .xmlChan import *
-# mappings
-from .chebyMap import *
-from .cmpMap import *
-from .lutMap import *
-from .mathMap import *
-from .matrixMap import *
-from .normMap import *
-from .parallelMap import *
-from .seriesMap import *
-from .pcdMap import *
-from .permMap import *
-from .polyMap import *
-from .rateMap import *
-from .shiftMap import *
-from .slaMap import *
-from .sphMap import *
-from .timeMap import *
-from .tranMap import *
-from .unitMap import *
-from .unitNormMap import *
-from .wcsMap import *
-from .winMap import *
-from .zoomMap import *
-# frames
-from .cmpFrame import *
-from .skyFrame import *
-from .specFrame import *
-from .timeFrame import *
+from .asyncTransforms import *
+
+
+def _addSubmoduleAliases():
+    """Make the bindings of each C++ wrapper file available as submodule astshim.<name>
+
+    Each wrapper used to be a separate extension module, so code and pickles may refer to
+    paths such as astshim.mapping.Mapping or astshim.object.ObjectMaker.
+    The classes already have those paths as their __module__.
+    """
+    for name, attrNames in _astshimLib._submodules.items():
+        fullName = __name__ + "." + name
+        module = types.ModuleType(fullName)
+        for attrName in attrNames:
+            setattr(module, attrName, getattr(_astshimLib, attrName))
+        sys.modules[fullName] = module
+        # as before, a function or class of the same name (e.g. astshim.census) takes precedence
+        parentName, _, childName = fullName.rpartition(".")
+        parent = sys.modules[parentName]
+        if not hasattr(parent, childName):
+            setattr(parent, childName, module)
+
+
+_addSubmoduleAliases()
@@ -0,0 +1,213 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <set>
+#include <string>
+
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+
+namespace ast {
+
+void wrapBase(py::module &mod);
+void wrapObject(py::module &mod);
+void wrapStream(py::module &mod);
+void wrapChannel(py::module &mod);
+void wrapThreadPool(py::module &mod);
+void wrapMapBox(py::module &mod);
+void wrapMapSplit(py::module &mod);
+void wrapFactorizedMapping(py::module &mod);
+void wrapMapping(py::module &mod);
+void wrapFrame(py::module &mod);
+void wrapFrameSet(py::module &mod);
+void wrapFrameDict(py::module &mod);
+void wrapMappingRegistry(py::module &mod);
+void wrapFrameSetRouter(py::module &mod);
+void wrapKeyMap(py::module &mod);
+void wrapQuadApprox(py::module &mod);
+void wrapFunctional(py::module &mod);
+void wrapInstrumentation(py::module &mod);
+void wrapCensus(py::module &mod);
+void wrapTuning(py::module &mod);
+void wrapTransformFile(py::module &mod);
+void wrapBatchApply(py::module &mod);
+void wrapFitCache(py::module &mod);
+void wrapFitsChan(py::module &mod);
+void wrapXmlChan(py::module &mod);
+void wrapChebyMap(py::module &mod);
+void wrapCmpMap(py::module &mod);
+void wrapLutMap(py::module &mod);
+void wrapMathMap(py::module &mod);
+void wrapMatrixMap(py::module &mod);
+void wrapNormMap(py::module &mod);
+void wrapParallelMap(py::module &mod);
+void wrapSeriesMap(py::module &mod);
+void wrapPcdMap(py::module &mod);
+void wrapPermMap(py::module &mod);
+void wrapPolyMap(py::module &mod);
+void wrapRateMap(py::module &mod);
+void wrapShiftMap(py::module &mod);
+void wrapSlaMap(py::module &mod);
+void wrapSphMap(py::module &mod);
+void wrapTimeMap(py::module &mod);
+void wrapTranMap(py::module &mod);
+void wrapUnitMap(py::module &mod);
+void wrapUnitNormMap(py::module &mod);
+void wrapWcsMap(py::module &mod);
+void wrapWinMap(py::module &mod);
+void wrapZoomMap(py::module &mod);
+void wrapCmpFrame(py::module &mod);
+void wrapSkyFrame(py::module &mod);
+void wrapSpecFrame(py::module &mod);
+void wrapTimeFrame(py::module &mod);
+
+namespace {
+
+/*
+Set the __module__ of `type`, and of any classes nested in it, to `moduleName`
+
+Nested classes are those class attributes that are types whose __module__ is still `oldModuleName`.
+*/
+void setTypeModule(py::handle type, py::str const &moduleName, py::object const &oldModuleName) {
+    type.attr("__module__") = moduleName;
+    for (auto item : py::dict(type.attr("__dict__"))) {
+        if (py::isinstance<py::type>(item.second) && item.second.attr("__module__").equal(oldModuleName)) {
+            setTypeModule(item.second, moduleName, oldModuleName);
+        }
+    }
+}
+
+/*
+Call `wrap` and attribute everything it adds to `mod` to submodule `name` of the astshim package
+
+Each wrap function used to build its own extension module (e.g. astshim.mapping),
+and code and pickles may still refer to those paths. So set the __module__ of the new classes
+to the old module and record the new names in `mod._submodules`, from which astshim/__init__.py
+makes an alias module for each.
+*/
+void wrapSubmodule(py::module &mod, std::string const &name, void (*wrap)(py::module &)) {
+    py::dict dict = mod.attr("__dict__");
+    std::set<std::string> oldNames;
+    for (auto item : dict) {
+        oldNames.insert(py::str(item.first));
+    }
+    wrap(mod);
+
+    std::string const modName = py::str(mod.attr("__name__"));
+    py::str const moduleName(modName.substr(0, modName.rfind('.') + 1) + name);
+    py::list names;
+    for (auto item : dict) {
+        if (oldNames.count(py::str(item.first)) > 0) {
+            continue;
+        }
+        names.append(item.first);
+        if (py::isinstance<py::type>(item.second)) {
+            setTypeModule(item.second, moduleName, mod.attr("__name__"));
+        }
+    }
+    mod.attr("_submodules")[py::str(name)] = names;
+}
+
+}  // namespace
+
+namespace detail {
+
+void wrapTestUtils(py::module &mod);
+
+}  // namespace detail
+
+/*
+All bindings are in this one extension module, which loads much faster than one module per class.
+
+Classes must be wrapped after their base classes, so the order of these calls matters.
+The names each wrap function adds are also made available as submodule astshim.<name>;
+see wrapSubmodule.
+*/
+PYBIND11_MODULE(_astshimLib, mod) {
+    mod.attr("_submodules") = py::dict();
+
+    wrapSubmodule(mod, "base", wrapBase);
+    wrapSubmodule(mod, "object", wrapObject);
+    wrapSubmodule(mod, "stream", wrapStream);
+    wrapSubmodule(mod, "channel", wrapChannel);
+    wrapSubmodule(mod, "threadPool", wrapThreadPool);
+    wrapSubmodule(mod, "mapBox", wrapMapBox);
+    wrapSubmodule(mod, "mapSplit", wrapMapSplit);
+    wrapSubmodule(mod, "mapping", wrapMapping);
+    wrapSubmodule(mod, "factorizedMapping", wrapFactorizedMapping);
+    wrapSubmodule(mod, "frame", wrapFrame);
+    wrapSubmodule(mod, "frameSet", wrapFrameSet);
+    wrapSubmodule(mod, "frameDict", wrapFrameDict);
+    wrapSubmodule(mod, "mappingRegistry", wrapMappingRegistry);
+    wrapSubmodule(mod, "frameSetRouter", wrapFrameSetRouter);
+    wrapSubmodule(mod, "keyMap.keyMap", wrapKeyMap);
+
+    // misc
+    wrapSubmodule(mod, "quadApprox", wrapQuadApprox);
+    wrapSubmodule(mod, "functional", wrapFunctional);
+    wrapSubmodule(mod, "instrumentation", wrapInstrumentation);
+    wrapSubmodule(mod, "census", wrapCensus);
+    wrapSubmodule(mod, "tuning", wrapTuning);
+    wrapSubmodule(mod, "transformFile", wrapTransformFile);
+    wrapSubmodule(mod, "batchApply", wrapBatchApply);
+    wrapSubmodule(mod, "fitCache", wrapFitCache);
+
+    // channels
+    wrapSubmodule(mod, "fitsChan", wrapFitsChan);
+    wrapSubmodule(mod, "xmlChan", wrapXmlChan);
+
+    // mappings
+    wrapSubmodule(mod, "chebyMap", wrapChebyMap);
+    wrapSubmodule(mod, "cmpMap", wrapCmpMap);
+    wrapSubmodule(mod, "lutMap", wrapLutMap);
+    wrapSubmodule(mod, "mathMap", wrapMathMap);
+    wrapSubmodule(mod, "matrixMap", wrapMatrixMap);
+    wrapSubmodule(mod, "normMap", wrapNormMap);
+    wrapSubmodule(mod, "parallelMap", wrapParallelMap);
+    wrapSubmodule(mod, "seriesMap", wrapSeriesMap);
+    wrapSubmodule(mod, "pcdMap", wrapPcdMap);
+    wrapSubmodule(mod, "permMap", wrapPermMap);
+    wrapSubmodule(mod, "polyMap", wrapPolyMap);
+    wrapSubmodule(mod, "rateMap", wrapRateMap);
+    wrapSubmodule(mod, "shiftMap", wrapShiftMap);
+    wrapSubmodule(mod, "slaMap", wrapSlaMap);
+    wrapSubmodule(mod, "sphMap", wrapSphMap);
+    wrapSubmodule(mod, "timeMap", wrapTimeMap);
+    wrapSubmodule(mod, "tranMap", wrapTranMap);
+    wrapSubmodule(mod, "unitMap", wrapUnitMap);
+    wrapSubmodule(mod, "unitNormMap", wrapUnitNormMap);
+    wrapSubmodule(mod, "wcsMap", wrapWcsMap);
+    wrapSubmodule(mod, "winMap", wrapWinMap);
+    wrapSubmodule(mod, "zoomMap", wrapZoomMap);
+
+    // frames
+    wrapSubmodule(mod, "cmpFrame", wrapCmpFrame);
+    wrapSubmodule(mod, "skyFrame", wrapSkyFrame);
+    wrapSubmodule(mod, "specFrame", wrapSpecFrame);
+    wrapSubmodule(mod, "timeFrame", wrapTimeFrame);
+
+    // test utilities, used by astshim.detail
+    auto detailMod = mod.def_submodule("detail");
+    detail::wrapTestUtils(detailMod);
+}
+
+}  // namespace ast
@@ -0,0 +1,98 @@
+"""asyncio-friendly wrappers for the asynchronous transforms of Mapping
+
+Each function starts a transform on an astshim thread pool and returns an
+`asyncio.Future` that is completed on the event loop when the transform finishes,
+so it can be awaited without blocking the loop::
+
+    result = await astshim.awaitApplyForward(mapping, points)
+
+Pass a `CancellationToken` and call its ``cancel`` method to stop a transform;
+the future then raises `OperationCancelled`. Cancelling the future itself also
+cancels the transform.
+"""
+from __future__ import absolute_import, division, print_function
+
+from ._astshimLib import CancellationToken
+
+__all__ = ["awaitApplyForward", "awaitApplyInverse", "awaitTranGridForward"]
+
+
+def _startAsync(start, token, loop):
+    """Start an asynchronous transform and return an asyncio.Future for its result
+
+    Parameters
+    ----------
+    start : callable
+        Function that starts the transform when called as
+        ``start(callback, token)``.
+    token : `CancellationToken` or `None`
+        Token used to cancel the transform; if `None` then a new token is made.
+    loop : `asyncio.AbstractEventLoop` or `None`
+        Event loop of the returned future; if `None` then use the current event loop.
+    """
+    import asyncio  # not available in Python 2, which cannot use this module
+    if loop is None:
+        loop = asyncio.get_event_loop()
+    if token is None:
+        token = CancellationToken()
+    future = loop.create_future()
+
+    def setResult(result, error):
+        if future.cancelled():
+            return
+        if error is not None:
+            future.set_exception(error)
+        else:
+            future.set_result(result)
+
+    def callback(result, error):
+        # called on a worker thread
+        loop.call_soon_threadsafe(setResult, result, error)
+
+    def cancelTransform(fut):
+        if fut.cancelled():
+            token.cancel()
+
+    future.add_done_callback(cancelTransform)
+    start(callback, token)
+    return future
+
+
+def awaitApplyForward(mapping, from_, token=None, pool=None, loop=None):
+    """Start `Mapping.applyForward` on a thread pool and return an asyncio.Future for the result
+
+    Parameters
+    ----------
+    mapping : `Mapping`
+        Mapping to apply; it is copied, so later changes do not affect the transform.
+    from_ : `numpy.ndarray`
+        Input points, with dimensions (nIn, nPoints).
+    token : `CancellationToken`, optional
+        Token that may be used to cancel the transform.
+    pool : `ThreadPool`, optional
+        Thread pool to use; if `None` then use `getDefaultThreadPool`.
+    loop : `asyncio.AbstractEventLoop`, optional
+        Event loop of the returned future; if `None` then use the current event loop.
+    """
+    return _startAsync(
+        lambda callback, tok: mapping.applyForwardAsync(from_, callback, tok, pool), token, loop)
+
+
+def awaitApplyInverse(mapping, from_, token=None, pool=None, loop=None):
+    """Start `Mapping.applyInverse` on a thread pool and return an asyncio.Future for the result
+
+    See `awaitApplyForward` for the parameters, swapping nIn and nOut.
+    """
+    return _startAsync(
+        lambda callback, tok: mapping.applyInverseAsync(from_, callback, tok, pool), token, loop)
+
+
+def awaitTranGridForward(mapping, lbnd, ubnd, tol, maxpix, nPoints, token=None, pool=None, loop=None):
+    """Start `Mapping.tranGridForward` on a thread pool and return an asyncio.Future for the result
+
+    See `Mapping.tranGridForward` for the grid parameters and `awaitApplyForward` for the others.
+    """
+    return _startAsync(
+        lambda callback, tok: mapping.tranGridForwardAsync(lbnd, ubnd, tol, maxpix, nPoints, callback,
+                                                           tok, pool),
+        token, loop)
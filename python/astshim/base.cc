@@ -29,9 +29,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
 
-PYBIND11_MODULE(base, mod) {
+void wrapBase(py::module &mod) {
     mod.def("assertOK", &assertOK, "rawObj1"_a = nullptr, "rawObj2"_a = nullptr);
     mod.def("escapes", &escapes, "include"_a = -1);
 
@@ -57,5 +56,4 @@ PYBIND11_MODULE(base, mod) {
             .export_values();
 }
 
-}  // namespace
 }  // namespace ast
@@ -0,0 +1,65 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include "ndarray/pybind11.h"
+
+#include "astshim/base.h"
+#include "astshim/batchApply.h"
+#include "astshim/Mapping.h"
+#include "astshim/ThreadPool.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace ast {
+
+void wrapBatchApply(py::module &mod) {
+    mod.def("batchApply",
+            [](std::vector<std::pair<std::shared_ptr<Mapping>, ConstArray2D>> const &jobs, bool forward,
+               std::shared_ptr<ThreadPool> const &pool) {
+                // build the jobs with the GIL held, since the arrays may refer to numpy arrays,
+                // and destroy them only after the GIL is reacquired
+                std::vector<BatchJob> batchJobs;
+                batchJobs.reserve(jobs.size());
+                for (auto const &job : jobs) {
+                    if (!job.first) {
+                        throw std::invalid_argument("mapping must not be None");
+                    }
+                    batchJobs.emplace_back(*job.first, job.second);
+                }
+                std::vector<Array2D> results;
+                {
+                    py::gil_scoped_release release;
+                    results = batchApply(batchJobs, forward, pool);
+                }
+                return results;
+            },
+            "jobs"_a, "forward"_a = true, "pool"_a = py::none());
+}
+
+}  // namespace ast
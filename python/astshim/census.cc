@@ -0,0 +1,58 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <memory>
+#include <vector>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "astshim/Census.h"
+#include "astshim/Object.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace ast {
+
+void wrapCensus(py::module &mod) {
+    py::class_<CensusEntry> cls(mod, "CensusEntry");
+
+    cls.def_readonly("className", &CensusEntry::className);
+    cls.def_readonly("site", &CensusEntry::site);
+    cls.def_readonly("count", &CensusEntry::count);
+    cls.def_readonly("bytes", &CensusEntry::bytes);
+    cls.def("__repr__", [](CensusEntry const &self) {
+        return "CensusEntry(className=" + self.className + ", count=" + std::to_string(self.count) +
+               ", bytes=" + std::to_string(self.bytes) + ")";
+    });
+
+    mod.def("census", &census, "enable"_a = -1);
+    mod.def("getCensus", &getCensus, "remeasure"_a = false);
+    mod.def("getCensusBytes", &getCensusBytes);
+    mod.def("getCensusHighWaterMark", &getCensusHighWaterMark);
+    mod.def("resetCensusHighWaterMark", &resetCensusHighWaterMark);
+    mod.def("deepSize", [](std::vector<std::shared_ptr<Object>> const &objects) {
+        return deepSize(std::vector<std::shared_ptr<Object const>>(objects.begin(), objects.end()));
+    }, "objects"_a);
+}
+
+}  // namespace ast
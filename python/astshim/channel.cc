@@ -22,21 +22,20 @@
 #include <memory>
 
 #include <pybind11/pybind11.h>
-//#include <pybind11/stl.h>
+#include <pybind11/stl.h>
 
 #include "astshim/Channel.h"
+#include "astshim/ChannelReader.h"
 #include "astshim/KeyMap.h"
 #include "astshim/Object.h"
+#include "astshim/ThreadPool.h"
 
 namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(channel, mod) {
-    py::module::import("astshim.object");
 
+void wrapChannel(py::module &mod) {
     py::class_<Channel, std::shared_ptr<Channel>, Object> cls(mod, "Channel");
 
     cls.def(py::init<Stream &, std::string const &>(), "stream"_a, "options"_a = "");
@@ -50,9 +49,38 @@ PYBIND11_MODULE(channel, mod) {
 
     cls.def("copy", &Channel::copy);
     cls.def("read", &Channel::read);
+    cls.def("readAll", &Channel::readAll, "pool"_a = py::none(), "maxLookahead"_a = 0,
+            py::call_guard<py::gil_scoped_release>());
     cls.def("write", &Channel::write, "object"_a);
     cls.def("warnings", &Channel::warnings);
+
+    py::class_<ChannelReader, std::shared_ptr<ChannelReader>> clsReader(mod, "ChannelReader");
+
+    clsReader.def_readonly_static("DEFAULT_LOOKAHEAD_PER_THREAD",
+                                  &ChannelReader::DEFAULT_LOOKAHEAD_PER_THREAD);
+
+    // keep the channel alive while the reader is
+    clsReader.def(py::init<Channel &, std::shared_ptr<ThreadPool> const &, std::size_t>(), "channel"_a,
+                  "pool"_a = py::none(), "maxLookahead"_a = 0, py::keep_alive<1, 2>());
+
+    clsReader.def_property_readonly("maxLookahead", &ChannelReader::getMaxLookahead);
+    clsReader.def_property_readonly("nRead", &ChannelReader::getNRead);
+
+    // iterate using the Python protocol, which raises StopIteration instead of returning None
+    auto next = [](ChannelReader &self) {
+        std::shared_ptr<Object> object;
+        {
+            py::gil_scoped_release release;
+            object = self.next();
+        }
+        if (!object) {
+            throw py::stop_iteration();
+        }
+        return object;
+    };
+    clsReader.def("__iter__", [](py::object self) { return self; });
+    clsReader.def("__next__", next);
+    clsReader.def("next", next);
 }
 
-}  // namespace
 }  // namespace ast
@@ -43,9 +43,9 @@ void declareChebyDomain(py::module const &mod) {
     cls.def_readonly("ubnd", &ChebyDomain::ubnd);
 }
 
-PYBIND11_MODULE(chebyMap, mod) {
-    py::module::import("astshim.mapping");
+}  // namespace
 
+void wrapChebyMap(py::module &mod) {
     declareChebyDomain(mod);
 
     py::class_<ChebyMap, std::shared_ptr<ChebyMap>, Mapping> cls(mod, "ChebyMap");
@@ -69,5 +69,4 @@ PYBIND11_MODULE(chebyMap, mod) {
             "forward"_a, "acc"_a, "maxacc"_a, "maxorder"_a);
 }
 
-}  // namespace
 }  // namespace ast
@@ -31,11 +31,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(cmpFrame, mod) {
-    py::module::import("astshim.frame");
 
+void wrapCmpFrame(py::module &mod) {
     py::class_<CmpFrame, std::shared_ptr<CmpFrame>, Frame> cls(mod, "CmpFrame");
 
     cls.def(py::init<Frame const &, Frame const &, std::string const &>(), "frame1"_a, "frame2"_a,
@@ -48,5 +45,4 @@ PYBIND11_MODULE(cmpFrame, mod) {
     cls.def("copy", &CmpFrame::copy);
 }
 
-}  // namespace
 }  // namespace ast
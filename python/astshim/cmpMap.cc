@@ -29,11 +29,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(cmpMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapCmpMap(py::module &mod) {
     py::class_<CmpMap, std::shared_ptr<CmpMap>, Mapping> cls(mod, "CmpMap");
 
     cls.def(py::init<Mapping const &, Mapping const &, bool, std::string const &>(), "map1"_a, "map2"_a,
@@ -47,5 +44,4 @@ PYBIND11_MODULE(cmpMap, mod) {
     cls.def_property_readonly("series", &CmpMap::getSeries);
 }
 
-}  // namespace
 }  // namespace ast
@@ -23,18 +23,19 @@
 #include <pybind11/stl.h>
 
 #include "astshim/detail/testUtils.h"
+#include "astshim/detail/utils.h"
 
 namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
 namespace detail {
-namespace {
 
-PYBIND11_MODULE(testUtils, mod) {
+void wrapTestUtils(py::module &mod) {
     mod.def("makeFrameDict", makeFrameDict);
+    mod.def("getMaxTranChunk", getMaxTranChunk);
+    mod.def("setMaxTranChunk", setMaxTranChunk, "maxChunk"_a);
 }
 
-}  // namespace
 }  // namespace detail
 }  // namespace ast
@@ -0,0 +1,9 @@
+from __future__ import absolute_import
+
+from .. import _astshimLib
+
+__all__ = ["makeFrameDict", "getMaxTranChunk", "setMaxTranChunk"]
+
+makeFrameDict = _astshimLib.detail.makeFrameDict
+getMaxTranChunk = _astshimLib.detail.getMaxTranChunk
+setMaxTranChunk = _astshimLib.detail.setMaxTranChunk
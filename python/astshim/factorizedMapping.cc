@@ -0,0 +1,56 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include "ndarray/pybind11.h"
+
+#include "astshim/FactorizedMapping.h"
+#include "astshim/Mapping.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace ast {
+
+void wrapFactorizedMapping(py::module &mod) {
+    py::class_<FactorizedMapping> cls(mod, "FactorizedMapping");
+
+    cls.def(py::init<Mapping const &>(), "mapping"_a);
+
+    cls.def_property_readonly("nIn", &FactorizedMapping::getNIn);
+    cls.def_property_readonly("nOut", &FactorizedMapping::getNOut);
+    cls.def_property_readonly("nFactors", &FactorizedMapping::getNFactors);
+    cls.def_property_readonly("factors", &FactorizedMapping::getFactors);
+    cls.def_property_readonly("isSeparable", &FactorizedMapping::isSeparable);
+    cls.def_property_readonly("hasForward", &FactorizedMapping::hasForward);
+    cls.def_property_readonly("hasInverse", &FactorizedMapping::hasInverse);
+
+    cls.def("tabulate1DFactors", &FactorizedMapping::tabulate1DFactors, "lbnd"_a, "ubnd"_a, "tol"_a,
+            "maxEntries"_a = 1 << 20);
+
+    cls.def("applyForward",
+            py::overload_cast<ConstArray2D const &>(&FactorizedMapping::applyForward, py::const_), "from"_a);
+    cls.def("applyInverse",
+            py::overload_cast<ConstArray2D const &>(&FactorizedMapping::applyInverse, py::const_), "from"_a);
+}
+
+}  // namespace ast
@@ -0,0 +1,67 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/functional.h>
+
+#include "astshim/FitCache.h"
+#include "astshim/Object.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace ast {
+
+void wrapFitCache(py::module &mod) {
+    py::class_<FitCache, std::shared_ptr<FitCache>> cls(mod, "FitCache");
+
+    cls.def_readonly_static("DEFAULT_MAX_BYTES", &FitCache::DEFAULT_MAX_BYTES);
+
+    cls.def(py::init<std::string const &, std::size_t>(), "directory"_a,
+            "maxBytes"_a = FitCache::DEFAULT_MAX_BYTES);
+
+    cls.def_property_readonly("directory", &FitCache::getDirectory);
+    cls.def_property_readonly("maxBytes", &FitCache::getMaxBytes);
+    cls.def_property_readonly("nHits", &FitCache::getNHits);
+    cls.def_property_readonly("nMisses", &FitCache::getNMisses);
+    cls.def_property_readonly("nWrites", &FitCache::getNWrites);
+    cls.def_property_readonly("nErrors", &FitCache::getNErrors);
+
+    // results are arbitrary bytes, so return them as bytes rather than str
+    cls.def("getOrCompute",
+            [](FitCache &self, std::string const &key, std::function<std::string()> const &compute) {
+                return py::bytes(self.getOrCompute(key, compute));
+            },
+            "key"_a, "compute"_a);
+    cls.def_static("makeKey", &FitCache::makeKey, "operation"_a, "object"_a, "params"_a);
+    cls.def("getBytes", &FitCache::getBytes);
+    cls.def("trim", &FitCache::trim);
+    cls.def("clear", &FitCache::clear);
+
+    mod.def("getDefaultFitCache", &getDefaultFitCache);
+    mod.def("setDefaultFitCache", &setDefaultFitCache, "cache"_a);
+}
+
+}  // namespace ast
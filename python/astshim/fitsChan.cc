@@ -45,9 +45,9 @@ void wrapFoundValue(py::module &mod, std::string const &suffix) {
     cls.def_readwrite("value", &FoundValue<T>::value);
 }
 
-PYBIND11_MODULE(fitsChan, mod) {
-    py::module::import("astshim.channel");
+}  // namespace
 
+void wrapFitsChan(py::module &mod) {
     py::enum_<FitsKeyState>(mod, "FitsKeyState")
             .value("ABSENT", FitsKeyState::ABSENT)
             .value("NOVALUE", FitsKeyState::NOVALUE)
@@ -132,5 +132,4 @@ PYBIND11_MODULE(fitsChan, mod) {
     cls.def("setCard", &FitsChan::setCard, "i"_a);
 }
 
-}  // namespace
 }  // namespace ast
@@ -72,9 +72,9 @@ void wrapFrameMapping(py::module &mod) {
     cls.def_readwrite("mapping", &FrameMapping::mapping);
 }
 
-PYBIND11_MODULE(frame, mod) {
-    py::module::import("astshim.mapping");
+}  // namespace
 
+void wrapFrame(py::module &mod) {
     wrapDirectionPoint(mod);
     wrapNReadValue(mod);
     wrapResolvedPoint(mod);
@@ -147,5 +147,4 @@ PYBIND11_MODULE(frame, mod) {
     cls.def("unformat", &Frame::unformat, "axis"_a, "str"_a);
 }
 
-}  // namespace
 }  // namespace ast
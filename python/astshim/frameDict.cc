@@ -62,9 +62,9 @@ public:
     }
 };
 
-PYBIND11_MODULE(frameDict, mod) {
-    py::module::import("astshim.frameSet");
+}  // namespace
 
+void wrapFrameDict(py::module &mod) {
     py::class_<FrameDictMaker, std::shared_ptr<FrameDictMaker>> makerCls(mod, "FrameDictMaker");
     makerCls.def(py::init<>());
     makerCls.def("__call__", &FrameDictMaker::operator());
@@ -123,5 +123,4 @@ PYBIND11_MODULE(frameDict, mod) {
     });
 }
 
-}  // namespace
 }  // namespace ast
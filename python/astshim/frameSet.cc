@@ -28,11 +28,8 @@ using namespace pybind11::literals;
 #include "astshim/FrameSet.h"
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(frameSet, mod) {
-    py::module::import("astshim.frame");
 
+void wrapFrameSet(py::module &mod) {
     py::class_<FrameSet, std::shared_ptr<FrameSet>, Frame> cls(mod, "FrameSet");
 
     cls.def(py::init<Frame const &, std::string const &>(), "frame"_a, "options"_a = "");
@@ -63,5 +60,4 @@ PYBIND11_MODULE(frameSet, mod) {
     cls.def("renameVariant", &FrameSet::renameVariant, "name"_a);
 }
 
-}  // namespace
 }  // namespace ast
@@ -0,0 +1,82 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <memory>
+#include <string>
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include "ndarray/pybind11.h"
+
+#include "astshim/FrameSet.h"
+#include "astshim/FrameSetRouter.h"
+#include "astshim/Mapping.h"
+#include "astshim/MappingRegistry.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace ast {
+
+void wrapFrameSetRouter(py::module &mod) {
+    py::class_<FrameSetRouter> cls(mod, "FrameSetRouter");
+
+    cls.def(py::init<FrameSet const &, bool, std::shared_ptr<MappingRegistry>>(), "frameSet"_a,
+            "simplify"_a = true, "registry"_a = nullptr);
+
+    cls.def_property_readonly("nFrame", &FrameSetRouter::getNFrame);
+    cls.def_property_readonly("simplify", &FrameSetRouter::getSimplify);
+    cls.def_property_readonly("registry", &FrameSetRouter::getRegistry);
+    cls.def_property_readonly("nMaterialized", &FrameSetRouter::getNMaterialized);
+    cls.def_property_readonly("nHits", &FrameSetRouter::getNHits);
+    cls.def_property_readonly("nMisses", &FrameSetRouter::getNMisses);
+
+    cls.def("getAllDomains", &FrameSetRouter::getAllDomains);
+    cls.def("hasDomain", &FrameSetRouter::hasDomain, "domain"_a);
+    cls.def("getIndex", &FrameSetRouter::getIndex, "domain"_a);
+    // the cached mapping is shared and must not be modified, so return a copy
+    cls.def("getMapping",
+            [](FrameSetRouter const &self, int from, int to) { return self.getMapping(from, to)->copy(); },
+            "from"_a, "to"_a);
+    cls.def("getMapping",
+            [](FrameSetRouter const &self, std::string const &from, std::string const &to) {
+                return self.getMapping(from, to)->copy();
+            },
+            "from"_a, "to"_a);
+    cls.def("isMaterialized", py::overload_cast<int, int>(&FrameSetRouter::isMaterialized, py::const_),
+            "from"_a, "to"_a);
+    cls.def("isMaterialized",
+            py::overload_cast<std::string const &, std::string const &>(&FrameSetRouter::isMaterialized,
+                                                                        py::const_),
+            "from"_a, "to"_a);
+    cls.def("precompute", &FrameSetRouter::precompute, "pairs"_a);
+    cls.def("precomputeAll", &FrameSetRouter::precomputeAll);
+    cls.def("transform",
+            py::overload_cast<int, int, ConstArray2D const &>(&FrameSetRouter::transform, py::const_),
+            "from"_a, "to"_a, "points"_a);
+    cls.def("transform",
+            py::overload_cast<std::string const &, std::string const &, ConstArray2D const &>(
+                    &FrameSetRouter::transform, py::const_),
+            "from"_a, "to"_a, "points"_a);
+    cls.def("clear", &FrameSetRouter::clear);
+}
+
+}  // namespace ast
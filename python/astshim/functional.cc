@@ -29,15 +29,21 @@ using namespace pybind11::literals;
 #include "astshim/functional.h"
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(functional, mod) {
-    py::module::import("astshim.frameSet");
-    py::module::import("astshim.mapping");
 
+void wrapFunctional(py::module &mod) {
     mod.def("append", &append, "first"_a, "second"_a);
     mod.def("makeRadialMapping", &makeRadialMapping, "center"_a, "mapping1d"_a);
+    mod.def("makeRadialPolyMap", &makeRadialPolyMap, "center"_a, "coeffs"_a, "options"_a = "IterInverse=1");
+
+    py::class_<Tabulation1D> clsTabulation(mod, "Tabulation1D");
+    clsTabulation.def_readonly("lutMap", &Tabulation1D::lutMap);
+    clsTabulation.def_readonly("start", &Tabulation1D::start);
+    clsTabulation.def_readonly("inc", &Tabulation1D::inc);
+    clsTabulation.def_readonly("nEntries", &Tabulation1D::nEntries);
+    clsTabulation.def_readonly("maxError", &Tabulation1D::maxError);
+    clsTabulation.def_readonly("nIterations", &Tabulation1D::nIterations);
+
+    mod.def("tabulate1D", &tabulate1D, "mapping"_a, "lo"_a, "hi"_a, "tol"_a, "maxEntries"_a = 1 << 20);
 }
 
-}  // namespace
 }  // namespace ast
@@ -0,0 +1,60 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "astshim/Instrumentation.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace ast {
+
+void wrapInstrumentation(py::module &mod) {
+    py::class_<OpStats> cls(mod, "OpStats");
+
+    cls.def_readonly("operation", &OpStats::operation);
+    cls.def_readonly("className", &OpStats::className);
+    cls.def_readonly("ident", &OpStats::ident);
+    cls.def_readonly("calls", &OpStats::calls);
+    cls.def_readonly("points", &OpStats::points);
+    cls.def_readonly("nanoseconds", &OpStats::nanoseconds);
+    cls.def_readonly("bytes", &OpStats::bytes);
+    cls.def("__repr__", [](OpStats const &self) {
+        return "OpStats(operation=" + self.operation + ", className=" + self.className +
+               ", ident=" + self.ident + ", calls=" + std::to_string(self.calls) +
+               ", points=" + std::to_string(self.points) +
+               ", nanoseconds=" + std::to_string(self.nanoseconds) +
+               ", bytes=" + std::to_string(self.bytes) + ")";
+    });
+
+    mod.def("instrumentation", &instrumentation, "enable"_a = -1);
+    mod.def("getInstrumentationStats", &getInstrumentationStats);
+    mod.def("resetInstrumentationStats", &resetInstrumentationStats);
+
+    mod.def("tracing", &tracing, "enable"_a = -1);
+    mod.def("getTraceJson", &getTraceJson);
+    mod.def("writeTrace", &writeTrace, "path"_a);
+    mod.def("clearTrace", &clearTrace);
+}
+
+}  // namespace ast
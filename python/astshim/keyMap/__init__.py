@@ -21,6 +21,6 @@
 #/
 
 from __future__ import absolute_import
-from .keyMap import *
+from .._astshimLib import KeyMap
 from .keyMapContinued import *
 
@@ -32,11 +32,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(keyMap, mod) {
-    py::module::import("astshim.object");
 
+void wrapKeyMap(py::module &mod) {
     py::class_<KeyMap, std::shared_ptr<KeyMap>, Object> cls(mod, "KeyMap");
 
     cls.def(py::init<std::string const &>(), "options"_a = "");
@@ -138,5 +135,4 @@ PYBIND11_MODULE(keyMap, mod) {
     cls.def("type", &KeyMap::type, "key"_a);
 }
 
-}  // namespace
 }  // namespace ast
@@ -32,11 +32,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(lutMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapLutMap(py::module &mod) {
     py::class_<LutMap, std::shared_ptr<LutMap>, Mapping> cls(mod, "LutMap");
 
     cls.def(py::init<std::vector<double> const &, double, double, std::string const &>(), "lut"_a, "start"_a,
@@ -49,5 +46,4 @@ PYBIND11_MODULE(lutMap, mod) {
     cls.def("copy", &LutMap::copy);
 }
 
-}  // namespace
 }  // namespace ast
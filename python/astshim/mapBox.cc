@@ -30,9 +30,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
 
-PYBIND11_MODULE(mapBox, mod) {
+void wrapMapBox(py::module &mod) {
     py::class_<MapBox> cls(mod, "MapBox");
 
     cls.def(py::init<Mapping const &, std::vector<double> const &, std::vector<double> const &, int, int>(),
@@ -48,5 +47,4 @@ PYBIND11_MODULE(mapBox, mod) {
     cls.def_readonly("xu", &MapBox::xu);
 }
 
-}  // namespace
 }  // namespace ast
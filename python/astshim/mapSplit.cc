@@ -19,6 +19,7 @@
  * the GNU General Public License along with this program.  If not,
  * see <https://www.lsstcorp.org/LegalNotices/>.
  */
+#include <memory>
 #include <vector>
 
 #include <pybind11/pybind11.h>
@@ -31,17 +32,17 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
 
-PYBIND11_MODULE(mapSplit, mod) {
+void wrapMapSplit(py::module &mod) {
     py::class_<MapSplit> cls(mod, "MapSplit");
 
     cls.def(py::init<Mapping const &, std::vector<int> const &>(), "map"_a, "in"_a);
+    cls.def(py::init<std::shared_ptr<Mapping>, std::vector<int> const &, std::vector<int> const &>(),
+            "splitMap"_a, "origIn"_a, "origOut"_a);
 
     cls.def_readonly("splitMap", &MapSplit::splitMap);
     cls.def_readonly("origIn", &MapSplit::origIn);
     cls.def_readonly("origOut", &MapSplit::origOut);
 }
 
-}  // namespace
 }  // namespace ast
@@ -19,15 +19,22 @@
  * the GNU General Public License along with this program.  If not,
  * see <https://www.lsstcorp.org/LegalNotices/>.
  */
+#include <exception>
+#include <memory>
+#include <stdexcept>
+
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include "ndarray/pybind11.h"
 
 #include "astshim/base.h"
 #include "astshim/Mapping.h"
+#include "astshim/MappingCost.h"
 #include "astshim/Object.h"
 #include "astshim/ParallelMap.h"
 #include "astshim/SeriesMap.h"
+#include "astshim/ThreadPool.h"
+#include "astshim/TransformWorkspace.h"
 
 namespace py = pybind11;
 using namespace pybind11::literals;
@@ -35,13 +42,84 @@ using namespace pybind11::literals;
 namespace ast {
 namespace {
 
-PYBIND11_MODULE(mapping, mod) {
-    py::module::import("astshim.object");
-    py::module::import("astshim.mapBox");
-    py::module::import("astshim.mapSplit");
+/**
+Wrap a Python callable `callback(result, error)` as a TransformCallback that may be called from any thread
+
+`result` is the transformed array, or None if the transform failed, and `error` is None or
+the exception (OperationCancelled, ValueError or RuntimeError) raised by the transform.
+*/
+TransformCallback makeTransformCallback(py::object const &pyCallback) {
+    // the callable must only be called or released while holding the GIL
+    std::shared_ptr<py::object> callable(new py::object(pyCallback), [](py::object *obj) {
+        py::gil_scoped_acquire gil;
+        delete obj;
+    });
+    return [callable](Array2D const &result, std::exception_ptr error) {
+        py::gil_scoped_acquire gil;
+        py::object pyResult = py::none();
+        py::object pyError = py::none();
+        if (error) {
+            try {
+                std::rethrow_exception(error);
+            } catch (OperationCancelled const &e) {
+                pyError = py::module::import("astshim._astshimLib").attr("OperationCancelled")(e.what());
+            } catch (std::invalid_argument const &e) {
+                pyError = py::reinterpret_borrow<py::object>(PyExc_ValueError)(e.what());
+            } catch (std::exception const &e) {
+                pyError = py::reinterpret_borrow<py::object>(PyExc_RuntimeError)(e.what());
+            }
+        } else {
+            pyResult = py::cast(result);
+        }
+        try {
+            (*callable)(pyResult, pyError);
+        } catch (py::error_already_set &e) {
+            e.restore();
+            PyErr_WriteUnraisable(callable->ptr());
+        }
+    };
+}
+
+/**
+Copy an array for use by another thread
+
+Arrays converted from numpy hold a reference to the numpy array, which must not be released without the GIL.
+*/
+ConstArray2D copyForThread(ConstArray2D const &arr) {
+    Array2D result = ndarray::allocate(arr.getShape());
+    result.deep() = arr;
+    return result;
+}
+
+}  // namespace
+
+void wrapMapping(py::module &mod) {
+    py::class_<MappingCost> clsMappingCost(mod, "MappingCost");
+    clsMappingCost.def_readonly("className", &MappingCost::className);
+    clsMappingCost.def_readonly("ident", &MappingCost::ident);
+    clsMappingCost.def_readonly("nIn", &MappingCost::nIn);
+    clsMappingCost.def_readonly("nOut", &MappingCost::nOut);
+    clsMappingCost.def_readonly("properties", &MappingCost::properties);
+    clsMappingCost.def_readonly("modelledCost", &MappingCost::modelledCost);
+    clsMappingCost.def_readonly("measuredCost", &MappingCost::measuredCost);
+    clsMappingCost.def_readonly("children", &MappingCost::children);
+    clsMappingCost.def_property_readonly("cost", &MappingCost::getCost);
+    clsMappingCost.def("__str__", &MappingCost::toString);
 
     py::class_<Mapping, std::shared_ptr<Mapping>, Object> cls(mod, "Mapping");
 
+    py::class_<TransformWorkspace> clsWorkspace(mod, "TransformWorkspace");
+    clsWorkspace.def(py::init<Mapping const &, std::size_t>(), "mapping"_a, "nPoints"_a = 0);
+    clsWorkspace.def_property_readonly("nIn", &TransformWorkspace::getNIn);
+    clsWorkspace.def_property_readonly("nOut", &TransformWorkspace::getNOut);
+    clsWorkspace.def_property_readonly("capacity", &TransformWorkspace::getCapacity);
+    clsWorkspace.def_property_readonly("nAllocations", &TransformWorkspace::getNAllocations);
+    clsWorkspace.def_property("nanInputIsBad", &TransformWorkspace::getNanInputIsBad,
+                              &TransformWorkspace::setNanInputIsBad);
+    clsWorkspace.def("reserve", &TransformWorkspace::reserve, "nPoints"_a);
+    clsWorkspace.def("getInput", &TransformWorkspace::getInput, "nPoints"_a, "forward"_a = true);
+    clsWorkspace.def("getOutput", &TransformWorkspace::getOutput, "nPoints"_a, "forward"_a = true);
+
     cls.def_property_readonly("nIn", &Mapping::getNIn);
     cls.def_property_readonly("nOut", &Mapping::getNOut);
     cls.def_property_readonly("isSimple", &Mapping::getIsSimple);
@@ -58,6 +136,9 @@ PYBIND11_MODULE(mapping, mod) {
     cls.def("under", &Mapping::under, "next"_a);
     cls.def("rate", &Mapping::rate, "at"_a, "ax1"_a, "ax2"_a);
     cls.def("simplified", &Mapping::simplified);
+    cls.def("explain", &Mapping::explain, "forward"_a = true, "nPoints"_a = 1000, "lbnd"_a = PointD(),
+            "ubnd"_a = PointD());
+    cls.def("factorize", &Mapping::factorize);
     // wrap the overloads of applyForward, applyInverse, tranGridForward and tranGridInverse that return a new
     // result
     cls.def("applyForward", py::overload_cast<ConstArray2D const &>(&Mapping::applyForward, py::const_),
@@ -68,15 +149,66 @@ PYBIND11_MODULE(mapping, mod) {
             "from"_a);
     cls.def("applyInverse",
             py::overload_cast<std::vector<double> const &>(&Mapping::applyInverse, py::const_), "from"_a);
+    // float32 arrays are transformed without making double copies; pybind11 tries overloads without
+    // converting arguments first, so float64 arrays still use the double overloads above
+    cls.def("applyForward", py::overload_cast<ConstFloatArray2D const &>(&Mapping::applyForward, py::const_),
+            "from"_a);
+    cls.def("applyInverse", py::overload_cast<ConstFloatArray2D const &>(&Mapping::applyInverse, py::const_),
+            "from"_a);
+    cls.def("applyForward",
+            py::overload_cast<ConstArray2D const &, TransformWorkspace &>(&Mapping::applyForward, py::const_),
+            "from"_a, "workspace"_a);
+    cls.def("applyInverse",
+            py::overload_cast<ConstArray2D const &, TransformWorkspace &>(&Mapping::applyInverse, py::const_),
+            "from"_a, "workspace"_a);
+    cls.def("applyForwardInPlace", py::overload_cast<Array2D const &>(&Mapping::applyForwardInPlace, py::const_),
+            "data"_a);
+    cls.def("applyForwardInPlace",
+            py::overload_cast<Array2D const &, TransformWorkspace &>(&Mapping::applyForwardInPlace, py::const_),
+            "data"_a, "workspace"_a);
+    cls.def("applyInverseInPlace", py::overload_cast<Array2D const &>(&Mapping::applyInverseInPlace, py::const_),
+            "data"_a);
+    cls.def("applyInverseInPlace",
+            py::overload_cast<Array2D const &, TransformWorkspace &>(&Mapping::applyInverseInPlace, py::const_),
+            "data"_a, "workspace"_a);
+    // asynchronous transforms report their results to a callback, which is called from a worker thread;
+    // see astshim.asyncTransforms for asyncio-friendly wrappers
+    cls.def("applyForwardAsync",
+            [](Mapping const &self, ConstArray2D const &from, py::object const &callback,
+               CancellationToken const &token, std::shared_ptr<ThreadPool> const &pool) {
+                auto const fromCopy = copyForThread(from);
+                auto const transformCallback = makeTransformCallback(callback);
+                py::gil_scoped_release release;  // submitting may block if the pool's queue is full
+                self.applyForwardAsync(fromCopy, transformCallback, token, pool);
+            },
+            "from"_a, "callback"_a, "token"_a = CancellationToken(), "pool"_a = py::none());
+    cls.def("applyInverseAsync",
+            [](Mapping const &self, ConstArray2D const &from, py::object const &callback,
+               CancellationToken const &token, std::shared_ptr<ThreadPool> const &pool) {
+                auto const fromCopy = copyForThread(from);
+                auto const transformCallback = makeTransformCallback(callback);
+                py::gil_scoped_release release;
+                self.applyInverseAsync(fromCopy, transformCallback, token, pool);
+            },
+            "from"_a, "callback"_a, "token"_a = CancellationToken(), "pool"_a = py::none());
+    cls.def("tranGridForwardAsync",
+            [](Mapping const &self, PointI const &lbnd, PointI const &ubnd, double tol, int maxpix,
+               std::size_t nPts, py::object const &callback, CancellationToken const &token,
+               std::shared_ptr<ThreadPool> const &pool) {
+                auto const transformCallback = makeTransformCallback(callback);
+                py::gil_scoped_release release;
+                self.tranGridForwardAsync(lbnd, ubnd, tol, maxpix, nPts, transformCallback, token, pool);
+            },
+            "lbnd"_a, "ubnd"_a, "tol"_a, "maxpix"_a, "nPoints"_a, "callback"_a,
+            "token"_a = CancellationToken(), "pool"_a = py::none());
     cls.def("tranGridForward",
-            py::overload_cast<PointI const &, PointI const &, double, int, int>(&Mapping::tranGridForward,
-                                                                                py::const_),
+            py::overload_cast<PointI const &, PointI const &, double, int, std::size_t>(
+                    &Mapping::tranGridForward, py::const_),
             "lbnd"_a, "ubnd"_a, "tol"_a, "maxpix"_a, "nPoints"_a);
     cls.def("tranGridInverse",
-            py::overload_cast<PointI const &, PointI const &, double, int, int>(&Mapping::tranGridInverse,
-                                                                                py::const_),
+            py::overload_cast<PointI const &, PointI const &, double, int, std::size_t>(
+                    &Mapping::tranGridInverse, py::const_),
             "lbnd"_a, "ubnd"_a, "tol"_a, "maxpix"_a, "nPoints"_a);
 }
 
-}  // namespace
 }  // namespace ast
@@ -0,0 +1,53 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <memory>
+
+#include <pybind11/pybind11.h>
+
+#include "astshim/Mapping.h"
+#include "astshim/MappingRegistry.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace ast {
+
+void wrapMappingRegistry(py::module &mod) {
+    py::class_<MappingRegistry, std::shared_ptr<MappingRegistry>> cls(mod, "MappingRegistry");
+
+    cls.def(py::init<>());
+
+    cls.def_property_readonly("nEntries", &MappingRegistry::getNEntries);
+    cls.def_property_readonly("nLookups", &MappingRegistry::getNLookups);
+    cls.def_property_readonly("nHits", &MappingRegistry::getNHits);
+    cls.def_property_readonly("bytes", &MappingRegistry::getBytes);
+    cls.def_property_readonly("bytesSaved", &MappingRegistry::getBytesSaved);
+
+    // Python has no const objects and the interned mapping is shared, so return a copy
+    cls.def("intern",
+            [](MappingRegistry &self, Mapping const &mapping) { return self.intern(mapping)->copy(); },
+            "mapping"_a);
+    cls.def("purge", &MappingRegistry::purge);
+    cls.def("clear", &MappingRegistry::clear);
+}
+
+}  // namespace ast
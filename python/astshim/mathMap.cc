@@ -33,11 +33,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(mathMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapMathMap(py::module &mod) {
     py::class_<MathMap, std::shared_ptr<MathMap>, Mapping> cls(mod, "MathMap");
 
     cls.def(py::init<int, int, std::vector<std::string> const &, std::vector<std::string> const &,
@@ -52,5 +49,4 @@ PYBIND11_MODULE(mathMap, mod) {
     cls.def("copy", &MathMap::copy);
 }
 
-}  // namespace
 }  // namespace ast
@@ -30,11 +30,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(matrixMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapMatrixMap(py::module &mod) {
     py::class_<MatrixMap, std::shared_ptr<MatrixMap>, Mapping> cls(mod, "MatrixMap");
 
     cls.def(py::init<ConstArray2D const &, std::string const &>(), "matrix"_a, "options"_a = "");
@@ -44,5 +41,4 @@ PYBIND11_MODULE(matrixMap, mod) {
     cls.def("copy", &MatrixMap::copy);
 }
 
-}  // namespace
 }  // namespace ast
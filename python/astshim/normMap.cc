@@ -31,11 +31,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(normMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapNormMap(py::module &mod) {
     py::class_<NormMap, std::shared_ptr<NormMap>, Mapping> cls(mod, "NormMap");
 
     cls.def(py::init<Frame const &, std::string const &>(), "frame"_a, "options"_a = "");
@@ -44,5 +41,4 @@ PYBIND11_MODULE(normMap, mod) {
     cls.def("copy", &NormMap::copy);
 }
 
-}  // namespace
 }  // namespace ast
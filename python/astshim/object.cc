@@ -53,9 +53,9 @@ public:
     }
 };
 
-PYBIND11_MODULE(object, mod) {
-    py::module::import("astshim.base");
+}  // namespace
 
+void wrapObject(py::module &mod) {
     py::class_<ObjectMaker, std::shared_ptr<ObjectMaker>> makerCls(mod, "ObjectMaker");
     makerCls.def(py::init<>());
     makerCls.def("__call__", &ObjectMaker::operator());
@@ -100,5 +100,4 @@ PYBIND11_MODULE(object, mod) {
     });
 }
 
-}  // namespace
 }  // namespace ast
@@ -31,11 +31,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(parallelMap, mod) {
-    py::module::import("astshim.cmpMap");
 
+void wrapParallelMap(py::module &mod) {
     py::class_<ParallelMap, std::shared_ptr<ParallelMap>, CmpMap> cls(mod, "ParallelMap");
 
     cls.def(py::init<Mapping const &, Mapping const &, std::string const &>(), "map1"_a, "map2"_a,
@@ -45,5 +42,4 @@ PYBIND11_MODULE(parallelMap, mod) {
     cls.def("copy", &ParallelMap::copy);
 }
 
-}  // namespace
 }  // namespace ast
@@ -32,11 +32,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(pcdMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapPcdMap(py::module &mod) {
     py::class_<PcdMap, std::shared_ptr<PcdMap>, Mapping> cls(mod, "PcdMap");
 
     cls.def(py::init<double, std::vector<double> const &, std::string const &>(), "disco"_a, "pcdcen"_a,
@@ -49,5 +46,4 @@ PYBIND11_MODULE(pcdMap, mod) {
     cls.def("copy", &PcdMap::copy);
 }
 
-}  // namespace
 }  // namespace ast
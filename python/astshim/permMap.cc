@@ -32,11 +32,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(permMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapPermMap(py::module &mod) {
     py::class_<PermMap, std::shared_ptr<PermMap>, Mapping> cls(mod, "PermMap");
 
     cls.def(py::init<std::vector<int> const &, std::vector<int> const &, std::vector<double> const &,
@@ -47,5 +44,4 @@ PYBIND11_MODULE(permMap, mod) {
     cls.def("copy", &PermMap::copy);
 }
 
-}  // namespace
 }  // namespace ast
@@ -33,11 +33,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(polyMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapPolyMap(py::module &mod) {
     py::class_<PolyMap, std::shared_ptr<PolyMap>, Mapping> cls(mod, "PolyMap");
 
     cls.def(py::init<ConstArray2D const &, ConstArray2D const &, std::string const &>(), "coeff_f"_a,
@@ -55,5 +52,4 @@ PYBIND11_MODULE(polyMap, mod) {
             "ubnd"_a);
 }
 
-}  // namespace
 }  // namespace ast
@@ -29,11 +29,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(quadApprox, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapQuadApprox(py::module &mod) {
     py::class_<QuadApprox> cls(mod, "QuadApprox");
 
     cls.def(py::init<Mapping const &, std::vector<double> const &, std::vector<double> const &, int, int>(),
@@ -43,5 +40,4 @@ PYBIND11_MODULE(quadApprox, mod) {
     cls.def_readonly("rms", &QuadApprox::rms);
 }
 
-}  // namespace
 }  // namespace ast
@@ -30,11 +30,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(rateMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapRateMap(py::module &mod) {
     py::class_<RateMap, std::shared_ptr<RateMap>, Mapping> cls(mod, "RateMap");
 
     cls.def(py::init<Mapping const &, int, int, std::string const &>(), "map"_a, "ax1"_a, "ax2"_a,
@@ -44,5 +41,4 @@ PYBIND11_MODULE(rateMap, mod) {
     cls.def("copy", &RateMap::copy);
 }
 
-}  // namespace
 }  // namespace ast
@@ -31,11 +31,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(seriesMap, mod) {
-    py::module::import("astshim.cmpMap");
 
+void wrapSeriesMap(py::module &mod) {
     py::class_<SeriesMap, std::shared_ptr<SeriesMap>, CmpMap> cls(mod, "SeriesMap");
 
     cls.def(py::init<Mapping const &, Mapping const &, std::string const &>(), "map1"_a, "map2"_a,
@@ -45,5 +42,4 @@ PYBIND11_MODULE(seriesMap, mod) {
     cls.def("copy", &SeriesMap::copy);
 }
 
-}  // namespace
 }  // namespace ast
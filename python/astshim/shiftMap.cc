@@ -32,11 +32,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(shiftMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapShiftMap(py::module &mod) {
     py::class_<ShiftMap, std::shared_ptr<ShiftMap>, Mapping> cls(mod, "ShiftMap");
 
     cls.def(py::init<std::vector<double> const &, std::string const &>(), "shift"_a, "options"_a = "");
@@ -45,5 +42,4 @@ PYBIND11_MODULE(shiftMap, mod) {
     cls.def("copy", &ShiftMap::copy);
 }
 
-}  // namespace
 }  // namespace ast
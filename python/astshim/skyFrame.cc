@@ -33,11 +33,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(skyFrame, mod) {
-    py::module::import("astshim.frame");
 
+void wrapSkyFrame(py::module &mod) {
     py::class_<SkyFrame, std::shared_ptr<SkyFrame>, Frame> cls(mod, "SkyFrame");
 
     cls.def(py::init<std::string const &>(), "options"_a = "");
@@ -76,5 +73,4 @@ PYBIND11_MODULE(skyFrame, mod) {
     cls.def("skyOffsetMap", &SkyFrame::skyOffsetMap);
 }
 
-}  // namespace
 }  // namespace ast
@@ -32,11 +32,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(slaMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapSlaMap(py::module &mod) {
     py::class_<SlaMap, std::shared_ptr<SlaMap>, Mapping> cls(mod, "SlaMap");
 
     cls.def(py::init<std::string const &>(), "options"_a = "");
@@ -46,5 +43,4 @@ PYBIND11_MODULE(slaMap, mod) {
     cls.def("add", &SlaMap::add, "cvt"_a, "args"_a = std::vector<double>());
 }
 
-}  // namespace
 }  // namespace ast
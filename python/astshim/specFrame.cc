@@ -34,11 +34,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(specFrame, mod) {
-    py::module::import("astshim.frame");
 
+void wrapSpecFrame(py::module &mod) {
     py::class_<SpecFrame, std::shared_ptr<SpecFrame>, Frame> cls(mod, "SpecFrame");
 
     cls.def(py::init<std::string const &>(), "options"_a = "");
@@ -75,5 +72,4 @@ PYBIND11_MODULE(specFrame, mod) {
     cls.def("setStdOfRest", &SpecFrame::setStdOfRest, "stdOfRest"_a);
 }
 
-}  // namespace
 }  // namespace ast
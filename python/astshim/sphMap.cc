@@ -30,11 +30,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(sphMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapSphMap(py::module &mod) {
     py::class_<SphMap, std::shared_ptr<SphMap>, Mapping> cls(mod, "SphMap");
 
     cls.def(py::init<std::string const &>(), "options"_a = "");
@@ -46,5 +43,4 @@ PYBIND11_MODULE(sphMap, mod) {
     cls.def("copy", &SphMap::copy);
 }
 
-}  // namespace
 }  // namespace ast
@@ -25,14 +25,14 @@
 #include <pybind11/pybind11.h>
 
 #include "astshim/Stream.h"
+#include "astshim/CompressedFileStream.h"
 
 namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
 
-PYBIND11_MODULE(stream, mod) {
+void wrapStream(py::module &mod) {
     // Stream
     py::class_<Stream, std::shared_ptr<Stream>> clsStream(mod, "Stream");
 
@@ -52,6 +52,27 @@ PYBIND11_MODULE(stream, mod) {
 
     clsFileStream.def_property_readonly("path", &FileStream::getPath);
 
+    // CompressedFileStream
+    py::enum_<Compression>(mod, "Compression")
+            .value("NONE", Compression::NONE)
+            .value("GZIP", Compression::GZIP)
+            .value("ZSTD", Compression::ZSTD);
+
+    py::class_<CompressedFileStream, std::shared_ptr<CompressedFileStream>, Stream> clsCompressedFileStream(
+            mod, "CompressedFileStream");
+
+    clsCompressedFileStream.def_readonly_static("DEFAULT_BUFFER_SIZE",
+                                                &CompressedFileStream::DEFAULT_BUFFER_SIZE);
+
+    clsCompressedFileStream.def(py::init<std::string const &, bool, Compression, int, std::size_t>(),
+                                "path"_a, "doWrite"_a = false, "compression"_a = Compression::GZIP,
+                                "level"_a = -1, "bufferSize"_a = CompressedFileStream::DEFAULT_BUFFER_SIZE);
+
+    clsCompressedFileStream.def_property_readonly("path", &CompressedFileStream::getPath);
+    clsCompressedFileStream.def_property_readonly("compression", &CompressedFileStream::getCompression);
+    clsCompressedFileStream.def("close", &CompressedFileStream::close);
+    clsCompressedFileStream.def_static("isAvailable", &CompressedFileStream::isAvailable, "compression"_a);
+
     // StringStream
     py::class_<StringStream, std::shared_ptr<StringStream>, Stream> clsStringStream(mod, "StringStream");
 
@@ -62,5 +83,4 @@ PYBIND11_MODULE(stream, mod) {
     clsStringStream.def("sinkToSource", &StringStream::sinkToSource);
 }
 
-}  // namespace
 }  // namespace ast
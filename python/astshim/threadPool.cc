@@ -0,0 +1,79 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <memory>
+
+#include <pybind11/pybind11.h>
+
+#include "astshim/ThreadPool.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace ast {
+namespace {
+
+/// Does the calling thread hold the GIL?
+bool holdsGil() {
+#if PY_VERSION_HEX >= 0x03040000
+    return PyGILState_Check();
+#else
+    return _PyThreadState_Current && _PyThreadState_Current == PyGILState_GetThisThreadState();
+#endif
+}
+
+}  // namespace
+
+void wrapThreadPool(py::module &mod) {
+    py::register_exception<OperationCancelled>(mod, "OperationCancelled");
+
+    py::class_<CancellationToken> clsToken(mod, "CancellationToken");
+    clsToken.def(py::init<>());
+    clsToken.def("cancel", &CancellationToken::cancel);
+    clsToken.def_property_readonly("isCancelled", &CancellationToken::isCancelled);
+
+    // Python can only configure a pool and pass it to asynchronous operations;
+    // arbitrary Python callables are not run on it
+    py::class_<ThreadPool, std::shared_ptr<ThreadPool>> cls(mod, "ThreadPool");
+    // Destroying a pool waits for its tasks, whose callbacks may need the GIL, so release the GIL
+    // when the last reference goes away in a thread that holds it
+    cls.def(py::init([](int nThreads, std::size_t maxQueued) {
+                return std::shared_ptr<ThreadPool>(new ThreadPool(nThreads, maxQueued), [](ThreadPool *pool) {
+                    if (holdsGil()) {
+                        py::gil_scoped_release release;
+                        delete pool;
+                    } else {
+                        delete pool;
+                    }
+                });
+            }),
+            "nThreads"_a = 0, "maxQueued"_a = 0);
+    cls.def_property_readonly("nThreads", &ThreadPool::getNThreads);
+    cls.def_property_readonly("maxQueued", &ThreadPool::getMaxQueued);
+    cls.def_property_readonly("nQueued", &ThreadPool::getNQueued);
+
+    mod.def("getDefaultThreadPool", &getDefaultThreadPool);
+    // replacing the pool may wait for the old pool's tasks, which may need the GIL to run their callbacks
+    mod.def("setDefaultThreadPool", &setDefaultThreadPool, "pool"_a,
+            py::call_guard<py::gil_scoped_release>());
+}
+
+}  // namespace ast
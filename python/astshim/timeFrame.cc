@@ -32,11 +32,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(timeFrame, mod) {
-    py::module::import("astshim.frame");
 
+void wrapTimeFrame(py::module &mod) {
     py::class_<TimeFrame, std::shared_ptr<TimeFrame>, Frame> cls(mod, "TimeFrame");
 
     cls.def(py::init<std::string const &>(), "options"_a = "");
@@ -51,5 +48,4 @@ PYBIND11_MODULE(timeFrame, mod) {
     cls.def("currentTime", &TimeFrame::currentTime);
 }
 
-}  // namespace
 }  // namespace ast
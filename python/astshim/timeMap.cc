@@ -32,11 +32,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(timeMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapTimeMap(py::module &mod) {
     py::class_<TimeMap, std::shared_ptr<TimeMap>, Mapping> cls(mod, "TimeMap");
 
     cls.def(py::init<std::string const &>(), "options"_a = "");
@@ -46,5 +43,4 @@ PYBIND11_MODULE(timeMap, mod) {
     cls.def("add", &TimeMap::add, "cvt"_a, "args"_a);
 }
 
-}  // namespace
 }  // namespace ast
@@ -30,11 +30,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(tranMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapTranMap(py::module &mod) {
     py::class_<TranMap, std::shared_ptr<TranMap>, Mapping> cls(mod, "TranMap");
 
     cls.def(py::init<Mapping const &, Mapping const &, std::string const &>(), "map1"_a, "map2"_a,
@@ -47,5 +44,4 @@ PYBIND11_MODULE(tranMap, mod) {
     cls.def("copy", &TranMap::copy);
 }
 
-}  // namespace
 }  // namespace ast
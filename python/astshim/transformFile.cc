@@ -0,0 +1,57 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <pybind11/pybind11.h>
+
+#include "astshim/Mapping.h"
+#include "astshim/transformFile.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace ast {
+
+void wrapTransformFile(py::module &mod) {
+    py::enum_<ColumnLayout>(mod, "ColumnLayout")
+            .value("INTERLEAVED", ColumnLayout::INTERLEAVED)
+            .value("COLUMNS", ColumnLayout::COLUMNS);
+
+    py::class_<ColumnSpec> clsSpec(mod, "ColumnSpec");
+    clsSpec.def(py::init<>());
+    clsSpec.def_readwrite("layout", &ColumnSpec::layout);
+    clsSpec.def_readwrite("forward", &ColumnSpec::forward);
+    clsSpec.def_readwrite("blockSize", &ColumnSpec::blockSize);
+    clsSpec.def_readwrite("nThreads", &ColumnSpec::nThreads);
+    clsSpec.def_readwrite("prefetchBlocks", &ColumnSpec::prefetchBlocks);
+    clsSpec.def_readwrite("nanInputIsBad", &ColumnSpec::nanInputIsBad);
+    clsSpec.def_readwrite("badOutput", &ColumnSpec::badOutput);
+
+    py::class_<TransformFileResult> clsResult(mod, "TransformFileResult");
+    clsResult.def_readonly("nPoints", &TransformFileResult::nPoints);
+    clsResult.def_readonly("nBlocks", &TransformFileResult::nBlocks);
+    clsResult.def_readonly("nBadPoints", &TransformFileResult::nBadPoints);
+
+    // the work is done by threads that do not need Python, so release the GIL
+    mod.def("transformFile", &transformFile, "mapping"_a, "inputPath"_a, "outputPath"_a,
+            "spec"_a = ColumnSpec(), py::call_guard<py::gil_scoped_release>());
+}
+
+}  // namespace ast
@@ -0,0 +1,59 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "astshim/tuning.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace ast {
+
+void wrapTuning(py::module &mod) {
+    py::enum_<TuneParam>(mod, "TuneParam")
+            .value("ObjectCaching", TuneParam::ObjectCaching)
+            .value("MemoryCaching", TuneParam::MemoryCaching);
+
+    py::enum_<TuneStringParam>(mod, "TuneStringParam")
+            .value("HRDel", TuneStringParam::HRDel)
+            .value("MRDel", TuneStringParam::MRDel)
+            .value("LRDel", TuneStringParam::LRDel);
+
+    mod.def("tune", py::overload_cast<TuneParam>(&tune), "param"_a);
+    mod.def("tune", py::overload_cast<TuneParam, int>(&tune), "param"_a, "value"_a);
+    mod.def("tune", py::overload_cast<TuneStringParam>(&tune), "param"_a);
+    mod.def("tune", py::overload_cast<TuneStringParam, std::string const &>(&tune), "param"_a, "value"_a);
+    mod.def("getTuneName", py::overload_cast<TuneParam>(&getTuneName), "param"_a);
+    mod.def("getTuneName", py::overload_cast<TuneStringParam>(&getTuneName), "param"_a);
+
+    // ScopedTune is a context manager in Python; the previous value is restored by __exit__
+    py::class_<ScopedTune> cls(mod, "ScopedTune");
+    cls.def(py::init<TuneParam, int>(), "param"_a, "value"_a);
+    cls.def(py::init<TuneStringParam, std::string const &>(), "param"_a, "value"_a);
+    cls.def("restore", &ScopedTune::restore);
+    cls.def("__enter__", [](ScopedTune &self) -> ScopedTune & { return self; },
+            py::return_value_policy::reference);
+    cls.def("__exit__", [](ScopedTune &self, py::object, py::object, py::object) { self.restore(); });
+}
+
+}  // namespace ast
@@ -30,11 +30,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(unitMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapUnitMap(py::module &mod) {
     py::class_<UnitMap, std::shared_ptr<UnitMap>, Mapping> cls(mod, "UnitMap");
 
     cls.def(py::init<int, std::string const &>(), "ncoord"_a, "options"_a = "");
@@ -43,5 +40,4 @@ PYBIND11_MODULE(unitMap, mod) {
     cls.def("copy", &UnitMap::copy);
 }
 
-}  // namespace
 }  // namespace ast
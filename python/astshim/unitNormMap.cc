@@ -32,11 +32,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(unitNormMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapUnitNormMap(py::module &mod) {
     py::class_<UnitNormMap, std::shared_ptr<UnitNormMap>, Mapping> cls(mod, "UnitNormMap");
 
     cls.def(py::init<std::vector<double> const &, std::string const &>(), "centre"_a, "options"_a = "");
@@ -45,5 +42,4 @@ PYBIND11_MODULE(unitNormMap, mod) {
     cls.def("copy", &UnitNormMap::copy);
 }
 
-}  // namespace
 }  // namespace ast
@@ -31,11 +31,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(wcsMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapWcsMap(py::module &mod) {
     py::enum_<WcsType>(mod, "WcsType")
             .value("AZP", WcsType::AZP)
             .value("SZP", WcsType::SZP)
@@ -87,5 +84,4 @@ PYBIND11_MODULE(wcsMap, mod) {
     cls.def("getPVMax", &WcsMap::getPVMax);
 }
 
-}  // namespace
 }  // namespace ast
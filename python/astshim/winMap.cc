@@ -32,11 +32,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(winMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapWinMap(py::module &mod) {
     py::class_<WinMap, std::shared_ptr<WinMap>, Mapping> cls(mod, "WinMap");
 
     cls.def(py::init<std::vector<double> const &, std::vector<double> const &, std::vector<double> const &,
@@ -47,5 +44,4 @@ PYBIND11_MODULE(winMap, mod) {
     cls.def("copy", &WinMap::copy);
 }
 
-}  // namespace
 }  // namespace ast
@@ -30,11 +30,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(xmlChan, mod) {
-    py::module::import("astshim.channel");
 
+void wrapXmlChan(py::module &mod) {
     py::class_<XmlChan, std::shared_ptr<XmlChan>, Channel> cls(mod, "XmlChan");
 
     cls.def(py::init<Stream &, std::string const &>(), "stream"_a, "options"_a = "");
@@ -44,5 +41,4 @@ PYBIND11_MODULE(xmlChan, mod) {
     cls.def_property("xmlPrefix", &XmlChan::getXmlPrefix, &XmlChan::setXmlPrefix);
 }
 
-}  // namespace
 }  // namespace ast
@@ -30,11 +30,8 @@ namespace py = pybind11;
 using namespace pybind11::literals;
 
 namespace ast {
-namespace {
-
-PYBIND11_MODULE(zoomMap, mod) {
-    py::module::import("astshim.mapping");
 
+void wrapZoomMap(py::module &mod) {
     py::class_<ZoomMap, std::shared_ptr<ZoomMap>, Mapping> cls(mod, "ZoomMap");
 
     cls.def(py::init<int, double, std::string const &>(), "ncoord"_a, "zoom"_a, "options"_a = "");
@@ -45,5 +42,4 @@ PYBIND11_MODULE(zoomMap, mod) {
     cls.def("copy", &ZoomMap::copy);
 }
 
-}  // namespace
 }  // namespace ast
@@ -0,0 +1,259 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef ASTSHIM_CENSUS_SITES
+#include <execinfo.h>
+#endif
+
+#include "astshim/base.h"
+#include "astshim/Census.h"
+#include "astshim/Object.h"
+
+namespace ast {
+namespace {
+
+/// Information about one recorded AST object
+struct CensusRecord {
+    std::string className;
+    std::string site;
+    std::size_t bytes;
+    int nRefs;  // number of astshim Objects that own a reference to this AST object
+};
+
+/**
+Return the in-memory size of an AST object, or `defaultSize` if it cannot be determined
+
+The size cannot be determined if the object is locked by another thread.
+*/
+std::size_t getRawObjSize(AstObject const *rawObj, std::size_t defaultSize = 0) {
+    if (!astOK) {
+        return defaultSize;
+    }
+    int const size = astGetObjSize(rawObj);
+    if (!astOK) {
+        astClearStatus;
+        return defaultSize;
+    }
+    return static_cast<std::size_t>(std::max(size, 0));
+}
+
+std::string getRawClassName(AstObject const *rawObj) {
+    if (!astOK) {
+        return "";
+    }
+    char const *rawName = astGetC(rawObj, "Class");
+    if (!astOK) {
+        astClearStatus;
+        return "";
+    }
+    return rawName ? rawName : "";
+}
+
+#ifdef ASTSHIM_CENSUS_SITES
+/// Summarize the call stack of the caller of Object's constructor
+std::string getCreationSite() {
+    int const maxFrames = 8;
+    int const nSkip = 3;  // getCreationSite, censusAdd, Object constructor
+    void *frames[maxFrames];
+    int const nFrames = backtrace(frames, maxFrames);
+    if (nFrames <= nSkip) {
+        return "";
+    }
+    std::unique_ptr<char *, decltype(&std::free)> symbols(backtrace_symbols(frames, nFrames), &std::free);
+    if (!symbols) {
+        return "";
+    }
+    std::string site;
+    for (int i = nSkip; i < nFrames; ++i) {
+        if (!site.empty()) {
+            site += " < ";
+        }
+        site += symbols.get()[i];
+    }
+    return site;
+}
+#else
+std::string getCreationSite() { return ""; }
+#endif
+
+bool initialEnabled() {
+    char const *envValue = std::getenv("ASTSHIM_CENSUS");
+    return envValue && envValue[0] != '\0' && std::string(envValue) != "0";
+}
+
+class Census {
+public:
+    static Census &get() {
+        // never destroyed, so objects may safely be released during static destruction
+        static Census *census = new Census();
+        return *census;
+    }
+
+    std::atomic<bool> enabled{initialEnabled()};
+    std::atomic<std::size_t> nRecords{0};  // size of _records; lets censusRemove skip the lock
+
+    void add(AstObject const *rawObj) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto iter = _records.find(rawObj);
+        if (iter != _records.end()) {
+            ++iter->second.nRefs;
+            return;
+        }
+        CensusRecord record{getRawClassName(rawObj), getCreationSite(), getRawObjSize(rawObj), 1};
+        _addBytes(record.bytes);
+        _records.emplace(rawObj, std::move(record));
+        nRecords.store(_records.size());
+    }
+
+    void remove(AstObject const *rawObj) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto iter = _records.find(rawObj);
+        if (iter == _records.end()) {
+            return;
+        }
+        if (--iter->second.nRefs > 0) {
+            return;
+        }
+        _bytes -= iter->second.bytes;
+        _records.erase(iter);
+        nRecords.store(_records.size());
+    }
+
+    std::vector<CensusEntry> getEntries(bool remeasure) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::map<std::pair<std::string, std::string>, CensusEntry> entryMap;
+        for (auto &item : _records) {
+            auto &record = item.second;
+            if (remeasure) {
+                // keep the recorded size of objects that cannot be measured, e.g. if locked by another thread
+                std::size_t const bytes = getRawObjSize(item.first, record.bytes);
+                _bytes -= record.bytes;
+                record.bytes = bytes;
+                _addBytes(bytes);
+            }
+            auto &entry = entryMap[std::make_pair(record.className, record.site)];
+            entry.className = record.className;
+            entry.site = record.site;
+            ++entry.count;
+            entry.bytes += record.bytes;
+        }
+        std::vector<CensusEntry> entries;
+        entries.reserve(entryMap.size());
+        for (auto const &item : entryMap) {
+            entries.push_back(item.second);
+        }
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](CensusEntry const &a, CensusEntry const &b) { return a.bytes > b.bytes; });
+        return entries;
+    }
+
+    std::size_t getBytes() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _bytes;
+    }
+
+    std::size_t getHighWaterMark() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _highWaterMark;
+    }
+
+    void resetHighWaterMark() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _highWaterMark = _bytes;
+    }
+
+private:
+    Census() = default;
+
+    void _addBytes(std::size_t bytes) {
+        _bytes += bytes;
+        _highWaterMark = std::max(_highWaterMark, _bytes);
+    }
+
+    std::mutex _mutex;
+    std::unordered_map<AstObject const *, CensusRecord> _records;
+    std::size_t _bytes = 0;          // total recorded bytes
+    std::size_t _highWaterMark = 0;  // maximum of _bytes
+};
+
+}  // namespace
+
+bool census(int enable) {
+    auto &enabled = Census::get().enabled;
+    if (enable < 0) {
+        return enabled.load();
+    }
+    bool const wasEnabled = enabled.exchange(enable > 0);
+    if (!wasEnabled && enable > 0) {
+        Census::get().resetHighWaterMark();
+    }
+    return wasEnabled;
+}
+
+std::vector<CensusEntry> getCensus(bool remeasure) { return Census::get().getEntries(remeasure); }
+
+std::size_t getCensusBytes() { return Census::get().getBytes(); }
+
+std::size_t getCensusHighWaterMark() { return Census::get().getHighWaterMark(); }
+
+void resetCensusHighWaterMark() { Census::get().resetHighWaterMark(); }
+
+std::size_t deepSize(std::vector<std::shared_ptr<Object const>> const &objects) {
+    std::set<AstObject const *> seen;
+    std::size_t size = 0;
+    for (auto const &object : objects) {
+        if (!object || !seen.insert(object->getRawPtr()).second) {
+            continue;
+        }
+        size += object->getObjSize();
+    }
+    return size;
+}
+
+namespace detail {
+
+void censusAdd(AstObject const *rawObj) {
+    auto &census = Census::get();
+    if (rawObj && census.enabled.load(std::memory_order_relaxed)) {
+        census.add(rawObj);
+    }
+}
+
+void censusRemove(AstObject const *rawObj) {
+    auto &census = Census::get();
+    if (rawObj && census.nRecords.load(std::memory_order_relaxed) > 0) {
+        census.remove(rawObj);
+    }
+}
+
+}  // namespace detail
+}  // namespace ast
@@ -25,6 +25,8 @@
 #include "astshim/Object.h"
 #include "astshim/Stream.h"
 #include "astshim/Channel.h"
+#include "astshim/ChannelReader.h"
+#include "astshim/Instrumentation.h"
 
 namespace ast {
 
@@ -50,16 +52,48 @@ Channel::~Channel() {
 }
 
 std::shared_ptr<Object> Channel::read() {
-    AstObject *rawRet = reinterpret_cast<AstObject *>(astRead(getRawPtr()));
-    assertOK(rawRet);
-    if (!rawRet) {
+    auto object = _read();
+    if (!object) {
         throw std::runtime_error("Could not read an AST object from this channel");
     }
-    return Object::fromAstObject<Object>(rawRet, false);
+    return object;
+}
+
+std::vector<std::shared_ptr<Object>> Channel::readAll(std::shared_ptr<ThreadPool> const &pool,
+                                                      std::size_t maxLookahead) {
+    detail::OpScope opScope("readAll", *this);
+    auto const nBytesSourced = _stream._nBytesSourced;
+    ChannelReader reader(*this, pool, maxLookahead);
+    std::vector<std::shared_ptr<Object>> objects;
+    while (auto object = reader.next()) {
+        objects.push_back(object);
+    }
+    opScope.addBytes(_stream._nBytesSourced - nBytesSourced);
+    return objects;
+}
+
+std::shared_ptr<Object> Channel::_read() {
+    detail::OpScope opScope("read", *this);
+    auto const nBytesSourced = _stream._nBytesSourced;
+    AstObject *rawRet = reinterpret_cast<AstObject *>(astRead(getRawPtr()));
+    opScope.addBytes(_stream._nBytesSourced - nBytesSourced);
+    if (!rawRet && _stream.hasSourceError()) {
+        // AST may also report an error (e.g. an incomplete object), but the stream error is the cause
+        try {
+            assertOK();
+        } catch (std::runtime_error const &) {
+        }
+        _stream.rethrowSourceError();
+    }
+    assertOK(rawRet);
+    return rawRet ? Object::fromAstObject<Object>(rawRet, false) : nullptr;
 }
 
 int Channel::write(Object const &object) {
+    detail::OpScope opScope("write", *this);
+    auto const nBytesSunk = _stream._nBytesSunk;
     int ret = astWrite(getRawPtr(), object.getRawPtr());
+    opScope.addBytes(_stream._nBytesSunk - nBytesSunk);
     assertOK();
     return ret;
 }
@@ -0,0 +1,214 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "astshim/ChannelReader.h"
+#include "astshim/detail/xmlUtils.h"
+#include "astshim/Stream.h"
+#include "astshim/XmlChan.h"
+
+namespace ast {
+namespace {
+
+// Number of bytes of XML read at a time; XML is not read by line, since a document may be on one line
+std::size_t const XML_BLOCK_SIZE = 64 * 1024;
+
+/// Return true if the first word of `line` is `word` (lowercase), ignoring case and leading whitespace
+bool isKeyword(char const *line, char const *word) {
+    while (*line == ' ' || *line == '\t') {
+        ++line;
+    }
+    for (; *word != '\0'; ++line, ++word) {
+        if (std::tolower(static_cast<unsigned char>(*line)) != *word) {
+            return false;
+        }
+    }
+    return *line == '\0' || *line == ' ' || *line == '\t';
+}
+
+}  // namespace
+
+std::size_t constexpr ChannelReader::DEFAULT_LOOKAHEAD_PER_THREAD;
+
+ChannelReader::ChannelReader(Channel &channel, std::shared_ptr<ThreadPool> const &pool,
+                             std::size_t maxLookahead)
+        : _channel(channel),
+          _pool(pool ? pool : getDefaultThreadPool()),
+          _maxLookahead(maxLookahead),
+          _options(),
+          _xmlSplitter(),
+          _xmlBlock(),
+          _pending(),
+          _decoded(),
+          _isEnd(false),
+          _scanError(),
+          _nRead(0) {
+    auto const className = channel.getClassName();
+    if (className == "XmlChan") {
+        _xmlSplitter.reset(new detail::XmlSplitter());
+        _xmlBlock.resize(XML_BLOCK_SIZE);
+    } else if (className != "Channel" || channel._stream.getIsFits()) {
+        std::ostringstream os;
+        os << "Cannot read a " << className << "; only Channel and XmlChan are supported";
+        throw std::invalid_argument(os.str());
+    }
+    if (_maxLookahead == 0) {
+        _maxLookahead = DEFAULT_LOOKAHEAD_PER_THREAD * std::max(_pool->getNThreads(), 1);
+    }
+    std::ostringstream os;
+    os << "Skip=" << channel.getSkip() << ", Strict=" << channel.getStrict()
+       << ", ReportLevel=" << channel.getReportLevel();
+    _options = os.str();
+}
+
+ChannelReader::~ChannelReader() {
+    // objects still being decoded are unlocked, so wait for them and lock them for this thread to free
+    for (auto &future : _pending) {
+        try {
+            for (auto const &object : future.get()) {
+                object->lock(true);
+            }
+        } catch (...) {
+            // the objects could not be decoded, so there is nothing to free
+        }
+    }
+}
+
+std::shared_ptr<Object> ChannelReader::next() {
+    while (_decoded.empty()) {
+        _fill();
+        if (_pending.empty()) {
+            if (_scanError) {
+                std::rethrow_exception(_scanError);
+            }
+            return nullptr;
+        }
+        auto future = std::move(_pending.front());
+        _pending.pop_front();
+        // keep the pool busy while waiting for these objects
+        _fill();
+        for (auto &object : future.get()) {
+            object->lock(true);
+            _decoded.push_back(std::move(object));
+        }
+    }
+    auto object = std::move(_decoded.front());
+    _decoded.pop_front();
+    ++_nRead;
+    return object;
+}
+
+std::vector<std::shared_ptr<Object>> ChannelReader::_decode(std::string const &text, bool isXml,
+                                                            std::string const &options) {
+    StringStream stream(text);
+    std::unique_ptr<Channel> channel;
+    if (isXml) {
+        channel.reset(new XmlChan(stream, options));
+    } else {
+        channel.reset(new Channel(stream, options));
+    }
+    // the text may hold more than one object, e.g. the XML of an IVOA description
+    std::vector<std::shared_ptr<Object>> objects;
+    try {
+        while (auto object = channel->_read()) {
+            object->unlock();
+            objects.push_back(std::move(object));
+        }
+    } catch (...) {
+        // lock the objects read so far again, so this thread can free them
+        for (auto const &object : objects) {
+            object->lock(true);
+        }
+        throw;
+    }
+    return objects;
+}
+
+bool ChannelReader::_scan(std::string &text) {
+    if (_xmlSplitter) {
+        return _scanXml(text);
+    }
+    text.clear();
+    int depth = 0;
+    bool hasBegin = false;
+    while (char const *line = _channel._stream.source()) {
+        text.append(line);
+        text.push_back('\n');
+        if (isKeyword(line, "begin")) {
+            ++depth;
+            hasBegin = true;
+        } else if (isKeyword(line, "end") && depth > 0) {
+            --depth;
+            if (depth == 0) {
+                return true;
+            }
+        }
+    }
+    _channel._stream.rethrowSourceError();
+    // an incomplete object is decoded anyway, so that decoding reports the error
+    return hasBegin;
+}
+
+bool ChannelReader::_scanXml(std::string &text) {
+    while (!_xmlSplitter->hasSegment()) {
+        std::size_t const nRead = _channel._stream.sourceBlock(_xmlBlock.data(), _xmlBlock.size());
+        if (nRead == 0) {
+            _channel._stream.rethrowSourceError();
+            if (_xmlSplitter->isInElement()) {
+                // an incomplete element is decoded anyway, so that decoding reports the error
+                text = _xmlSplitter->popIncomplete();
+                return true;
+            }
+            return false;
+        }
+        _xmlSplitter->add(_xmlBlock.data(), nRead);
+    }
+    text = _xmlSplitter->pop();
+    return true;
+}
+
+void ChannelReader::_fill() {
+    while (!_isEnd && _pending.size() < _maxLookahead) {
+        std::string text;
+        try {
+            if (!_scan(text)) {
+                _isEnd = true;
+                break;
+            }
+        } catch (...) {
+            // report the error after returning the objects before it
+            _scanError = std::current_exception();
+            _isEnd = true;
+            break;
+        }
+        bool const isXml = static_cast<bool>(_xmlSplitter);
+        _pending.push_back(_pool->submit([text = std::move(text), isXml, options = _options] {
+            return _decode(text, isXml, options);
+        }));
+    }
+}
+
+}  // namespace ast
@@ -0,0 +1,593 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#ifdef ASTSHIM_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef ASTSHIM_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "astshim/CompressedFileStream.h"
+
+namespace ast {
+namespace {
+
+// Initial bytes ("magic numbers") that identify compressed files
+unsigned char const GZIP_MAGIC[] = {0x1f, 0x8b};
+unsigned char const ZSTD_MAGIC[] = {0x28, 0xb5, 0x2f, 0xfd};
+
+#ifdef ASTSHIM_HAVE_ZLIB
+bool const HAVE_ZLIB = true;
+#else
+bool const HAVE_ZLIB = false;
+#endif
+
+#ifdef ASTSHIM_HAVE_ZSTD
+bool const HAVE_ZSTD = true;
+#else
+bool const HAVE_ZSTD = false;
+#endif
+
+/// Return true if `data` starts with `magic`
+template <std::size_t N>
+bool startsWith(std::string const &data, unsigned char const (&magic)[N]) {
+    auto const begin = reinterpret_cast<unsigned char const *>(data.data());
+    return data.size() >= N && std::equal(magic, magic + N, begin);
+}
+
+/**
+Compresses data, writing the result to a file in chunks of bounded size
+*/
+class Encoder {
+public:
+    virtual ~Encoder() = default;
+
+    /**
+    Compress data and write the result to `file`
+
+    @param[in] data  Data to compress
+    @param[in] size  Number of bytes of data
+    @param[in] finish  If true, this is the last data; end the compressed stream
+    @param[in,out] file  File to which to write compressed data
+    */
+    virtual void encode(char const *data, std::size_t size, bool finish, std::ofstream &file) = 0;
+};
+
+/**
+Decompresses data from an input buffer into an output buffer
+*/
+class Decoder {
+public:
+    virtual ~Decoder() = default;
+
+    /**
+    Decompress as much data as possible
+
+    @param[in] in  Compressed data
+    @param[in] nIn  Number of bytes of compressed data
+    @param[out] nConsumed  Number of bytes of compressed data consumed
+    @param[out] out  Buffer for decompressed data
+    @param[in] nOut  Size of out, in bytes
+    @param[out] nProduced  Number of bytes of decompressed data produced
+    @return true if the end of a compressed stream was reached, in which case
+        @ref reset must be called before decoding any more data
+    */
+    virtual bool decode(char const *in, std::size_t nIn, std::size_t &nConsumed, char *out, std::size_t nOut,
+                        std::size_t &nProduced) = 0;
+
+    /// Prepare to decode a new compressed stream
+    virtual void reset() = 0;
+};
+
+/// "Compress" by copying data unchanged
+class PlainEncoder : public Encoder {
+public:
+    void encode(char const *data, std::size_t size, bool, std::ofstream &file) override {
+        file.write(data, size);
+    }
+};
+
+/// "Decompress" by copying data unchanged
+class PlainDecoder : public Decoder {
+public:
+    bool decode(char const *in, std::size_t nIn, std::size_t &nConsumed, char *out, std::size_t nOut,
+                std::size_t &nProduced) override {
+        nConsumed = nProduced = std::min(nIn, nOut);
+        std::copy(in, in + nConsumed, out);
+        return false;
+    }
+
+    void reset() override {}
+};
+
+#ifdef ASTSHIM_HAVE_ZLIB
+
+/// Throw std::runtime_error reporting a zlib error
+[[noreturn]] void throwZlibError(std::string const &what, z_stream const &stream, int code) {
+    std::ostringstream os;
+    os << what << " failed with zlib error " << code;
+    if (stream.msg) {
+        os << ": " << stream.msg;
+    }
+    throw std::runtime_error(os.str());
+}
+
+// windowBits for deflateInit2 and inflateInit2: the maximum window, plus 16 to use the gzip format
+int const GZIP_WINDOW_BITS = 15 + 16;
+
+class GzipEncoder : public Encoder {
+public:
+    GzipEncoder(int level, std::size_t bufferSize) : _stream(), _buffer(bufferSize) {
+        int const code = deflateInit2(&_stream, level < 0 ? Z_DEFAULT_COMPRESSION : level, Z_DEFLATED,
+                                      GZIP_WINDOW_BITS, 8, Z_DEFAULT_STRATEGY);
+        if (code != Z_OK) {
+            throwZlibError("Initializing gzip compression", _stream, code);
+        }
+    }
+
+    ~GzipEncoder() { deflateEnd(&_stream); }
+
+    void encode(char const *data, std::size_t size, bool finish, std::ofstream &file) override {
+        _stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+        _stream.avail_in = static_cast<uInt>(size);
+        int code;
+        do {
+            _stream.next_out = reinterpret_cast<Bytef *>(_buffer.data());
+            _stream.avail_out = static_cast<uInt>(_buffer.size());
+            code = deflate(&_stream, finish ? Z_FINISH : Z_NO_FLUSH);
+            if (code == Z_STREAM_ERROR) {
+                throwZlibError("gzip compression", _stream, code);
+            }
+            file.write(_buffer.data(), _buffer.size() - _stream.avail_out);
+        } while (_stream.avail_out == 0 || (finish && code != Z_STREAM_END));
+    }
+
+private:
+    z_stream _stream;
+    std::vector<char> _buffer;  // compressed data
+};
+
+class GzipDecoder : public Decoder {
+public:
+    GzipDecoder() : _stream() {
+        int const code = inflateInit2(&_stream, GZIP_WINDOW_BITS);
+        if (code != Z_OK) {
+            throwZlibError("Initializing gzip decompression", _stream, code);
+        }
+    }
+
+    ~GzipDecoder() { inflateEnd(&_stream); }
+
+    bool decode(char const *in, std::size_t nIn, std::size_t &nConsumed, char *out, std::size_t nOut,
+                std::size_t &nProduced) override {
+        _stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(in));
+        _stream.avail_in = static_cast<uInt>(nIn);
+        _stream.next_out = reinterpret_cast<Bytef *>(out);
+        _stream.avail_out = static_cast<uInt>(nOut);
+        int const code = inflate(&_stream, Z_NO_FLUSH);
+        // Z_BUF_ERROR only means that no progress was possible, e.g. more input is needed
+        if (code != Z_OK && code != Z_STREAM_END && code != Z_BUF_ERROR) {
+            throwZlibError("gzip decompression", _stream, code);
+        }
+        nConsumed = nIn - _stream.avail_in;
+        nProduced = nOut - _stream.avail_out;
+        return code == Z_STREAM_END;
+    }
+
+    void reset() override { inflateReset(&_stream); }
+
+private:
+    z_stream _stream;
+};
+
+#endif  // ASTSHIM_HAVE_ZLIB
+
+#ifdef ASTSHIM_HAVE_ZSTD
+
+/// Throw std::runtime_error if `code` is a zstd error code
+void checkZstd(std::string const &what, std::size_t code) {
+    if (ZSTD_isError(code)) {
+        throw std::runtime_error(what + " failed: " + ZSTD_getErrorName(code));
+    }
+}
+
+class ZstdEncoder : public Encoder {
+public:
+    ZstdEncoder(int level, std::size_t bufferSize) : _context(ZSTD_createCCtx()), _buffer(bufferSize) {
+        if (!_context) {
+            throw std::runtime_error("Initializing zstd compression failed");
+        }
+        if (level >= 0) {
+            checkZstd("Setting the zstd compression level",
+                      ZSTD_CCtx_setParameter(_context, ZSTD_c_compressionLevel, level));
+        }
+    }
+
+    ~ZstdEncoder() { ZSTD_freeCCtx(_context); }
+
+    void encode(char const *data, std::size_t size, bool finish, std::ofstream &file) override {
+        ZSTD_inBuffer input = {data, size, 0};
+        std::size_t remaining;
+        do {
+            ZSTD_outBuffer output = {_buffer.data(), _buffer.size(), 0};
+            auto const directive = finish ? ZSTD_e_end : ZSTD_e_continue;
+            remaining = ZSTD_compressStream2(_context, &output, &input, directive);
+            checkZstd("zstd compression", remaining);
+            file.write(_buffer.data(), output.pos);
+        } while (finish ? remaining != 0 : input.pos < input.size);
+    }
+
+private:
+    ZSTD_CCtx *_context;
+    std::vector<char> _buffer;  // compressed data
+};
+
+class ZstdDecoder : public Decoder {
+public:
+    ZstdDecoder() : _context(ZSTD_createDCtx()) {
+        if (!_context) {
+            throw std::runtime_error("Initializing zstd decompression failed");
+        }
+    }
+
+    ~ZstdDecoder() { ZSTD_freeDCtx(_context); }
+
+    bool decode(char const *in, std::size_t nIn, std::size_t &nConsumed, char *out, std::size_t nOut,
+                std::size_t &nProduced) override {
+        ZSTD_inBuffer input = {in, nIn, 0};
+        ZSTD_outBuffer output = {out, nOut, 0};
+        std::size_t const code = ZSTD_decompressStream(_context, &output, &input);
+        checkZstd("zstd decompression", code);
+        nConsumed = input.pos;
+        nProduced = output.pos;
+        return code == 0;
+    }
+
+    void reset() override { ZSTD_DCtx_reset(_context, ZSTD_reset_session_only); }
+
+private:
+    ZSTD_DCtx *_context;
+};
+
+#endif  // ASTSHIM_HAVE_ZSTD
+
+/// Throw std::runtime_error if a compression format is not available
+void assertAvailable(Compression compression) {
+    if (!CompressedFileStream::isAvailable(compression)) {
+        std::string const name = compression == Compression::GZIP ? "gzip" : "zstd";
+        throw std::runtime_error("This build of astshim does not support " + name + " compression");
+    }
+}
+
+std::unique_ptr<Encoder> makeEncoder(Compression compression, int level, std::size_t bufferSize) {
+    assertAvailable(compression);
+    switch (compression) {
+#ifdef ASTSHIM_HAVE_ZLIB
+        case Compression::GZIP:
+            return std::unique_ptr<Encoder>(new GzipEncoder(level, bufferSize));
+#endif
+#ifdef ASTSHIM_HAVE_ZSTD
+        case Compression::ZSTD:
+            return std::unique_ptr<Encoder>(new ZstdEncoder(level, bufferSize));
+#endif
+        default:
+            return std::unique_ptr<Encoder>(new PlainEncoder());
+    }
+}
+
+std::unique_ptr<Decoder> makeDecoder(Compression compression) {
+    assertAvailable(compression);
+    switch (compression) {
+#ifdef ASTSHIM_HAVE_ZLIB
+        case Compression::GZIP:
+            return std::unique_ptr<Decoder>(new GzipDecoder());
+#endif
+#ifdef ASTSHIM_HAVE_ZSTD
+        case Compression::ZSTD:
+            return std::unique_ptr<Decoder>(new ZstdDecoder());
+#endif
+        default:
+            return std::unique_ptr<Decoder>(new PlainDecoder());
+    }
+}
+
+/// Throw std::runtime_error reporting that a file cannot be opened
+[[noreturn]] void throwOpenError(std::string const &path, bool doWrite) {
+    std::ostringstream os;
+    os << "Failed to open file \"" << path << "\" for " << (doWrite ? "writing" : "reading");
+    throw std::runtime_error(os.str());
+}
+
+}  // namespace
+
+namespace detail {
+
+/**
+A std::streambuf that compresses or decompresses a file
+
+Data passes through buffers of fixed size, so the whole file is never held in memory.
+*/
+class CompressedFileBuf : public std::streambuf {
+public:
+    virtual ~CompressedFileBuf() = default;
+
+    /// Finish reading or writing and close the file; see CompressedFileStream::close
+    virtual void close() = 0;
+};
+
+}  // namespace detail
+
+namespace {
+
+/// CompressedFileBuf for writing
+class CompressedWriteBuf : public detail::CompressedFileBuf {
+public:
+    CompressedWriteBuf(std::string const &path, Compression compression, int level, std::size_t bufferSize)
+            : _path(path),
+              _file(path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc),
+              _encoder(),
+              _buffer(bufferSize),
+              _isClosed(false) {
+        if (!_file) {
+            throwOpenError(path, true);
+        }
+        _encoder = makeEncoder(compression, level, bufferSize);
+        setp(_buffer.data(), _buffer.data() + _buffer.size());
+    }
+
+    ~CompressedWriteBuf() {
+        try {
+            close();
+        } catch (std::exception const &) {
+            // destructors must not throw; call close to find out about errors
+        }
+    }
+
+    void close() override {
+        if (_isClosed) {
+            return;
+        }
+        _isClosed = true;
+        std::size_t const nPending = _nPending();
+        setp(nullptr, nullptr);  // reject further writes
+        _encoder->encode(_buffer.data(), nPending, true, _file);
+        _file.close();
+        if (!_file) {
+            throw std::runtime_error("Failed to write file \"" + _path + "\"");
+        }
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (_isClosed) {
+            return traits_type::eof();
+        }
+        try {
+            _encoder->encode(_buffer.data(), _nPending(), false, _file);
+        } catch (std::exception const &) {
+            return traits_type::eof();
+        }
+        if (!_file) {
+            return traits_type::eof();
+        }
+        setp(_buffer.data(), _buffer.data() + _buffer.size());
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    // Channels flush after every line (using std::endl), so do not compress on sync:
+    // that would greatly reduce the compression ratio. Data is compressed when the buffer is full
+    // and when the file is closed.
+    int sync() override { return _isClosed ? -1 : 0; }
+
+private:
+    // number of bytes in _buffer that have not yet been compressed
+    std::size_t _nPending() const { return pptr() - pbase(); }
+
+    std::string _path;
+    std::ofstream _file;
+    std::unique_ptr<Encoder> _encoder;
+    std::vector<char> _buffer;  // uncompressed data
+    bool _isClosed;
+};
+
+/// CompressedFileBuf for reading
+class CompressedReadBuf : public detail::CompressedFileBuf {
+public:
+    CompressedReadBuf(std::string const &path, std::size_t bufferSize)
+            : _path(path),
+              _file(path, std::ios_base::in | std::ios_base::binary),
+              _compression(Compression::NONE),
+              _decoder(),
+              _inBuffer(bufferSize),
+              _inBegin(0),
+              _inEnd(0),
+              _outBuffer(bufferSize),
+              _isInStream(false),
+              _isClosed(false),
+              _error() {
+        if (!_file) {
+            throwOpenError(path, false);
+        }
+        // detect the compression format from the first bytes of the file;
+        // they stay in the input buffer, to be decoded
+        _fill();
+        std::string const start(_inBuffer.data(), _inEnd);
+        if (startsWith(start, GZIP_MAGIC)) {
+            _compression = Compression::GZIP;
+        } else if (startsWith(start, ZSTD_MAGIC)) {
+            _compression = Compression::ZSTD;
+        }
+        _decoder = makeDecoder(_compression);
+        setg(_outBuffer.data(), _outBuffer.data(), _outBuffer.data());
+    }
+
+    ~CompressedReadBuf() {
+        try {
+            close();
+        } catch (std::exception const &) {
+            // destructors must not throw; call close to find out about errors
+        }
+    }
+
+    /// Get the detected compression format
+    Compression getCompression() const { return _compression; }
+
+    void close() override {
+        if (_isClosed) {
+            return;
+        }
+        _isClosed = true;
+        setg(nullptr, nullptr, nullptr);
+        _file.close();
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+    }
+
+protected:
+    int_type underflow() override {
+        if (_isClosed) {
+            return traits_type::eof();
+        }
+        // errors are reported by throwing; std::istream sets badbit and, since CompressedFileStream
+        // sets badbit in its exception mask, rethrows them to Stream::source, which saves them.
+        // Also save them here, so close can report them.
+        try {
+            return _underflow();
+        } catch (...) {
+            _error = std::current_exception();
+            throw;
+        }
+    }
+
+private:
+    // Implement underflow, throwing std::runtime_error if the file cannot be read or decoded
+    int_type _underflow() {
+        while (true) {
+            if (_inBegin == _inEnd) {
+                _fill();
+                if (_inEnd == 0) {
+                    if (_isInStream) {
+                        throw std::runtime_error("File \"" + _path + "\" is truncated");
+                    }
+                    return traits_type::eof();
+                }
+            }
+            std::size_t nConsumed = 0;
+            std::size_t nProduced = 0;
+            bool const isEnd = _decoder->decode(_inBuffer.data() + _inBegin, _inEnd - _inBegin, nConsumed,
+                                                _outBuffer.data(), _outBuffer.size(), nProduced);
+            _inBegin += nConsumed;
+            _isInStream = !isEnd && _compression != Compression::NONE;
+            if (isEnd) {
+                // there may be another compressed stream after this one
+                _decoder->reset();
+            }
+            if (nProduced > 0) {
+                setg(_outBuffer.data(), _outBuffer.data(), _outBuffer.data() + nProduced);
+                return traits_type::to_int_type(*gptr());
+            }
+        }
+    }
+
+    // Read more compressed data into the input buffer, which must be empty
+    void _fill() {
+        _file.read(_inBuffer.data(), _inBuffer.size());
+        _inBegin = 0;
+        _inEnd = _file.gcount();
+        if (_file.bad()) {
+            throw std::runtime_error("Failed to read file \"" + _path + "\"");
+        }
+    }
+
+    std::string _path;
+    std::ifstream _file;
+    Compression _compression;
+    std::unique_ptr<Decoder> _decoder;
+    std::vector<char> _inBuffer;  // compressed data
+    std::size_t _inBegin;         // index of the first byte of _inBuffer not yet decoded
+    std::size_t _inEnd;           // index after the last byte of data in _inBuffer
+    std::vector<char> _outBuffer;  // decompressed data
+    bool _isInStream;             // has decoding started, but not finished, a compressed stream?
+    bool _isClosed;
+    std::exception_ptr _error;  // error thrown by underflow, if any
+};
+
+}  // namespace
+
+std::size_t constexpr CompressedFileStream::DEFAULT_BUFFER_SIZE;
+
+CompressedFileStream::CompressedFileStream(std::string const &path, bool doWrite, Compression compression,
+                                           int level, std::size_t bufferSize)
+        : Stream(), _path(path), _compression(compression), _buf() {
+    if (bufferSize == 0) {
+        throw std::invalid_argument("bufferSize must be positive");
+    }
+    // the streams own the buffer, so it outlives this object if a Channel still uses it
+    if (doWrite) {
+        auto buf = std::make_shared<CompressedWriteBuf>(path, compression, level, bufferSize);
+        _ostreamPtr = std::shared_ptr<std::ostream>(new std::ostream(buf.get()),
+                                                    [buf](std::ostream *stream) { delete stream; });
+        _buf = buf;
+    } else {
+        auto buf = std::make_shared<CompressedReadBuf>(path, bufferSize);
+        _istreamPtr = std::shared_ptr<std::istream>(new std::istream(buf.get()),
+                                                    [buf](std::istream *stream) { delete stream; });
+        // rethrow errors from the buffer, rather than only setting badbit, so Stream::source can report them
+        _istreamPtr->exceptions(std::ios_base::badbit);
+        _compression = buf->getCompression();
+        _buf = buf;
+    }
+}
+
+CompressedFileStream::~CompressedFileStream() {}
+
+void CompressedFileStream::close() {
+    _buf->close();
+}
+
+bool CompressedFileStream::isAvailable(Compression compression) {
+    switch (compression) {
+        case Compression::GZIP:
+            return HAVE_ZLIB;
+        case Compression::ZSTD:
+            return HAVE_ZSTD;
+        default:
+            return true;
+    }
+}
+
+}  // namespace ast
@@ -0,0 +1,235 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "astshim/base.h"
+#include "astshim/detail/utils.h"
+#include "astshim/FactorizedMapping.h"
+#include "astshim/functional.h"
+#include "astshim/Mapping.h"
+#include "astshim/MapSplit.h"
+
+namespace ast {
+namespace {
+
+// Maximum number of splits to try when looking for the smallest group containing a given input;
+// once reached, all remaining inputs are put into one group
+int const MAX_SPLIT_ATTEMPTS = 256;
+
+/*
+Split off the inputs `in` of `mapping`, returning null if that is not possible
+*/
+std::unique_ptr<MapSplit> trySplit(Mapping const &mapping, std::vector<int> const &in) {
+    try {
+        return std::unique_ptr<MapSplit>(new MapSplit(mapping, in));
+    } catch (std::runtime_error const &) {
+        return nullptr;
+    }
+}
+
+/*
+Return the 1-based indices [1, 2, ... n]
+*/
+std::vector<int> makeRange(int n) {
+    std::vector<int> indices(n);
+    std::iota(indices.begin(), indices.end(), 1);
+    return indices;
+}
+
+/*
+Are 1-based axis indices consecutive and increasing?
+*/
+bool isConsecutive(std::vector<int> const &axes) {
+    for (std::size_t i = 1; i < axes.size(); ++i) {
+        if (axes[i] != axes[0] + static_cast<int>(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+Return a view of `nRows` rows of `arr` starting at 1-based row `firstAxis`
+
+`arr` must be contiguous (as Array2D and ConstArray2D are), so the rows are, too.
+*/
+template <typename T>
+ndarray::Array<T, 2, 2> viewRows(ndarray::Array<T, 2, 2> const &arr, int firstAxis, std::size_t nRows) {
+    std::size_t const nPts = arr.template getSize<1>();
+    typename ndarray::Array<T, 2, 2>::Index const shape = ndarray::makeVector(nRows, nPts);
+    typename ndarray::Array<T, 2, 2>::Strides const strides =
+            ndarray::makeVector(static_cast<std::ptrdiff_t>(nPts), static_cast<std::ptrdiff_t>(1));
+    return ndarray::external(arr.getData() + (firstAxis - 1) * nPts, shape, strides, arr);
+}
+
+}  // namespace
+
+std::vector<MapSplit> Mapping::factorize() const {
+    auto const simplifiedMap = simplified();
+    int const nIn = getNIn();
+    int const nOut = getNOut();
+    std::vector<MapSplit> const unsplit = {MapSplit(simplifiedMap, makeRange(nIn), makeRange(nOut))};
+
+    std::vector<MapSplit> factors;
+    std::vector<int> remaining = makeRange(nIn);
+    std::vector<bool> outUsed(nOut, false);
+    int nAttempts = 0;
+    while (!remaining.empty()) {
+        // find the smallest group that contains the first remaining input
+        std::unique_ptr<MapSplit> split;
+        std::vector<int> const others(remaining.begin() + 1, remaining.end());
+        for (std::size_t nOthers = 0; nOthers < others.size() && !split; ++nOthers) {
+            // try each combination of nOthers of the other inputs
+            std::vector<bool> select(others.size(), false);
+            std::fill(select.begin(), select.begin() + nOthers, true);
+            do {
+                if (nAttempts++ >= MAX_SPLIT_ATTEMPTS) {
+                    break;
+                }
+                std::vector<int> in = {remaining[0]};
+                for (std::size_t i = 0; i < others.size(); ++i) {
+                    if (select[i]) {
+                        in.push_back(others[i]);
+                    }
+                }
+                split = trySplit(*simplifiedMap, in);
+            } while (!split && std::prev_permutation(select.begin(), select.end()));
+            if (nAttempts > MAX_SPLIT_ATTEMPTS) {
+                break;
+            }
+        }
+        if (!split) {
+            split = trySplit(*simplifiedMap, remaining);
+        }
+        // the group must feed at least one output, and no output may be fed by more than one group
+        if (!split || split->origOut.empty()) {
+            return unsplit;
+        }
+        for (int out : split->origOut) {
+            if (out < 1 || out > nOut || outUsed[out - 1]) {
+                return unsplit;
+            }
+            outUsed[out - 1] = true;
+        }
+        for (int in : split->origIn) {
+            remaining.erase(std::remove(remaining.begin(), remaining.end(), in), remaining.end());
+        }
+        split->splitMap = split->splitMap->simplified();
+        factors.push_back(std::move(*split));
+    }
+    // outputs fed by no input (e.g. constants set by a PermMap) are only handled by the whole mapping
+    if (std::find(outUsed.begin(), outUsed.end(), false) != outUsed.end()) {
+        return unsplit;
+    }
+    return factors;
+}
+
+FactorizedMapping::FactorizedMapping(Mapping const &mapping)
+        : _nIn(mapping.getNIn()), _nOut(mapping.getNOut()), _factors(mapping.factorize()) {}
+
+int FactorizedMapping::tabulate1DFactors(PointD const &lbnd, PointD const &ubnd, double tol,
+                                         int maxEntries) {
+    detail::assertEqual(lbnd.size(), "lbnd.size", static_cast<std::size_t>(getNIn()), "nIn");
+    detail::assertEqual(ubnd.size(), "ubnd.size", static_cast<std::size_t>(getNIn()), "nIn");
+    if (!(tol > 0)) {
+        throw std::invalid_argument("tol = " + std::to_string(tol) + " must be positive");
+    }
+    int nTabulated = 0;
+    for (auto &factor : _factors) {
+        if (factor.origIn.size() != 1 || factor.origOut.size() != 1) {
+            continue;
+        }
+        int const axis = factor.origIn[0] - 1;
+        try {
+            factor.splitMap = tabulate1D(*factor.splitMap, lbnd[axis], ubnd[axis], tol, maxEntries).lutMap;
+            ++nTabulated;
+        } catch (std::runtime_error const &) {
+            // the group cannot be tabulated to the required accuracy; keep its mapping
+        } catch (std::invalid_argument const &) {
+            // e.g. the range of this axis is empty; keep its mapping
+        }
+    }
+    return nTabulated;
+}
+
+bool FactorizedMapping::hasForward() const {
+    return std::all_of(_factors.begin(), _factors.end(),
+                       [](MapSplit const &factor) { return factor.splitMap->hasForward(); });
+}
+
+bool FactorizedMapping::hasInverse() const {
+    return std::all_of(_factors.begin(), _factors.end(),
+                       [](MapSplit const &factor) { return factor.splitMap->hasInverse(); });
+}
+
+void FactorizedMapping::_tran(ConstArray2D const &from, bool doForward, Array2D const &to) const {
+    int const nFromAxes = doForward ? getNIn() : getNOut();
+    int const nToAxes = doForward ? getNOut() : getNIn();
+    detail::assertEqual(from.getSize<0>(), "from.size[0]", static_cast<std::size_t>(nFromAxes),
+                        "from coords");
+    detail::assertEqual(to.getSize<0>(), "to.size[0]", static_cast<std::size_t>(nToAxes), "to coords");
+    detail::assertEqual(to.getSize<1>(), "to.size[1]", from.getSize<1>(), "from.size[1]");
+    std::size_t const nPts = from.getSize<1>();
+    for (auto const &factor : _factors) {
+        auto const &fromAxes = doForward ? factor.origIn : factor.origOut;
+        auto const &toAxes = doForward ? factor.origOut : factor.origIn;
+
+        // use the input rows in place if possible, else gather them
+        ConstArray2D groupFrom;
+        if (isConsecutive(fromAxes)) {
+            groupFrom = viewRows(from, fromAxes[0], fromAxes.size());
+        } else {
+            Array2D gathered = ndarray::allocate(fromAxes.size(), nPts);
+            for (std::size_t i = 0; i < fromAxes.size(); ++i) {
+                gathered[i] = from[fromAxes[i] - 1];
+            }
+            groupFrom = gathered;
+        }
+
+        // write the output rows in place if possible, else scatter them afterwards
+        bool const scatter = !isConsecutive(toAxes);
+        Array2D groupTo;
+        if (scatter) {
+            groupTo = ndarray::allocate(toAxes.size(), nPts);
+        } else {
+            groupTo = viewRows(to, toAxes[0], toAxes.size());
+        }
+        if (doForward) {
+            factor.splitMap->applyForward(groupFrom, groupTo);
+        } else {
+            factor.splitMap->applyInverse(groupFrom, groupTo);
+        }
+        if (scatter) {
+            for (std::size_t i = 0; i < toAxes.size(); ++i) {
+                to[toAxes[i] - 1] = groupTo[i];
+            }
+        }
+    }
+}
+
+}  // namespace ast
@@ -0,0 +1,360 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "astshim/FitCache.h"
+#include "astshim/Object.h"
+
+namespace ast {
+namespace {
+
+// Identifies (and versions) the format of cache files
+char const MAGIC[8] = {'A', 'S', 'T', 'F', 'I', 'T', '0', '1'};
+
+// Suffix of cache files; temporary files start with TEMP_PREFIX and have no suffix
+std::string const FILE_SUFFIX = ".fit";
+std::string const TEMP_PREFIX = ".tmp.";
+
+// Age (in seconds) after which a temporary file is assumed to be left by a process that died
+std::time_t const STALE_TEMP_AGE = 60 * 60;
+
+// Header of a cache file, followed by the payload
+struct FileHeader {
+    char magic[sizeof(MAGIC)];
+    std::uint64_t keyCheck;      // hash of the key, computed differently from the file name
+    std::uint64_t payloadSize;   // size of the payload, in bytes
+    std::uint64_t payloadCheck;  // hash of the payload
+};
+
+// FNV-1a hash offset bases: the standard one for file names and another for checking keys
+std::uint64_t const NAME_HASH_BASIS = 14695981039346656037ULL;
+std::uint64_t const CHECK_HASH_BASIS = 0x9e3779b97f4a7c15ULL;
+
+std::mutex defaultCacheMutex;
+std::shared_ptr<FitCache> defaultCache;
+bool defaultCacheInitialized = false;
+
+// Counter to make temporary file names unique within this process
+std::atomic<std::uint64_t> tempCounter(0);
+
+/// 64-bit FNV-1a hash of a string of bytes
+std::uint64_t hashBytes(std::string const &data, std::uint64_t basis) {
+    std::uint64_t hash = basis;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/// Create a directory and its parents, if they do not exist
+void makeDirectories(std::string const &path) {
+    for (std::size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1)) {
+        std::string const prefix = path.substr(0, pos);
+        if (!prefix.empty() && ::mkdir(prefix.c_str(), 0777) != 0 && errno != EEXIST) {
+            std::ostringstream os;
+            os << "Cannot create directory " << prefix << ": " << std::strerror(errno);
+            throw std::runtime_error(os.str());
+        }
+        if (pos == std::string::npos) {
+            break;
+        }
+    }
+    struct stat statBuf;
+    if (::stat(path.c_str(), &statBuf) != 0 || !S_ISDIR(statBuf.st_mode)) {
+        throw std::runtime_error("Cannot use " + path + " as a cache directory");
+    }
+}
+
+/// A cache file and the information used to trim the cache
+struct FileInfo {
+    std::string path;
+    std::size_t size;
+    struct timespec mtime;
+};
+
+/// Modification time of a file, with the full resolution of the file system
+struct timespec getMTime(struct stat const &statBuf) {
+#ifdef __APPLE__
+    return statBuf.st_mtimespec;
+#else
+    return statBuf.st_mtim;
+#endif
+}
+
+/// List the cache files in a directory, or the temporary files if `temporary` is true
+std::vector<FileInfo> listFiles(std::string const &directory, bool temporary = false) {
+    std::vector<FileInfo> files;
+    DIR *dir = ::opendir(directory.c_str());
+    if (!dir) {
+        return files;
+    }
+    while (struct dirent *entry = ::readdir(dir)) {
+        std::string const name = entry->d_name;
+        if (temporary) {
+            if (name.compare(0, TEMP_PREFIX.size(), TEMP_PREFIX) != 0) {
+                continue;
+            }
+        } else if (name.size() <= FILE_SUFFIX.size() ||
+                   name.compare(name.size() - FILE_SUFFIX.size(), FILE_SUFFIX.size(), FILE_SUFFIX) != 0) {
+            continue;
+        }
+        std::string const path = directory + "/" + name;
+        struct stat statBuf;
+        // another process may delete the file at any time
+        if (::stat(path.c_str(), &statBuf) == 0) {
+            files.push_back(FileInfo{path, static_cast<std::size_t>(statBuf.st_size), getMTime(statBuf)});
+        }
+    }
+    ::closedir(dir);
+    return files;
+}
+
+/// Return true if file `a` was modified before file `b`
+bool isOlder(FileInfo const &a, FileInfo const &b) {
+    if (a.mtime.tv_sec != b.mtime.tv_sec) {
+        return a.mtime.tv_sec < b.mtime.tv_sec;
+    }
+    return a.mtime.tv_nsec < b.mtime.tv_nsec;
+}
+
+/// Environment variable as a non-negative integer, or 0 if not set
+std::size_t getEnvSize(char const *name) {
+    char const *envValue = std::getenv(name);
+    if (!envValue || envValue[0] == '\0') {
+        return 0;
+    }
+    return static_cast<std::size_t>(std::strtoull(envValue, nullptr, 10));
+}
+
+}  // namespace
+
+std::size_t constexpr FitCache::DEFAULT_MAX_BYTES;
+
+FitCache::FitCache(std::string const &directory, std::size_t maxBytes)
+        : _directory(directory), _maxBytes(maxBytes), _nHits(0), _nMisses(0), _nWrites(0), _nErrors(0) {
+    if (_directory.empty()) {
+        throw std::invalid_argument("directory must not be empty");
+    }
+    makeDirectories(_directory);
+}
+
+std::string FitCache::getOrCompute(std::string const &key, std::function<std::string()> const &compute) {
+    std::string const path = _getPath(key);
+    std::string result;
+    if (_read(path, key, result)) {
+        ++_nHits;
+        // mark the file as recently used, for trim
+        ::utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+        return result;
+    }
+    ++_nMisses;
+    result = compute();
+    try {
+        _write(path, key, result);
+        ++_nWrites;
+        trim();
+    } catch (std::exception const &) {
+        ++_nErrors;
+    }
+    return result;
+}
+
+std::string FitCache::makeKey(std::string const &operation, Object const &object, std::string const &params) {
+    return operation + "\n" + params + "\n" + object.show(false);
+}
+
+std::size_t FitCache::getBytes() const {
+    std::size_t bytes = 0;
+    for (auto const &file : listFiles(_directory)) {
+        bytes += file.size;
+    }
+    return bytes;
+}
+
+void FitCache::trim() {
+    // temporary files this old were left by processes that died while writing them
+    std::time_t const now = std::time(nullptr);
+    for (auto const &file : listFiles(_directory, true)) {
+        if (now - file.mtime.tv_sec > STALE_TEMP_AGE) {
+            ::unlink(file.path.c_str());
+        }
+    }
+
+    auto files = listFiles(_directory);
+    std::size_t bytes = 0;
+    for (auto const &file : files) {
+        bytes += file.size;
+    }
+    if (bytes <= _maxBytes) {
+        return;
+    }
+    std::sort(files.begin(), files.end(), isOlder);
+    for (auto const &file : files) {
+        if (bytes <= _maxBytes) {
+            break;
+        }
+        // ignore failures; another process may have deleted the file
+        ::unlink(file.path.c_str());
+        bytes -= file.size;
+    }
+}
+
+void FitCache::clear() {
+    for (auto const &file : listFiles(_directory)) {
+        ::unlink(file.path.c_str());
+    }
+}
+
+std::string FitCache::_getPath(std::string const &key) const {
+    std::ostringstream os;
+    os << _directory << "/" << std::hex << std::setw(16) << std::setfill('0')
+       << hashBytes(key, NAME_HASH_BASIS) << FILE_SUFFIX;
+    return os.str();
+}
+
+bool FitCache::_read(std::string const &path, std::string const &key, std::string &result) {
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        return false;  // not cached
+    }
+    // measure the file first, so a damaged header cannot make us allocate a huge payload
+    stream.seekg(0, std::ios::end);
+    std::streamoff const fileSize = stream.tellg();
+    stream.seekg(0, std::ios::beg);
+    FileHeader header;
+    bool isValid = fileSize >= static_cast<std::streamoff>(sizeof(header)) &&
+                   static_cast<bool>(stream.read(reinterpret_cast<char *>(&header), sizeof(header))) &&
+                   std::equal(MAGIC, MAGIC + sizeof(MAGIC), header.magic) &&
+                   header.keyCheck == hashBytes(key, CHECK_HASH_BASIS) &&
+                   header.payloadSize == static_cast<std::uint64_t>(fileSize) - sizeof(header);
+    if (isValid) {
+        result.resize(header.payloadSize);
+        isValid = static_cast<bool>(stream.read(&result[0], header.payloadSize)) &&
+                  header.payloadCheck == hashBytes(result, NAME_HASH_BASIS);
+    }
+    if (!isValid) {
+        // a damaged file or (very unlikely) a different key with the same file name; recompute it
+        ++_nErrors;
+        result.clear();
+    }
+    return isValid;
+}
+
+void FitCache::_write(std::string const &path, std::string const &key, std::string const &result) {
+    FileHeader header;
+    std::copy(MAGIC, MAGIC + sizeof(MAGIC), header.magic);
+    header.keyCheck = hashBytes(key, CHECK_HASH_BASIS);
+    header.payloadSize = result.size();
+    header.payloadCheck = hashBytes(result, NAME_HASH_BASIS);
+
+    // write a temporary file and rename it, so other processes never see a partial file
+    std::ostringstream tempPath;
+    tempPath << _directory << "/" << TEMP_PREFIX << ::getpid() << "." << tempCounter++;
+    {
+        std::ofstream stream(tempPath.str(), std::ios::binary | std::ios::trunc);
+        stream.write(reinterpret_cast<char const *>(&header), sizeof(header));
+        stream.write(result.data(), result.size());
+        stream.close();
+        if (!stream) {
+            ::unlink(tempPath.str().c_str());
+            throw std::runtime_error("Cannot write " + tempPath.str());
+        }
+    }
+    if (::rename(tempPath.str().c_str(), path.c_str()) != 0) {
+        ::unlink(tempPath.str().c_str());
+        throw std::runtime_error("Cannot rename " + tempPath.str() + " to " + path);
+    }
+}
+
+std::shared_ptr<FitCache> getDefaultFitCache() {
+    std::lock_guard<std::mutex> lock(defaultCacheMutex);
+    if (!defaultCacheInitialized) {
+        defaultCacheInitialized = true;
+        char const *directory = std::getenv("ASTSHIM_FIT_CACHE");
+        if (directory && directory[0] != '\0') {
+            std::size_t maxBytes = getEnvSize("ASTSHIM_FIT_CACHE_MAX_BYTES");
+            try {
+                if (maxBytes == 0) {
+                    maxBytes = FitCache::DEFAULT_MAX_BYTES;
+                }
+                defaultCache = std::make_shared<FitCache>(directory, maxBytes);
+            } catch (std::exception const &) {
+                // caching is optional, so carry on without it
+            }
+        }
+    }
+    return defaultCache;
+}
+
+void setDefaultFitCache(std::shared_ptr<FitCache> cache) {
+    std::lock_guard<std::mutex> lock(defaultCacheMutex);
+    defaultCacheInitialized = true;
+    defaultCache = cache;
+}
+
+namespace detail {
+
+std::string formatFitParams(std::vector<double> const &values) {
+    std::ostringstream os;
+    os << std::setprecision(17);
+    for (double value : values) {
+        os << value << " ";
+    }
+    return os.str();
+}
+
+std::string packDoubles(std::vector<double> const &values) {
+    return std::string(reinterpret_cast<char const *>(values.data()), values.size() * sizeof(double));
+}
+
+std::vector<double> unpackDoubles(std::string const &bytes) {
+    if (bytes.size() % sizeof(double) != 0) {
+        throw std::runtime_error("Cannot unpack " + std::to_string(bytes.size()) + " bytes as doubles");
+    }
+    std::vector<double> values(bytes.size() / sizeof(double));
+    std::memcpy(values.data(), bytes.data(), bytes.size());
+    return values;
+}
+
+}  // namespace detail
+}  // namespace ast
@@ -29,6 +29,7 @@
 #include "astshim/Object.h"
 #include "astshim/Stream.h"
 #include "astshim/FitsChan.h"
+#include "astshim/Instrumentation.h"
 
 namespace ast {
 
@@ -122,6 +123,7 @@ std::vector<std::string> FitsChan::getAllCardNames() {
 }
 
 FoundValue<std::string> FitsChan::findFits(std::string const &name, bool inc) {
+    detail::OpScope opScope("findFits", *this);
     std::unique_ptr<char[]> fitsbuf(new char[detail::FITSLEN + 1]);
     fitsbuf[0] = '\0';  // in case nothing is found
     bool success = static_cast<bool>(astFindFits(getRawPtr(), name.c_str(), fitsbuf.get(), inc));
@@ -129,6 +131,21 @@ FoundValue<std::string> FitsChan::findFits(std::string const &name, bool inc) {
     return FoundValue<std::string>(success, std::string(fitsbuf.get()));
 }
 
+void FitsChan::putCards(std::string const &cards) {
+    detail::OpScope opScope("putCards", *this);
+    opScope.addBytes(cards.size());
+    astPutCards(getRawPtr(), cards.c_str());
+    assertOK();
+}
+
+void FitsChan::readFits() {
+    detail::OpScope opScope("readFits", *this);
+    auto const nBytesSourced = getNBytesSourced();
+    astReadFits(getRawPtr());
+    opScope.addBytes(getNBytesSourced() - nBytesSourced);
+    assertOK();
+}
+
 FitsKeyState FitsChan::testFits(std::string const &name) const {
     int there;
     int hasvalue = astTestFits(getRawPtr(), cstrOrNull(name), &there);
@@ -25,10 +25,12 @@
 #include "astshim/CmpFrame.h"
 #include "astshim/Frame.h"
 #include "astshim/FrameSet.h"
+#include "astshim/Instrumentation.h"
 
 namespace ast {
 
 std::shared_ptr<FrameSet> Frame::convert(Frame const &to, std::string const &domainlist) {
+    detail::OpScope opScope("convert", *this);
     auto *rawFrameSet =
             reinterpret_cast<AstFrameSet *>(astConvert(getRawPtr(), to.getRawPtr(), domainlist.c_str()));
     assertOK(reinterpret_cast<AstObject *>(rawFrameSet));
@@ -39,6 +41,7 @@ std::shared_ptr<FrameSet> Frame::convert(Frame const &to, std::string const &dom
 }
 
 std::shared_ptr<FrameSet> Frame::findFrame(Frame const &tmplt, std::string const &domainlist) {
+    detail::OpScope opScope("findFrame", *this);
     auto *rawFrameSet =
             reinterpret_cast<AstFrameSet *>(astFindFrame(getRawPtr(), tmplt.getRawPtr(), domainlist.c_str()));
     assertOK(reinterpret_cast<AstObject *>(rawFrameSet));
@@ -0,0 +1,102 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "astshim/FrameSetRouter.h"
+
+namespace ast {
+
+FrameSetRouter::FrameSetRouter(FrameSet const &frameSet, bool simplify,
+                               std::shared_ptr<MappingRegistry> registry)
+        : _frameDict(std::make_shared<FrameDict>(frameSet)),
+          _simplify(simplify),
+          _registry(registry),
+          _mappings(),
+          _nHits(0),
+          _nMisses(0) {}
+
+std::shared_ptr<Mapping const> FrameSetRouter::getMapping(int from, int to) const {
+    auto const key = std::make_pair(_getFrameIndex(from), _getFrameIndex(to));
+    auto it = _mappings.find(key);
+    if (it != _mappings.end()) {
+        ++_nHits;
+        return it->second;
+    }
+    std::shared_ptr<Mapping const> mapping = _frameDict->getMapping(key.first, key.second);
+    if (_simplify) {
+        mapping = mapping->simplified();
+    }
+    if (_registry) {
+        mapping = _registry->intern(*mapping);
+    }
+    _mappings.emplace(key, mapping);
+    ++_nMisses;
+    return mapping;
+}
+
+void FrameSetRouter::precompute(std::vector<std::pair<std::string, std::string>> const &pairs) {
+    for (auto const &item : pairs) {
+        int const from = getIndex(item.first);
+        int const to = getIndex(item.second);
+        if (!isMaterialized(from, to)) {
+            getMapping(from, to);
+        }
+    }
+}
+
+void FrameSetRouter::precomputeAll() {
+    for (int from = 1, nFrame = getNFrame(); from <= nFrame; ++from) {
+        for (int to = 1; to <= nFrame; ++to) {
+            if (from != to && !isMaterialized(from, to)) {
+                getMapping(from, to);
+            }
+        }
+    }
+}
+
+void FrameSetRouter::clear() {
+    _mappings.clear();
+    _nHits = 0;
+    _nMisses = 0;
+}
+
+int FrameSetRouter::_getFrameIndex(int index) const {
+    if (index == FrameSet::BASE) {
+        return _frameDict->getBase();
+    } else if (index == FrameSet::CURRENT) {
+        return _frameDict->getCurrent();
+    }
+    int const nFrame = getNFrame();
+    if (index < 1 || index > nFrame) {
+        std::ostringstream os;
+        os << "Frame index " << index << " not in range [1, " << nFrame << "]";
+        throw std::out_of_range(os.str());
+    }
+    return index;
+}
+
+}  // namespace ast
@@ -0,0 +1,590 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <algorithm>
+#include <cctype>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include "astshim/base.h"
+#include "astshim/detail/utils.h"
+#include "astshim/Instrumentation.h"
+#include "astshim/Object.h"
+
+namespace ast {
+namespace detail {
+
+/// Counters for one combination of operation, class name and ident
+struct OpCounters {
+    std::atomic<std::uint64_t> calls{0};
+    std::atomic<std::uint64_t> points{0};
+    std::atomic<std::uint64_t> nanoseconds{0};
+    std::atomic<std::uint64_t> bytes{0};
+};
+
+}  // namespace detail
+
+namespace {
+
+unsigned int const INSTRUMENT_FLAG = 1;
+unsigned int const TRACE_FLAG = 2;
+
+using OpKey = std::tuple<std::string, std::string, std::string>;  // operation, class name, ident
+
+bool envIsSet(char const *name) {
+    char const *envValue = std::getenv(name);
+    return envValue && envValue[0] != '\0' && std::string(envValue) != "0";
+}
+
+/// Bitwise OR of INSTRUMENT_FLAG and TRACE_FLAG; a single word so disabled OpScopes need only one load
+std::atomic<unsigned int> &activeFlags() {
+    static std::atomic<unsigned int> flags((envIsSet("ASTSHIM_INSTRUMENT") ? INSTRUMENT_FLAG : 0) |
+                                           (envIsSet("ASTSHIM_TRACE") ? TRACE_FLAG : 0));
+    return flags;
+}
+
+/// Incremented when instrumentation is enabled, since objects are not tracked while it is disabled
+std::atomic<std::uint32_t> cacheGeneration(0);
+
+/// Number of slots in objectVersions; must be a power of 2
+std::size_t const N_OBJECT_SLOTS = 4096;
+
+/**
+Version of the cached names of the objects whose pointers map to each slot (see objectSlot)
+
+A slot's version is incremented when one of its objects is freed or may have had its ident changed,
+which invalidates the cache entries for the objects in that slot, but no others.
+Static storage, so the versions start at zero.
+*/
+std::atomic<std::uint32_t> objectVersions[N_OBJECT_SLOTS];
+
+std::atomic<std::uint32_t> &objectVersion(AstObject const *rawPtr) {
+    // objects are allocated on (at least) 16-byte boundaries
+    return objectVersions[(reinterpret_cast<std::uintptr_t>(rawPtr) >> 4) & (N_OBJECT_SLOTS - 1)];
+}
+
+/// Return a stamp that changes whenever the cached names of an object may no longer be valid
+std::uint64_t getCacheStamp(AstObject const *rawPtr) {
+    return (static_cast<std::uint64_t>(cacheGeneration.load(std::memory_order_relaxed)) << 32) |
+           objectVersion(rawPtr).load(std::memory_order_relaxed);
+}
+
+/// Return true if `attribs` (an attribute name or list of settings) may refer to Ident
+bool mentionsIdent(std::string const &attribs) {
+    static std::string const IDENT = "ident";
+    return std::search(attribs.begin(), attribs.end(), IDENT.begin(), IDENT.end(), [](char a, char b) {
+               return std::tolower(static_cast<unsigned char>(a)) == b;
+           }) != attribs.end();
+}
+
+bool setFlag(unsigned int flag, int enable) {
+    if (enable < 0) {
+        return activeFlags().load() & flag;
+    }
+    unsigned int oldFlags;
+    if (enable > 0) {
+        oldFlags = activeFlags().fetch_or(flag);
+        // objects are not tracked while disabled (see detail::noteObjectChange), so forget the cache
+        if ((flag & INSTRUMENT_FLAG) && !(oldFlags & INSTRUMENT_FLAG)) {
+            cacheGeneration.fetch_add(1, std::memory_order_relaxed);
+        }
+    } else {
+        oldFlags = activeFlags().fetch_and(~flag);
+    }
+    return oldFlags & flag;
+}
+
+/// Get the class name and ident of an object; return false (and clear the AST status) on error
+bool getNames(AstObject const *rawPtr, std::string &className, std::string &ident) {
+    className = detail::getClassName(rawPtr);
+    char const *rawIdent = astGetC(rawPtr, "Ident");
+    ident = rawIdent ? rawIdent : "";
+    if (!astOK) {
+        astClearStatus;
+        return false;
+    }
+    return true;
+}
+
+/**
+Registry of counters
+
+Entries are never removed (resetting zeros the counters instead),
+so pointers to counters remain valid for the life of the process.
+*/
+class Registry {
+public:
+    static Registry &get() {
+        // never destroyed, so OpScopes may safely outlive static destruction
+        static Registry *registry = new Registry();
+        return *registry;
+    }
+
+    detail::OpCounters *getCounters(OpKey const &key) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto &counters = _counters[key];
+        if (!counters) {
+            counters.reset(new detail::OpCounters());
+        }
+        return counters.get();
+    }
+
+    std::vector<OpStats> getStats() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<OpStats> statsList;
+        statsList.reserve(_counters.size());
+        for (auto const &item : _counters) {
+            OpStats stats;
+            std::tie(stats.operation, stats.className, stats.ident) = item.first;
+            stats.calls = item.second->calls.load(std::memory_order_relaxed);
+            stats.points = item.second->points.load(std::memory_order_relaxed);
+            stats.nanoseconds = item.second->nanoseconds.load(std::memory_order_relaxed);
+            stats.bytes = item.second->bytes.load(std::memory_order_relaxed);
+            if (stats.calls > 0) {
+                statsList.push_back(stats);
+            }
+        }
+        return statsList;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto &item : _counters) {
+            item.second->calls.store(0, std::memory_order_relaxed);
+            item.second->points.store(0, std::memory_order_relaxed);
+            item.second->nanoseconds.store(0, std::memory_order_relaxed);
+            item.second->bytes.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    Registry() = default;
+
+    std::mutex _mutex;
+    std::map<OpKey, std::unique_ptr<detail::OpCounters>> _counters;
+};
+
+/**
+Per-thread cache of the counters for each operation and object
+
+Finding counters by operation, class name and ident needs two AST attribute lookups, a string key
+and the registry's mutex, which would cost more than a small transform. So each thread remembers
+the counters for the operations and objects (by AST pointer) it has recently used, in a small
+direct-mapped table, and the counters for each key it has ever used, so the registry is only consulted
+the first time a thread sees a key. Table entries are valid while the cache stamp of their object
+is unchanged (see getCacheStamp): until the object is freed or may have had its ident changed,
+or instrumentation is enabled again.
+*/
+class CounterCache {
+public:
+    static CounterCache &get() {
+        thread_local CounterCache cache;
+        return cache;
+    }
+
+    /**
+    Find the counters for an operation on an object in the table
+
+    @param[in] operation, rawPtr  Operation and object
+    @param[out] stamp  Cache stamp of the object, to pass to insert if not found
+    @return the counters, or null if not found
+    */
+    detail::OpCounters *find(char const *operation, AstObject const *rawPtr, std::uint64_t &stamp) {
+        stamp = getCacheStamp(rawPtr);
+        Entry const &entry = _entries[_index(operation, rawPtr)];
+        if (entry.operation == operation && entry.rawPtr == rawPtr && entry.stamp == stamp) {
+            return entry.counters;
+        }
+        return nullptr;
+    }
+
+    /// Get the counters for a key and save them in the table for an operation on an object
+    detail::OpCounters *insert(char const *operation, AstObject const *rawPtr, std::uint64_t stamp,
+                               OpKey const &key) {
+        auto &counters = _countersByKey[key];
+        if (!counters) {
+            counters = Registry::get().getCounters(key);
+        }
+        _entries[_index(operation, rawPtr)] = {operation, rawPtr, stamp, counters};
+        return counters;
+    }
+
+private:
+    static std::size_t const TABLE_SIZE = 64;  // must be a power of 2
+
+    struct Entry {
+        char const *operation;
+        AstObject const *rawPtr;
+        std::uint64_t stamp;
+        detail::OpCounters *counters;
+    };
+
+    CounterCache() : _entries(), _countersByKey() {}
+
+    static std::size_t _index(char const *operation, AstObject const *rawPtr) {
+        // objects are allocated on (at least) 16-byte boundaries; operations are string literals
+        auto const hash = (reinterpret_cast<std::uintptr_t>(rawPtr) >> 4) ^
+                          (reinterpret_cast<std::uintptr_t>(operation) >> 3);
+        return hash & (TABLE_SIZE - 1);
+    }
+
+    Entry _entries[TABLE_SIZE];
+    std::map<OpKey, detail::OpCounters *> _countersByKey;
+};
+
+/// One recorded trace event; plain data so it can be copied into and out of a ring buffer slot
+struct TraceEvent {
+    static std::size_t const NAME_LEN = 40;
+
+    char const *operation;  // always a string literal
+    char className[NAME_LEN];
+    char ident[NAME_LEN];
+    std::int64_t startNs;
+    std::int64_t durationNs;
+    std::uint64_t points;
+    std::uint64_t bytes;
+    int nIn;
+    int nOut;
+    double tol;
+};
+
+/// Copy a string into a fixed-length buffer, truncating if necessary
+void copyName(std::string const &str, char *buffer) {
+    auto const len = std::min(str.size(), TraceEvent::NAME_LEN - 1);
+    std::memcpy(buffer, str.data(), len);
+    buffer[len] = '\0';
+}
+
+/**
+Fixed-size ring buffer of trace events written by a single thread
+
+Writing is lock-free. Each slot is protected by a sequence number (a seqlock)
+so that a reader can detect and skip a slot that is overwritten while it is being copied.
+*/
+class TraceBuffer {
+public:
+    static std::uint64_t const CAPACITY = 16384;
+
+    explicit TraceBuffer(long threadId) : _threadId(threadId), _slots(new Slot[CAPACITY]), _next(0), _begin(0) {}
+
+    long getThreadId() const { return _threadId; }
+
+    /// Save an event; must only be called by the owning thread
+    void push(TraceEvent const &event) {
+        std::uint64_t const n = _next.load(std::memory_order_relaxed);
+        Slot &slot = _slots[n % CAPACITY];
+        slot.seq.store(2 * n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.event = event;
+        slot.seq.store(2 * n + 2, std::memory_order_release);
+        _next.store(n + 1, std::memory_order_release);
+    }
+
+    /// Append a copy of all retained events to `events`; may be called from any thread
+    void copyEvents(std::vector<TraceEvent> &events) const {
+        std::uint64_t const end = _next.load(std::memory_order_acquire);
+        std::uint64_t const begin = std::max(_begin.load(std::memory_order_relaxed),
+                                             end > CAPACITY ? end - CAPACITY : 0);
+        for (std::uint64_t n = begin; n < end; ++n) {
+            Slot const &slot = _slots[n % CAPACITY];
+            std::uint64_t const seq1 = slot.seq.load(std::memory_order_acquire);
+            TraceEvent event = slot.event;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            std::uint64_t const seq2 = slot.seq.load(std::memory_order_relaxed);
+            if ((seq1 == 2 * n + 2) && (seq1 == seq2)) {
+                events.push_back(event);
+            }
+        }
+    }
+
+    /// Discard all events recorded so far; may be called from any thread
+    void clear() { _begin.store(_next.load(std::memory_order_acquire), std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> seq{0};
+        TraceEvent event;
+    };
+
+    long const _threadId;
+    std::unique_ptr<Slot[]> _slots;
+    std::atomic<std::uint64_t> _next;   // index of the next event to be written
+    std::atomic<std::uint64_t> _begin;  // index of the first event not cleared
+};
+
+long getThreadId() {
+#ifdef __linux__
+    return static_cast<long>(syscall(SYS_gettid));
+#else
+    static std::atomic<long> nextId(1);
+    return nextId++;
+#endif
+}
+
+/// All trace buffers; buffers are retained after their thread exits so their events can be exported
+class TraceRegistry {
+public:
+    static TraceRegistry &get() {
+        static TraceRegistry *registry = new TraceRegistry();
+        return *registry;
+    }
+
+    /// Get the trace buffer for the calling thread, creating it if necessary
+    TraceBuffer &getBuffer() {
+        thread_local std::shared_ptr<TraceBuffer> buffer;
+        if (!buffer) {
+            buffer = std::make_shared<TraceBuffer>(getThreadId());
+            std::lock_guard<std::mutex> lock(_mutex);
+            _buffers.push_back(buffer);
+        }
+        return *buffer;
+    }
+
+    std::vector<std::pair<long, std::vector<TraceEvent>>> getEvents() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<std::pair<long, std::vector<TraceEvent>>> eventsList;
+        for (auto const &buffer : _buffers) {
+            std::vector<TraceEvent> events;
+            buffer->copyEvents(events);
+            eventsList.emplace_back(buffer->getThreadId(), std::move(events));
+        }
+        return eventsList;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto const &buffer : _buffers) {
+            buffer->clear();
+        }
+    }
+
+private:
+    TraceRegistry() = default;
+
+    std::mutex _mutex;
+    std::vector<std::shared_ptr<TraceBuffer>> _buffers;
+};
+
+/// Write a string as a JSON string literal
+void writeJsonString(std::ostream &os, char const *str) {
+    os << '"';
+    for (char const *p = str; *p != '\0'; ++p) {
+        unsigned char const c = *p;
+        if (c == '"' || c == '\\') {
+            os << '\\' << *p;
+        } else if (c < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            os << buf;
+        } else {
+            os << *p;
+        }
+    }
+    os << '"';
+}
+
+void writeTraceJson(std::ostream &os) {
+    auto const pid = static_cast<long>(getpid());
+    os.precision(std::numeric_limits<double>::max_digits10);
+    os << "{\"traceEvents\":[";
+    bool first = true;
+    for (auto const &threadEvents : TraceRegistry::get().getEvents()) {
+        for (auto const &event : threadEvents.second) {
+            os << (first ? "\n" : ",\n");
+            first = false;
+            os << "{\"name\":";
+            writeJsonString(os, event.operation);
+            os << ",\"cat\":\"astshim\",\"ph\":\"X\",\"ts\":" << event.startNs / 1000.0
+               << ",\"dur\":" << event.durationNs / 1000.0 << ",\"pid\":" << pid
+               << ",\"tid\":" << threadEvents.first << ",\"args\":{\"className\":";
+            writeJsonString(os, event.className);
+            if (event.ident[0] != '\0') {
+                os << ",\"ident\":";
+                writeJsonString(os, event.ident);
+            }
+            if (event.points > 0) {
+                os << ",\"nPts\":" << event.points;
+            }
+            if (event.nIn > 0) {
+                os << ",\"nIn\":" << event.nIn << ",\"nOut\":" << event.nOut;
+            }
+            if (!std::isnan(event.tol)) {
+                os << ",\"tol\":" << event.tol;
+            }
+            if (event.bytes > 0) {
+                os << ",\"bytes\":" << event.bytes;
+            }
+            os << "}}";
+        }
+    }
+    os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+}  // namespace
+
+bool instrumentation(int enable) { return setFlag(INSTRUMENT_FLAG, enable); }
+
+std::vector<OpStats> getInstrumentationStats() { return Registry::get().getStats(); }
+
+void resetInstrumentationStats() { Registry::get().reset(); }
+
+bool tracing(int enable) { return setFlag(TRACE_FLAG, enable); }
+
+std::string getTraceJson() {
+    std::ostringstream os;
+    writeTraceJson(os);
+    return os.str();
+}
+
+void writeTrace(std::string const &path) {
+    std::ofstream os(path);
+    if (!os) {
+        throw std::runtime_error("Failed to open file \"" + path + "\" for writing");
+    }
+    writeTraceJson(os);
+    os.close();
+    if (!os) {
+        throw std::runtime_error("Failed to write trace to file \"" + path + "\"");
+    }
+}
+
+void clearTrace() { TraceRegistry::get().clear(); }
+
+namespace detail {
+
+OpScope::OpScope(char const *operation, Object const &object, std::uint64_t nPoints)
+        : _flags(activeFlags().load(std::memory_order_relaxed)),
+          _operation(operation),
+          _counters(nullptr),
+          _className(),
+          _ident(),
+          _start(),
+          _points(nPoints),
+          _bytes(0),
+          _nIn(0),
+          _nOut(0),
+          _tol(std::numeric_limits<double>::quiet_NaN()) {
+    if (_flags == 0) {
+        return;
+    }
+    // Do not touch the object if AST status is already bad; the operation will report the error
+    if (!astOK) {
+        _flags = 0;
+        return;
+    }
+    auto rawPtr = object.getRawPtr();
+    std::uint64_t stamp = 0;
+    if (_flags & INSTRUMENT_FLAG) {
+        _counters = CounterCache::get().find(operation, rawPtr, stamp);
+    }
+    // the class name and ident are only needed when tracing or when the counters are not cached
+    if (!_counters || (_flags & TRACE_FLAG)) {
+        std::string className;
+        std::string ident;
+        if (!getNames(rawPtr, className, ident)) {
+            _flags = 0;
+            _counters = nullptr;
+            return;
+        }
+        if ((_flags & INSTRUMENT_FLAG) && !_counters) {
+            _counters = CounterCache::get().insert(operation, rawPtr, stamp,
+                                                   OpKey(operation, className, ident));
+        }
+        if (_flags & TRACE_FLAG) {
+            _className = std::move(className);
+            _ident = std::move(ident);
+        }
+    }
+    _start = std::chrono::steady_clock::now();
+}
+
+void noteAttributeChange(AstObject const *rawPtr, std::string const &attribs) {
+    if ((activeFlags().load(std::memory_order_relaxed) & INSTRUMENT_FLAG) && mentionsIdent(attribs)) {
+        objectVersion(rawPtr).fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void noteObjectAnnul(AstObject const *rawPtr) {
+    if (!(activeFlags().load(std::memory_order_relaxed) & INSTRUMENT_FLAG)) {
+        return;
+    }
+    // only a pointer that is freed can be reused by another object; if in doubt, assume it is freed
+    if (astOK) {
+        int const refCount = astGetI(rawPtr, "RefCount");
+        if (!astOK) {
+            astClearStatus;
+        } else if (refCount > 1) {
+            return;
+        }
+    }
+    objectVersion(rawPtr).fetch_add(1, std::memory_order_relaxed);
+}
+
+OpScope::~OpScope() {
+    if (_flags == 0) {
+        return;
+    }
+    auto const end = std::chrono::steady_clock::now();
+    auto const elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - _start).count();
+    if (_counters) {
+        _counters->calls.fetch_add(1, std::memory_order_relaxed);
+        _counters->points.fetch_add(_points, std::memory_order_relaxed);
+        _counters->nanoseconds.fetch_add(elapsedNs, std::memory_order_relaxed);
+        _counters->bytes.fetch_add(_bytes, std::memory_order_relaxed);
+    }
+    if (_flags & TRACE_FLAG) {
+        TraceEvent event;
+        event.operation = _operation;
+        copyName(_className, event.className);
+        copyName(_ident, event.ident);
+        event.startNs =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(_start.time_since_epoch()).count();
+        event.durationNs = elapsedNs;
+        event.points = _points;
+        event.bytes = _bytes;
+        event.nIn = _nIn;
+        event.nOut = _nOut;
+        event.tol = _tol;
+        TraceRegistry::get().getBuffer().push(event);
+    }
+}
+
+}  // namespace detail
+}  // namespace ast
@@ -26,6 +26,7 @@
 
 #include "astshim/base.h"
 #include "astshim/detail/utils.h"
+#include "astshim/Instrumentation.h"
 #include "astshim/MapBox.h"
 #include "astshim/Mapping.h"
 
@@ -64,6 +65,7 @@ void MapBox::_compute(Mapping const& map, std::vector<double> const& lbnd, std::
         throw std::invalid_argument(os.str());
     }
     int const npoints = 1 + maxOutCoord - minOutCoord;
+    detail::OpScope opScope("mapBox", map);
     lbndOut.reserve(npoints);
     ubndOut.reserve(npoints);
     xl = ndarray::allocate(ndarray::makeVector(npoints, nout));
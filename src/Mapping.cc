@@ -19,20 +19,40 @@
  * the GNU General Public License along with this program.  If not,
  * see <https://www.lsstcorp.org/LegalNotices/>.
  */
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <memory>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 
 #include "astshim/base.h"
+#include "astshim/detail/threadUtils.h"
 #include "astshim/detail/utils.h"
+#include "astshim/FitCache.h"
 #include "astshim/Frame.h"
+#include "astshim/Instrumentation.h"
 #include "astshim/Mapping.h"
 #include "astshim/ParallelMap.h"
 #include "astshim/SeriesMap.h"
+#include "astshim/TransformWorkspace.h"
 
 namespace ast {
+namespace {
+
+// Maximum number of points an asynchronous transform processes between checks for cancellation
+std::size_t const ASYNC_CHUNK = 1 << 16;
+
+// Number of points of float arrays converted to double at a time; small enough that the double
+// copies of a block stay in cache, and large enough that the per-call overhead of AST is negligible
+std::size_t const FLOAT_BLOCK_SIZE = 1024;
+
+// Maximum number of points passed to AST at a time by Mapping::_tranRange, so that the points are
+// still in cache when AST__BAD is replaced with NaN (a few axes of 4096 doubles fit in L2)
+std::size_t const TRAN_PIECE_SIZE = 4096;
+
+}  // namespace
 
 SeriesMap Mapping::then(Mapping const &next) const { return SeriesMap(*this, next); }
 
@@ -52,14 +72,43 @@ Array2D Mapping::linearApprox(PointD const &lbnd, PointD const &ubnd, double tol
     detail::assertEqual(lbnd.size(), "lbnd.size", static_cast<std::size_t>(nIn), "nIn");
     detail::assertEqual(ubnd.size(), "ubnd.size", static_cast<std::size_t>(nIn), "nIn");
     Array2D fit = ndarray::allocate(ndarray::makeVector(1 + nIn, nOut));
-    int isOK = astLinearApprox(getRawPtr(), lbnd.data(), ubnd.data(), tol, fit.getData());
-    assertOK();
-    if (!isOK) {
-        throw std::runtime_error("Mapping not sufficiently linear");
+    auto const nValues = static_cast<std::size_t>(fit.getNumElements());
+    auto computeFit = [&]() {
+        detail::OpScope opScope("linearApprox", *this);
+        opScope.setAxes(nIn, nOut);
+        opScope.setTol(tol);
+        std::vector<double> values(nValues);
+        int isOK = astLinearApprox(getRawPtr(), lbnd.data(), ubnd.data(), tol, values.data());
+        assertOK();
+        if (!isOK) {
+            throw std::runtime_error("Mapping not sufficiently linear");
+        }
+        return values;
+    };
+    std::vector<double> values;
+    auto cache = getDefaultFitCache();
+    if (cache) {
+        std::vector<double> params = {tol};
+        params.insert(params.end(), lbnd.begin(), lbnd.end());
+        params.insert(params.end(), ubnd.begin(), ubnd.end());
+        std::string const key = FitCache::makeKey("linearApprox", *this, detail::formatFitParams(params));
+        values = detail::unpackDoubles(
+                cache->getOrCompute(key, [&]() { return detail::packDoubles(computeFit()); }));
     }
+    if (values.size() != nValues) {
+        values = computeFit();
+    }
+    std::copy(values.begin(), values.end(), fit.getData());
     return fit;
 }
 
+std::shared_ptr<Mapping> Mapping::simplified() const {
+    detail::OpScope opScope("simplified", *this);
+    AstObject *rawSimpMap = reinterpret_cast<AstObject *>(astSimplify(getRawPtr()));
+    assertOK(rawSimpMap);
+    return Object::fromAstObject<Mapping>(rawSimpMap, true);
+}
+
 template <typename Class>
 std::shared_ptr<Class> Mapping::decompose(int i, bool copy) const {
     if ((i < 0) || (i > 1)) {
@@ -109,21 +158,190 @@ std::shared_ptr<Class> Mapping::decompose(int i, bool copy) const {
     return Object::fromAstObject<Class>(reinterpret_cast<AstObject *>(retRawMap), copy);
 }
 
-void Mapping::_tran(ConstArray2D const &from, bool doForward, Array2D const &to) const {
+void Mapping::_tran(ConstArray2D const &from, bool doForward, Array2D const &to, bool nanInputIsBad) const {
     int const nFromAxes = doForward ? getNIn() : getNOut();
     int const nToAxes = doForward ? getNOut() : getNIn();
     detail::assertEqual(from.getSize<0>(), "from.size[0]", static_cast<std::size_t>(nFromAxes),
                         "from coords");
     detail::assertEqual(to.getSize<0>(), "to.size[0]", static_cast<std::size_t>(nToAxes), "to coords");
     detail::assertEqual(from.getSize<1>(), "from.size[1]", to.getSize<1>(), "to.size[1]");
-    int const nPts = from.getSize<1>();
-    // astTranN treats 0 points as an error and the call isn't needed anyway
-    if (nPts > 0) {
-        astTranN(getRawPtr(), nPts, nFromAxes, nPts, from.getData(), static_cast<int>(doForward), nToAxes, nPts,
-                 to.getData());
+    std::size_t const nPts = from.getSize<1>();
+    detail::OpScope opScope(doForward ? "tranForward" : "tranInverse", *this, nPts);
+    opScope.setAxes(nFromAxes, nToAxes);
+    _tranRange(from, doForward, to, 0, nPts, nanInputIsBad);
+}
+
+void Mapping::_tranFloat(ConstFloatArray2D const &from, bool doForward, FloatArray2D const &to) const {
+    int const nFromAxes = doForward ? getNIn() : getNOut();
+    int const nToAxes = doForward ? getNOut() : getNIn();
+    detail::assertEqual(from.getSize<0>(), "from.size[0]", static_cast<std::size_t>(nFromAxes),
+                        "from coords");
+    detail::assertEqual(to.getSize<0>(), "to.size[0]", static_cast<std::size_t>(nToAxes), "to coords");
+    detail::assertEqual(from.getSize<1>(), "from.size[1]", to.getSize<1>(), "to.size[1]");
+    std::size_t const nPts = from.getSize<1>();
+    detail::OpScope opScope(doForward ? "tranForward" : "tranInverse", *this, nPts);
+    opScope.setAxes(nFromAxes, nToAxes);
+    if (nPts == 0) {
+        return;
     }
-    assertOK();
-    detail::astBadToNan(to);
+    std::size_t const blockSize = std::min(nPts, FLOAT_BLOCK_SIZE);
+    Array2D fromBlock = ndarray::allocate(nFromAxes, blockSize);
+    Array2D toBlock = ndarray::allocate(nToAxes, blockSize);
+    for (std::size_t begin = 0; begin < nPts; begin += blockSize) {
+        std::size_t const nBlockPts = std::min(blockSize, nPts - begin);
+        for (int axis = 0; axis < nFromAxes; ++axis) {
+            float const *fromPtr = from.getData() + axis * nPts + begin;
+            std::copy(fromPtr, fromPtr + nBlockPts, fromBlock.getData() + axis * blockSize);
+        }
+        // _tranRange replaces AST__BAD with NaN, which converts to float NaN
+        _tranRange(fromBlock, doForward, toBlock, 0, nBlockPts);
+        for (int axis = 0; axis < nToAxes; ++axis) {
+            double const *toBlockPtr = toBlock.getData() + axis * blockSize;
+            std::copy(toBlockPtr, toBlockPtr + nBlockPts, to.getData() + axis * nPts + begin);
+        }
+    }
+}
+
+void Mapping::_tranRange(ConstArray2D const &from, bool doForward, Array2D const &to, std::size_t begin,
+                         std::size_t end, bool nanInputIsBad) const {
+    // the row length (nPts) may not fit in an int, so describe each piece with one pointer per axis
+    std::size_t const nPts = from.getSize<1>();
+    int const nFromAxes = from.getSize<0>();
+    int const nToAxes = to.getSize<0>();
+    std::size_t const pieceSize = std::min(TRAN_PIECE_SIZE, detail::getMaxTranChunk());
+    std::vector<double> fromPiece(nanInputIsBad ? nFromAxes * std::min(pieceSize, end - begin) : 0);
+    std::vector<double const *> fromPtrs(nFromAxes);
+    std::vector<double *> toPtrs(nToAxes);
+    for (std::size_t pieceBegin = begin; pieceBegin < end; pieceBegin += pieceSize) {
+        std::size_t const nPiecePts = std::min(pieceSize, end - pieceBegin);
+        for (int axis = 0; axis < nFromAxes; ++axis) {
+            double const *fromPtr = from.getData() + axis * nPts + pieceBegin;
+            if (nanInputIsBad) {
+                double *fromPieceAxis = fromPiece.data() + axis * nPiecePts;
+                detail::nanToAstBad(fromPtr, nPiecePts, fromPieceAxis);
+                fromPtr = fromPieceAxis;
+            }
+            fromPtrs[axis] = fromPtr;
+        }
+        for (int axis = 0; axis < nToAxes; ++axis) {
+            toPtrs[axis] = to.getData() + axis * nPts + pieceBegin;
+        }
+        astTranP(getRawPtr(), static_cast<int>(nPiecePts), nFromAxes, fromPtrs.data(),
+                 static_cast<int>(doForward), nToAxes, toPtrs.data());
+        assertOK();
+        // convert while the piece is still in cache
+        for (int axis = 0; axis < nToAxes; ++axis) {
+            detail::astBadToNan(toPtrs[axis], nPiecePts);
+        }
+    }
+}
+
+void Mapping::_tranInPlace(Array2D const &data, bool doForward, TransformWorkspace *workspace) const {
+    if (getNIn() != getNOut()) {
+        std::ostringstream os;
+        os << "Cannot transform in place because nIn=" << getNIn() << " != nOut=" << getNOut();
+        throw std::invalid_argument(os.str());
+    }
+    std::size_t const nPts = data.getSize<1>();
+    Array2D scratch;
+    if (workspace) {
+        workspace->assertCompatible(*this);
+        scratch = workspace->getOutput(nPts, doForward);
+    } else {
+        scratch = ndarray::allocate(data.getSize<0>(), nPts);
+    }
+    _tran(data, doForward, scratch, workspace && workspace->getNanInputIsBad());
+    data.deep() = scratch;
+}
+
+Array2D Mapping::applyForward(ConstArray2D const &from, TransformWorkspace &workspace) const {
+    workspace.assertCompatible(*this);
+    Array2D to = workspace.getOutput(from.getSize<1>(), true);
+    _tran(from, true, to, workspace.getNanInputIsBad());
+    return to;
+}
+
+Array2D Mapping::applyInverse(ConstArray2D const &from, TransformWorkspace &workspace) const {
+    workspace.assertCompatible(*this);
+    Array2D to = workspace.getOutput(from.getSize<1>(), false);
+    _tran(from, false, to, workspace.getNanInputIsBad());
+    return to;
+}
+
+void Mapping::applyForwardInPlace(Array2D const &data) const { _tranInPlace(data, true, nullptr); }
+
+void Mapping::applyForwardInPlace(Array2D const &data, TransformWorkspace &workspace) const {
+    _tranInPlace(data, true, &workspace);
+}
+
+void Mapping::applyInverseInPlace(Array2D const &data) const { _tranInPlace(data, false, nullptr); }
+
+void Mapping::applyInverseInPlace(Array2D const &data, TransformWorkspace &workspace) const {
+    _tranInPlace(data, false, &workspace);
+}
+
+std::function<Array2D()> Mapping::_makeTranTask(ConstArray2D const &from, bool doForward,
+                                                CancellationToken const &token) const {
+    int const nFromAxes = doForward ? getNIn() : getNOut();
+    int const nToAxes = doForward ? getNOut() : getNIn();
+    detail::assertEqual(from.getSize<0>(), "from.size[0]", static_cast<std::size_t>(nFromAxes),
+                        "from coords");
+    std::size_t const nPts = from.getSize<1>();
+    Array2D to = ndarray::allocate(nToAxes, nPts);
+    auto mapping = std::make_shared<detail::MappingForThread>(*this);
+    return [mapping, from, to, doForward, token]() -> Array2D {
+        detail::MappingForThread::Lock lock(*mapping);
+        Mapping &threadMapping = lock.get();
+        token.throwIfCancelled();
+        std::size_t const nPts = from.getSize<1>();
+        detail::OpScope opScope(doForward ? "tranForward" : "tranInverse", threadMapping, nPts);
+        opScope.setAxes(from.getSize<0>(), to.getSize<0>());
+        std::size_t const chunkSize = std::min(ASYNC_CHUNK, detail::getMaxTranChunk());
+        for (std::size_t begin = 0; begin < nPts; begin += chunkSize) {
+            token.throwIfCancelled();
+            threadMapping._tranRange(from, doForward, to, begin, std::min(begin + chunkSize, nPts));
+        }
+        return to;
+    };
+}
+
+std::function<Array2D()> Mapping::_makeTranGridTask(PointI const &lbnd, PointI const &ubnd, double tol,
+                                                    int maxpix, std::size_t nPts,
+                                                    CancellationToken const &token) const {
+    Array2D to = ndarray::allocate(nPts, getNOut());
+    auto mapping = std::make_shared<detail::MappingForThread>(*this);
+    return [mapping, lbnd, ubnd, tol, maxpix, to, token]() -> Array2D {
+        detail::MappingForThread::Lock lock(*mapping);
+        Mapping &threadMapping = lock.get();
+        token.throwIfCancelled();
+        threadMapping._tranGrid(lbnd, ubnd, tol, maxpix, true, to);
+        return to;
+    };
+}
+
+std::future<Array2D> Mapping::_submitTask(std::function<Array2D()> task,
+                                          std::shared_ptr<ThreadPool> const &pool) {
+    auto const usePool = pool ? pool : getDefaultThreadPool();
+    return usePool->submit(std::move(task));
+}
+
+void Mapping::_postTask(std::function<Array2D()> task, TransformCallback const &callback,
+                        std::shared_ptr<ThreadPool> const &pool) {
+    auto const usePool = pool ? pool : getDefaultThreadPool();
+    usePool->post([task, callback] {
+        Array2D result;
+        std::exception_ptr error;
+        try {
+            result = task();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        try {
+            callback(result, error);
+        } catch (...) {
+            // documented as ignored; there is nobody to report it to
+        }
+    });
 }
 
 void Mapping::_tranGrid(PointI const &lbnd, PointI const &ubnd, double tol, int maxpix, bool doForward,
@@ -133,13 +351,75 @@ void Mapping::_tranGrid(PointI const &lbnd, PointI const &ubnd, double tol, int
     detail::assertEqual(lbnd.size(), "lbnd.size", static_cast<std::size_t>(nFromAxes), "from coords");
     detail::assertEqual(ubnd.size(), "ubnd.size", static_cast<std::size_t>(nFromAxes), "from coords");
     detail::assertEqual(to.getSize<1>(), "to.size[1]", static_cast<std::size_t>(nToAxes), "to coords");
-    int const nPts = to.getSize<0>();
-    astTranGrid(getRawPtr(), nFromAxes, lbnd.data(), ubnd.data(), tol, maxpix, static_cast<int>(doForward),
-                nToAxes, nPts, to.getData());
-    assertOK();
+    std::size_t const nPts = to.getSize<0>();
+    detail::OpScope opScope(doForward ? "tranGridForward" : "tranGridInverse", *this, nPts);
+    opScope.setAxes(nFromAxes, nToAxes);
+    opScope.setTol(tol);
+    if (nPts <= detail::getMaxTranChunk()) {
+        astTranGrid(getRawPtr(), nFromAxes, lbnd.data(), ubnd.data(), tol, maxpix, static_cast<int>(doForward),
+                    nToAxes, static_cast<int>(nPts), to.getData());
+        assertOK();
+    } else {
+        std::size_t nGridPts = 1;
+        for (int axis = 0; axis < nFromAxes; ++axis) {
+            nGridPts *= ubnd[axis] >= lbnd[axis] ? static_cast<std::size_t>(ubnd[axis] - lbnd[axis]) + 1 : 0;
+        }
+        if (nGridPts > nPts) {
+            std::ostringstream os;
+            os << "The grid has " << nGridPts << " points, which is more than the " << nPts
+               << " points allocated in `to`";
+            throw std::invalid_argument(os.str());
+        }
+        PointI chunkLbnd(lbnd);
+        PointI chunkUbnd(ubnd);
+        _tranGridChunks(chunkLbnd, chunkUbnd, nFromAxes - 1, 0, tol, maxpix, doForward, to);
+    }
     detail::astBadToNan(to);
 }
 
+std::size_t Mapping::_tranGridChunks(PointI &lbnd, PointI &ubnd, int axis, std::size_t offset, double tol,
+                                     int maxpix, bool doForward, Array2D const &to) const {
+    // AST's grid points vary fastest along the first axis, so each value of the last (slowest) axis
+    // selects a contiguous range of output points; split along it, recursing if one plane is too big
+    std::size_t const maxChunk = detail::getMaxTranChunk();
+    std::size_t planeSize = 1;
+    for (int i = 0; i < axis; ++i) {
+        planeSize *= static_cast<std::size_t>(ubnd[i] - lbnd[i]) + 1;
+    }
+    int const axisLbnd = lbnd[axis];
+    int const axisUbnd = ubnd[axis];
+    if (planeSize > maxChunk) {
+        for (int value = axisLbnd; value <= axisUbnd; ++value) {
+            lbnd[axis] = ubnd[axis] = value;
+            offset = _tranGridChunks(lbnd, ubnd, axis - 1, offset, tol, maxpix, doForward, to);
+        }
+    } else {
+        int const nPlanesPerChunk = static_cast<int>(maxChunk / planeSize);
+        int const nFromAxes = lbnd.size();
+        int const nToAxes = to.getSize<1>();
+        std::size_t const nPts = to.getSize<0>();
+        std::vector<double> scratch;
+        for (long value = axisLbnd; value <= axisUbnd; value += nPlanesPerChunk) {
+            lbnd[axis] = value;
+            ubnd[axis] = std::min(value + nPlanesPerChunk - 1, static_cast<long>(axisUbnd));
+            int const nChunkPts = planeSize * (ubnd[axis] - lbnd[axis] + 1);
+            scratch.resize(static_cast<std::size_t>(nChunkPts) * nToAxes);
+            astTranGrid(getRawPtr(), nFromAxes, lbnd.data(), ubnd.data(), tol, maxpix,
+                        static_cast<int>(doForward), nToAxes, nChunkPts, scratch.data());
+            assertOK();
+            // like astTranGrid, store the results for each output axis in a block of nPts values
+            for (int toAxis = 0; toAxis < nToAxes; ++toAxis) {
+                double const *chunkData = scratch.data() + toAxis * static_cast<std::size_t>(nChunkPts);
+                std::copy(chunkData, chunkData + nChunkPts, to.getData() + toAxis * nPts + offset);
+            }
+            offset += nChunkPts;
+        }
+    }
+    lbnd[axis] = axisLbnd;
+    ubnd[axis] = axisUbnd;
+    return offset;
+}
+
 // Explicit instantiations
 template std::shared_ptr<Frame> Mapping::decompose(int i, bool) const;
 template std::shared_ptr<Mapping> Mapping::decompose(int i, bool) const;
@@ -0,0 +1,333 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "ndarray.h"
+
+#include "astshim/base.h"
+#include "astshim/detail/utils.h"
+#include "astshim/CmpMap.h"
+#include "astshim/FrameSet.h"
+#include "astshim/Mapping.h"
+#include "astshim/MappingCost.h"
+#include "astshim/PolyMap.h"
+
+namespace ast {
+namespace {
+
+double const NOT_DEFINED = std::numeric_limits<double>::quiet_NaN();
+
+/// Minimum time spent timing each node (sec)
+double const MIN_TIMING_SEC = 0.002;
+
+/**
+Approximate cost of simple mappings, in ns per point
+
+These are rough estimates of the relative cost of each mapping, based on the amount of work
+its transformation does per point; they are not measurements, and are intended only to rank
+mappings. Use the measured costs (nPoints > 0) for real timings. Mappings not listed use DEFAULT_COST.
+*/
+std::map<std::string, double> const LEAF_COSTS = {
+        {"UnitMap", 1},   {"ZoomMap", 2},   {"ShiftMap", 2},  {"WinMap", 3},     {"PermMap", 3},
+        {"UnitNormMap", 5}, {"NormMap", 20}, {"PcdMap", 20},  {"SphMap", 40},    {"TranMap", 50},
+        {"TimeMap", 100}, {"WcsMap", 150},  {"SpecMap", 200}, {"SlaMap", 500},   {"RateMap", 2000},
+};
+double const DEFAULT_COST = 50;
+double const COST_PER_POLY_TERM = 3;         // PolyMap and ChebyMap
+double const CHEBY_OVERHEAD = 10;            // extra cost of ChebyMap (scaling and recurrence)
+double const ITERATIVE_FACTOR = 10;          // approximate # of iterations for an iterative inverse
+double const COST_PER_MATRIX_ELEMENT = 1;    // MatrixMap
+double const LUT_COST = 10;                  // LutMap, excluding search for non-uniform tables
+double const COST_PER_EXPRESSION = 30;       // MathMap
+
+/**
+Return the top-level "key = value" pairs of the dump of an object (as from Object::show)
+
+Values of nested objects are ignored; if a key appears more than once the first value is used.
+*/
+std::map<std::string, std::string> getDumpValues(Object const &object) {
+    std::istringstream is(object.show(false));
+    std::map<std::string, std::string> values;
+    std::string line;
+    int depth = 0;
+    while (std::getline(is, line)) {
+        auto const start = line.find_first_not_of(" \t");
+        if (start == std::string::npos) {
+            continue;
+        }
+        line = line.substr(start);
+        if (line.compare(0, 6, "Begin ") == 0) {
+            ++depth;
+            continue;
+        } else if (line.compare(0, 4, "End ") == 0) {
+            --depth;
+            continue;
+        }
+        auto const eqPos = line.find(" = ");
+        if ((depth != 1) || (eqPos == std::string::npos)) {
+            continue;
+        }
+        values.emplace(line.substr(0, eqPos), line.substr(eqPos + 3));
+    }
+    return values;
+}
+
+/// Sum or maximum of the integer values of keys <prefix>1, <prefix>2, ... in a dump
+int reduceDumpValues(std::map<std::string, std::string> const &values, std::string const &prefix,
+                     bool doMax) {
+    int result = 0;
+    for (int i = 1;; ++i) {
+        auto const iter = values.find(prefix + std::to_string(i));
+        if (iter == values.end()) {
+            break;
+        }
+        int const value = std::stoi(iter->second);
+        result = doMax ? std::max(result, value) : result + value;
+    }
+    return result;
+}
+
+/**
+Set the properties and modelled cost of a leaf (a mapping that is not a SeriesMap or ParallelMap)
+*/
+void describeLeaf(Mapping const &mapping, bool forward, MappingCost &cost) {
+    if (!(forward ? mapping.hasForward() : mapping.hasInverse())) {
+        cost.modelledCost = NOT_DEFINED;
+        return;
+    }
+    // direction of the transform, as seen by the uninverted AST object
+    bool const astForward = forward != mapping.isInverted();
+    std::string const &className = cost.className;
+    if ((className == "PolyMap") || (className == "ChebyMap")) {
+        auto const values = getDumpValues(mapping);
+        std::string const dirCode = astForward ? "F" : "I";
+        int const nTerms = reduceDumpValues(values, "NC" + dirCode, false);
+        bool const iterative = nTerms == 0;  // the transform is defined, so it must be iterative
+        if (iterative) {
+            std::string const otherDirCode = astForward ? "I" : "F";
+            cost.properties["order"] = reduceDumpValues(values, "MP" + otherDirCode, true);
+            cost.properties["nTerms"] = reduceDumpValues(values, "NC" + otherDirCode, false);
+        } else {
+            cost.properties["order"] = reduceDumpValues(values, "MP" + dirCode, true);
+            cost.properties["nTerms"] = nTerms;
+        }
+        cost.properties["iterative"] = iterative ? 1 : 0;
+        // an iterative inverse evaluates the forward transform and its Jacobian at each iteration
+        cost.modelledCost = COST_PER_POLY_TERM * cost.properties["nTerms"] *
+                            (iterative ? ITERATIVE_FACTOR * (1 + cost.nOut) : 1);
+        if (className == "ChebyMap") {
+            cost.modelledCost += CHEBY_OVERHEAD;
+        }
+    } else if (className == "MatrixMap") {
+        cost.modelledCost = 1 + COST_PER_MATRIX_ELEMENT * cost.nIn * cost.nOut;
+    } else if (className == "LutMap") {
+        auto const values = getDumpValues(mapping);
+        auto const iter = values.find("Nlut");
+        if (iter != values.end()) {
+            cost.properties["lutSize"] = std::stoi(iter->second);
+        }
+        // the inverse of a LutMap requires a search of the table
+        double const lutSize = std::max(2.0, cost.properties["lutSize"]);
+        cost.modelledCost = astForward ? LUT_COST : LUT_COST * (1 + std::log2(lutSize));
+    } else if (className == "MathMap") {
+        auto const values = getDumpValues(mapping);
+        auto const iter = values.find(astForward ? "Nfwd" : "Ninv");
+        int const nExpressions = iter != values.end() ? std::stoi(iter->second) : cost.nOut;
+        cost.properties["nExpressions"] = nExpressions;
+        cost.modelledCost = COST_PER_EXPRESSION * nExpressions;
+    } else {
+        auto const iter = LEAF_COSTS.find(className);
+        cost.modelledCost = iter != LEAF_COSTS.end() ? iter->second : DEFAULT_COST;
+    }
+}
+
+/**
+Transform `from` using `mapping`, putting the result in `to`, and time the transformation
+
+@return the time per point (ns), or nan if the transformation failed
+*/
+double transformAndTime(Mapping const &mapping, bool forward, ConstArray2D const &from, Array2D const &to) {
+    auto transform = [&]() {
+        if (forward) {
+            mapping.applyForward(from, to);
+        } else {
+            mapping.applyInverse(from, to);
+        }
+    };
+    try {
+        transform();
+    } catch (std::exception const &) {
+        std::fill(to.getData(), to.getData() + to.getSize<0>() * to.getSize<1>(), NOT_DEFINED);
+        return NOT_DEFINED;
+    }
+    using Clock = std::chrono::steady_clock;
+    int nIter = 0;
+    auto const start = Clock::now();
+    double elapsedSec = 0;
+    do {
+        transform();
+        ++nIter;
+        elapsedSec = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsedSec < MIN_TIMING_SEC);
+    return 1.0e9 * elapsedSec / (static_cast<double>(nIter) * from.getSize<1>());
+}
+
+/// Return a copy of rows [begin, end) of a 2-D array
+Array2D copyRows(ConstArray2D const &arr, int begin, int end) {
+    Array2D result = ndarray::allocate(ndarray::makeVector(end - begin, static_cast<int>(arr.getSize<1>())));
+    result.deep() = arr[ndarray::view(begin, end)()];
+    return result;
+}
+
+/**
+Explain one node of a mapping tree
+
+@param[in] mapping  Mapping to explain; must be simplified
+@param[in] forward  Explain the forward transform?
+@param[in] from  Sample points in the input space of the transform, with dimensions (nIn, nPoints);
+            if nPoints = 0 then costs are not measured
+@param[out] to  Sample points transformed by the mapping, with dimensions (nOut, nPoints)
+*/
+MappingCost explainNode(Mapping const &mapping, bool forward, ConstArray2D const &from, Array2D const &to) {
+    MappingCost cost;
+    cost.measuredCost = NOT_DEFINED;
+    cost.className = mapping.getClassName();
+    cost.ident = mapping.getIdent();
+    cost.nIn = forward ? mapping.getNIn() : mapping.getNOut();
+    cost.nOut = forward ? mapping.getNOut() : mapping.getNIn();
+    auto const nPoints = from.getSize<1>();
+    bool const doMeasure = nPoints > 0;
+
+    auto const cmpMap = dynamic_cast<CmpMap const *>(&mapping);
+    if (cmpMap) {
+        // the components ignore the compound mapping's own Invert flag, so allow for it here
+        bool const childForward = forward != mapping.isInverted();
+        auto const map1 = (*cmpMap)[0];
+        auto const map2 = (*cmpMap)[1];
+        if (cost.className == "SeriesMap") {
+            // map1 is applied first in the forward direction; map2 first in the inverse direction
+            auto const &firstMap = childForward ? *map1 : *map2;
+            auto const &secondMap = childForward ? *map2 : *map1;
+            int const nMid = childForward ? firstMap.getNOut() : firstMap.getNIn();
+            Array2D mid = ndarray::allocate(ndarray::makeVector(nMid, static_cast<int>(nPoints)));
+            cost.children.push_back(explainNode(firstMap, childForward, from, mid));
+            cost.children.push_back(explainNode(secondMap, childForward, mid, to));
+        } else {
+            // ParallelMap: map1 uses the first axes and map2 the remaining axes, in either direction
+            int const nIn1 = childForward ? map1->getNIn() : map1->getNOut();
+            int const nOut1 = childForward ? map1->getNOut() : map1->getNIn();
+            int const nFrom = from.getSize<0>();
+            int const nTo = to.getSize<0>();
+            Array2D to1 = ndarray::allocate(ndarray::makeVector(nOut1, static_cast<int>(nPoints)));
+            Array2D to2 = ndarray::allocate(ndarray::makeVector(nTo - nOut1, static_cast<int>(nPoints)));
+            cost.children.push_back(explainNode(*map1, childForward, copyRows(from, 0, nIn1), to1));
+            cost.children.push_back(explainNode(*map2, childForward, copyRows(from, nIn1, nFrom), to2));
+            to[ndarray::view(0, nOut1)()].deep() = to1;
+            to[ndarray::view(nOut1, nTo)()].deep() = to2;
+        }
+        cost.modelledCost = cost.children[0].modelledCost + cost.children[1].modelledCost;
+    } else {
+        describeLeaf(mapping, forward, cost);
+    }
+    if (doMeasure) {
+        // for a compound mapping the children have already computed `to`, so use scratch output
+        Array2D scratch = ndarray::allocate(to.getShape());
+        cost.measuredCost = transformAndTime(mapping, forward, from, cmpMap ? scratch : to);
+    }
+    return cost;
+}
+
+/// Get the sample box bounds, checking the length or applying the default
+PointD getBound(PointD const &bound, int nAxes, double defaultValue, std::string const &name) {
+    if (bound.empty()) {
+        return PointD(nAxes, defaultValue);
+    }
+    detail::assertEqual(bound.size(), name + ".size()", static_cast<std::size_t>(nAxes), "number of axes");
+    return bound;
+}
+
+void printNode(std::ostream &os, MappingCost const &cost, int indent) {
+    os << std::string(2 * indent, ' ') << cost.className;
+    if (!cost.ident.empty()) {
+        os << " \"" << cost.ident << "\"";
+    }
+    os << " nIn=" << cost.nIn << " nOut=" << cost.nOut;
+    for (auto const &item : cost.properties) {
+        os << " " << item.first << "=" << item.second;
+    }
+    os << ": cost=" << cost.getCost() << " ns/pt (modelled " << cost.modelledCost << ")\n";
+    for (auto const &child : cost.children) {
+        printNode(os, child, indent + 1);
+    }
+}
+
+}  // namespace
+
+double MappingCost::getCost() const { return std::isnan(measuredCost) ? modelledCost : measuredCost; }
+
+std::string MappingCost::toString() const {
+    std::ostringstream os;
+    os.precision(4);
+    printNode(os, *this, 0);
+    return os.str();
+}
+
+MappingCost Mapping::explain(bool forward, int nPoints, PointD const &lbnd, PointD const &ubnd) const {
+    if (nPoints < 0) {
+        std::ostringstream os;
+        os << "nPoints = " << nPoints << " < 0";
+        throw std::invalid_argument(os.str());
+    }
+    int const nAxes = forward ? getNIn() : getNOut();
+    auto const lbndSample = getBound(lbnd, nAxes, 0.0, "lbnd");
+    auto const ubndSample = getBound(ubnd, nAxes, 1000.0, "ubnd");
+
+    std::shared_ptr<Mapping> simpMap = simplified();
+    auto const frameSet = std::dynamic_pointer_cast<FrameSet>(simpMap);
+    if (frameSet) {
+        simpMap = frameSet->getMapping()->simplified();
+    }
+
+    // sample points uniformly distributed in the sample box; use a fixed seed for reproducibility
+    Array2D from = ndarray::allocate(ndarray::makeVector(nAxes, nPoints));
+    std::mt19937 generator(42);
+    for (int axis = 0; axis < nAxes; ++axis) {
+        std::uniform_real_distribution<double> distribution(lbndSample[axis], ubndSample[axis]);
+        for (int i = 0; i < nPoints; ++i) {
+            from[axis][i] = distribution(generator);
+        }
+    }
+    int const nToAxes = forward ? getNOut() : getNIn();
+    Array2D to = ndarray::allocate(ndarray::makeVector(nToAxes, nPoints));
+    return explainNode(*simpMap, forward, from, to);
+}
+
+}  // namespace ast
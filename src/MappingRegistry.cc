@@ -0,0 +1,95 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "astshim/Mapping.h"
+#include "astshim/MappingRegistry.h"
+
+namespace ast {
+namespace {
+
+/// 64-bit FNV-1a hash of a string, used as a checksum independent of std::hash
+std::uint64_t fnv1aHash(std::string const &text) {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+}  // namespace
+
+std::shared_ptr<Mapping const> MappingRegistry::intern(Mapping const &mapping) {
+    ++_nLookups;
+    std::string const text = mapping.show(false);
+    auto &entries = _entries[std::hash<std::string>()(text)];
+    std::uint64_t const checksum = fnv1aHash(text);
+    for (auto const &entry : entries) {
+        // hashes can collide, so also compare the checksums
+        if (entry.checksum == checksum) {
+            _bytesSaved += mapping.getObjSize();
+            return entry.mapping;
+        }
+    }
+    ++_nMisses;
+    std::shared_ptr<Mapping const> shared = mapping.copy();
+    std::size_t const bytes = shared->getObjSize();
+    entries.push_back(Entry{shared, bytes, checksum});
+    ++_nEntries;
+    _bytes += bytes;
+    return shared;
+}
+
+std::size_t MappingRegistry::purge() {
+    std::size_t nRemoved = 0;
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        auto &entries = it->second;
+        for (auto entryIt = entries.begin(); entryIt != entries.end();) {
+            if (entryIt->mapping.use_count() == 1) {
+                _bytes -= entryIt->bytes;
+                entryIt = entries.erase(entryIt);
+                ++nRemoved;
+            } else {
+                ++entryIt;
+            }
+        }
+        it = entries.empty() ? _entries.erase(it) : std::next(it);
+    }
+    _nEntries -= nRemoved;
+    return nRemoved;
+}
+
+void MappingRegistry::clear() {
+    _entries.clear();
+    _nEntries = 0;
+    _nLookups = 0;
+    _nMisses = 0;
+    _bytes = 0;
+    _bytesSaved = 0;
+}
+
+}  // namespace ast
@@ -167,6 +167,7 @@ Object::Object(AstObject *object) : _objPtr(object, &detail::annulAstObject) {
     if (!object) {
         throw std::runtime_error("Null pointer");
     }
+    detail::censusAdd(object);
 }
 
 // Explicit instantiations
@@ -20,9 +20,12 @@
  * see <https://www.lsstcorp.org/LegalNotices/>.
  */
 
+#include <algorithm>
+#include <string>
 #include <vector>
 
 #include "astshim/detail/utils.h"
+#include "astshim/FitCache.h"
 #include "astshim/Mapping.h"
 #include "astshim/QuadApprox.h"
 
@@ -36,11 +39,32 @@ QuadApprox::QuadApprox(Mapping const& map, std::vector<double> const& lbnd, std:
     detail::assertEqual(lbnd.size(), "lbnd.size", static_cast<std::size_t>(nIn), "nIn");
     detail::assertEqual(ubnd.size(), "ubnd.size", static_cast<std::size_t>(nIn), "nIn");
     fit.reserve(6 * map.getNOut());
-    bool isok = astQuadApprox(map.getRawPtr(), lbnd.data(), ubnd.data(), nx, ny, fit.data(), &rms);
-    assertOK();
-    if (!isok) {
-        throw std::runtime_error("Failed to fit a quadratic approximation");
+    // values packed as the fit coefficients followed by rms
+    auto computeFit = [&]() {
+        std::vector<double> values(fit.size() + 1);
+        bool isok = astQuadApprox(map.getRawPtr(), lbnd.data(), ubnd.data(), nx, ny, values.data(),
+                                  &values.back());
+        assertOK();
+        if (!isok) {
+            throw std::runtime_error("Failed to fit a quadratic approximation");
+        }
+        return values;
+    };
+    std::vector<double> values;
+    auto cache = getDefaultFitCache();
+    if (cache) {
+        std::vector<double> params = {static_cast<double>(nx), static_cast<double>(ny)};
+        params.insert(params.end(), lbnd.begin(), lbnd.end());
+        params.insert(params.end(), ubnd.begin(), ubnd.end());
+        std::string const key = FitCache::makeKey("QuadApprox", map, detail::formatFitParams(params));
+        values = detail::unpackDoubles(
+                cache->getOrCompute(key, [&]() { return detail::packDoubles(computeFit()); }));
     }
+    if (values.size() != fit.size() + 1) {
+        values = computeFit();
+    }
+    std::copy(values.begin(), values.end() - 1, fit.begin());
+    rms = values.back();
 }
 
 }  // namespace ast
\ No newline at end of file
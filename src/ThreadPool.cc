@@ -0,0 +1,195 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#include "astshim/ThreadPool.h"
+
+namespace ast {
+namespace {
+
+// The pool whose worker is running on this thread, and the index of that worker
+thread_local ThreadPool const *currentPool = nullptr;
+thread_local std::size_t currentIndex = 0;
+
+std::mutex defaultPoolMutex;
+std::shared_ptr<ThreadPool> defaultPool;
+
+/// Return the value of an environment variable as a non-negative integer, or 0 if not set
+std::size_t getEnvSize(char const *name) {
+    char const *envValue = std::getenv(name);
+    if (!envValue || envValue[0] == '\0') {
+        return 0;
+    }
+    long const value = std::strtol(envValue, nullptr, 10);
+    return value > 0 ? static_cast<std::size_t>(value) : 0;
+}
+
+}  // namespace
+
+ThreadPool::ThreadPool(int nThreads, std::size_t maxQueued)
+        : _maxQueued(maxQueued),
+          _queues(),
+          _threads(),
+          _nextQueue(0),
+          _mutex(),
+          _notEmpty(),
+          _notFull(),
+          _nQueued(0),
+          _nReady(0),
+          _stop(false) {
+    if (nThreads < 0) {
+        throw std::invalid_argument("nThreads = " + std::to_string(nThreads) + " < 0");
+    }
+    if (nThreads == 0) {
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (int i = 0; i < nThreads; ++i) {
+        _queues.emplace_back(new WorkerQueue());
+    }
+    for (int i = 0; i < nThreads; ++i) {
+        _threads.emplace_back(&ThreadPool::_run, this, static_cast<std::size_t>(i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _notEmpty.notify_all();
+    _notFull.notify_all();
+    for (auto &thread : _threads) {
+        thread.join();
+    }
+}
+
+std::size_t ThreadPool::getNQueued() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _nQueued;
+}
+
+bool ThreadPool::isWorkerThread() const { return currentPool == this; }
+
+void ThreadPool::_push(std::function<void()> task) {
+    std::size_t index;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (isWorkerThread()) {
+            index = currentIndex;
+        } else {
+            if (_maxQueued > 0) {
+                _notFull.wait(lock, [this] { return _stop || _nQueued < _maxQueued; });
+            }
+            index = _nextQueue++ % _queues.size();
+        }
+        if (_stop) {
+            throw std::runtime_error("Cannot submit a task to a thread pool that is being destroyed");
+        }
+        ++_nQueued;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+        _queues[index]->tasks.push_back(std::move(task));
+    }
+    {
+        // only announce the task once it is in a queue, so a worker that claims it will find it
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_nReady;
+    }
+    _notEmpty.notify_one();
+}
+
+bool ThreadPool::_tryPop(std::size_t index, std::function<void()> &task) {
+    {
+        std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+        auto &tasks = _queues[index]->tasks;
+        if (!tasks.empty()) {
+            task = std::move(tasks.back());
+            tasks.pop_back();
+            return true;
+        }
+    }
+    for (std::size_t i = 1; i < _queues.size(); ++i) {
+        auto &victim = *_queues[(index + i) % _queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::_run(std::size_t index) {
+    currentPool = this;
+    currentIndex = index;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _notEmpty.wait(lock, [this] { return _stop || _nReady > 0; });
+            if (_nReady == 0) {
+                return;  // stopping and no work is left
+            }
+            // claim one task; it is in some queue, though another worker may take it first,
+            // in which case the task claimed by that worker is left for this one
+            --_nReady;
+        }
+        std::function<void()> task;
+        while (!_tryPop(index, task)) {
+            std::this_thread::yield();
+        }
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            --_nQueued;
+        }
+        _notFull.notify_one();
+        try {
+            task();
+        } catch (...) {
+            // tasks from submit store exceptions in their future; tasks from post must handle their own
+        }
+    }
+}
+
+std::shared_ptr<ThreadPool> getDefaultThreadPool() {
+    std::lock_guard<std::mutex> lock(defaultPoolMutex);
+    if (!defaultPool) {
+        int const nThreads = static_cast<int>(getEnvSize("ASTSHIM_NUM_THREADS"));
+        defaultPool = std::make_shared<ThreadPool>(nThreads, getEnvSize("ASTSHIM_MAX_QUEUED"));
+    }
+    return defaultPool;
+}
+
+void setDefaultThreadPool(std::shared_ptr<ThreadPool> pool) {
+    std::shared_ptr<ThreadPool> oldPool;
+    {
+        std::lock_guard<std::mutex> lock(defaultPoolMutex);
+        oldPool = defaultPool;
+        defaultPool = pool;
+    }
+    // oldPool goes out of scope here, outside the lock, so waiting for its tasks cannot block other callers
+}
+
+}  // namespace ast
@@ -0,0 +1,82 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+#include "astshim/Mapping.h"
+#include "astshim/TransformWorkspace.h"
+
+namespace ast {
+
+TransformWorkspace::TransformWorkspace(Mapping const &mapping, std::size_t nPoints)
+        : _nIn(mapping.getNIn()),
+          _nOut(mapping.getNOut()),
+          _capacity(0),
+          _nAllocations(0),
+          _nanInputIsBad(false),
+          _input(),
+          _output() {
+    reserve(nPoints);
+}
+
+void TransformWorkspace::reserve(std::size_t nPoints) {
+    if (nPoints <= _capacity) {
+        return;
+    }
+    // grow geometrically so that slowly increasing batch sizes do not reallocate every time
+    std::size_t const capacity = std::max(nPoints, _capacity + _capacity / 2);
+    std::size_t const nValues = static_cast<std::size_t>(std::max(_nIn, _nOut)) * capacity;
+    _input = ndarray::allocate(nValues);
+    _output = ndarray::allocate(nValues);
+    _capacity = capacity;
+    ++_nAllocations;
+}
+
+Array2D TransformWorkspace::getInput(std::size_t nPoints, bool forward) {
+    reserve(nPoints);
+    return _view(_input, forward ? _nIn : _nOut, nPoints);
+}
+
+Array2D TransformWorkspace::getOutput(std::size_t nPoints, bool forward) {
+    reserve(nPoints);
+    return _view(_output, forward ? _nOut : _nIn, nPoints);
+}
+
+void TransformWorkspace::assertCompatible(Mapping const &mapping) const {
+    if ((mapping.getNIn() != _nIn) || (mapping.getNOut() != _nOut)) {
+        std::ostringstream os;
+        os << "Workspace is for a mapping with nIn=" << _nIn << ", nOut=" << _nOut
+           << " but the mapping has nIn=" << mapping.getNIn() << ", nOut=" << mapping.getNOut();
+        throw std::invalid_argument(os.str());
+    }
+}
+
+Array2D TransformWorkspace::_view(Buffer const &buffer, int nAxes, std::size_t nPoints) {
+    // the view shares ownership of the buffer, so it stays valid even if the workspace reallocates
+    Array2D::Index const shape = ndarray::makeVector(static_cast<std::size_t>(nAxes), nPoints);
+    Array2D::Strides const strides =
+            ndarray::makeVector(static_cast<std::ptrdiff_t>(nPoints), static_cast<std::ptrdiff_t>(1));
+    return ndarray::external(buffer.getData(), shape, strides, buffer);
+}
+
+}  // namespace ast
@@ -8,7 +8,8 @@
 namespace ast {
 namespace {
 
-static std::ostringstream errorMsgStream;
+// AST reports errors in the thread that made the failing call, so each thread collects its own messages
+static thread_local std::ostringstream errorMsgStream;
 
 /*
 Write an error message to `errorMsgStream`
@@ -67,14 +68,14 @@ ConstArray2D arrayFromVector(std::vector<double> const &vec, int nAxes) {
 }
 
 Array2D arrayFromVector(std::vector<double> &vec, int nAxes) {
-    int nPoints = vec.size() / nAxes;
+    std::size_t const nPoints = vec.size() / nAxes;
     if (nPoints * nAxes != vec.size()) {
         std::ostringstream os;
         os << "vec length = " << vec.size() << " not a multiple of nAxes = " << nAxes;
         throw std::runtime_error(os.str());
     }
-    Array2D::Index shape = ndarray::makeVector(nAxes, nPoints);
-    Array2D::Index strides = ndarray::makeVector(nPoints, 1);
+    Array2D::Index shape = ndarray::makeVector(static_cast<std::size_t>(nAxes), nPoints);
+    Array2D::Index strides = ndarray::makeVector(nPoints, static_cast<std::size_t>(1));
     return external(vec.data(), shape, strides);
 }
 
@@ -0,0 +1,193 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "astshim/base.h"
+#include "astshim/batchApply.h"
+#include "astshim/detail/threadUtils.h"
+#include "astshim/detail/utils.h"
+#include "astshim/Instrumentation.h"
+#include "astshim/Mapping.h"
+
+namespace ast {
+namespace {
+
+// Smallest number of points worth sending to a thread as one unit of work
+std::size_t const MIN_UNIT_POINTS = 4096;
+
+// Number of units of work per thread; more than one so threads that finish early can steal work
+std::size_t const UNITS_PER_THREAD = 4;
+
+}  // namespace
+
+namespace detail {
+
+/**
+One unit of work for batchApply: a list of pieces, each a range of points of one job
+
+The unit has its own copy of each mapping it uses, made by the calling thread;
+it holds references to the jobs and results, which batchApply keeps alive until all units finish.
+*/
+class BatchUnit {
+public:
+    /// A range of points of one job
+    struct Piece {
+        std::size_t job;    ///< index of job
+        std::size_t begin;  ///< index of first point
+        std::size_t end;    ///< index of last point + 1
+        std::shared_ptr<MappingForThread> mapping;  ///< copy of the job's mapping
+    };
+
+    BatchUnit(std::vector<BatchJob> const &jobs, std::vector<Array2D> const &results, bool forward)
+            : _jobs(jobs), _results(results), _forward(forward), _nPoints(0) {}
+
+    /// Get the number of points in the unit
+    std::size_t getNPoints() const { return _nPoints; }
+
+    /// Is the unit empty?
+    bool empty() const { return _pieces.empty(); }
+
+    /**
+    Add points [begin, end) of a job
+
+    @param[in] job  Index of job
+    @param[in] begin  Index of first point
+    @param[in] end  Index of last point + 1
+    */
+    void add(std::size_t job, std::size_t begin, std::size_t end) {
+        Mapping const *mapping = _jobs[job].mapping;
+        auto &copy = _copies[mapping];
+        if (!copy) {
+            copy = std::make_shared<MappingForThread>(*mapping);
+        }
+        _pieces.push_back(Piece{job, begin, end, copy});
+        _nPoints += end - begin;
+    }
+
+    /// Transform all pieces; call from the worker thread
+    void operator()() const {
+        for (auto const &piece : _pieces) {
+            MappingForThread::Lock lock(*piece.mapping);
+            Mapping &mapping = lock.get();
+            ConstArray2D const &from = _jobs[piece.job].from;
+            Array2D const &to = _results[piece.job];
+            detail::OpScope opScope(_forward ? "tranForward" : "tranInverse", mapping,
+                                    piece.end - piece.begin);
+            opScope.setAxes(from.getSize<0>(), to.getSize<0>());
+            // this also replaces AST__BAD with NaN, in this piece only; other threads may be writing the rest
+            mapping._tranRange(from, _forward, to, piece.begin, piece.end);
+        }
+    }
+
+private:
+    std::vector<BatchJob> const &_jobs;
+    std::vector<Array2D> const &_results;
+    bool _forward;
+    std::size_t _nPoints;
+    std::vector<Piece> _pieces;
+    std::map<Mapping const *, std::shared_ptr<MappingForThread>> _copies;  // one copy per mapping used
+};
+
+}  // namespace detail
+
+std::vector<Array2D> batchApply(std::vector<BatchJob> const &jobs, bool forward,
+                                std::shared_ptr<ThreadPool> const &pool) {
+    // check all jobs and allocate the results before starting any work
+    std::vector<Array2D> results;
+    results.reserve(jobs.size());
+    std::size_t totalPoints = 0;
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        auto const &job = jobs[i];
+        if (!job.mapping) {
+            std::ostringstream os;
+            os << "Job " << i << " has no mapping";
+            throw std::invalid_argument(os.str());
+        }
+        int const nFromAxes = forward ? job.mapping->getNIn() : job.mapping->getNOut();
+        int const nToAxes = forward ? job.mapping->getNOut() : job.mapping->getNIn();
+        std::ostringstream descr;
+        descr << "jobs[" << i << "].from.size[0]";
+        detail::assertEqual(job.from.getSize<0>(), descr.str(), static_cast<std::size_t>(nFromAxes),
+                            "from coords");
+        std::size_t const nPts = job.from.getSize<1>();
+        results.push_back(ndarray::allocate(nToAxes, nPts));
+        totalPoints += nPts;
+    }
+    if (totalPoints == 0) {
+        return results;
+    }
+    detail::OpScope opScope("batchApply", *jobs[0].mapping, totalPoints);
+
+    // divide the work into units of roughly equal size: split large jobs and pack small ones together
+    auto const usePool = pool ? pool : getDefaultThreadPool();
+    std::size_t const nThreads = std::max(usePool->getNThreads(), 1);
+    std::size_t unitPoints = (totalPoints + nThreads * UNITS_PER_THREAD - 1) / (nThreads * UNITS_PER_THREAD);
+    unitPoints = std::min(std::max(unitPoints, MIN_UNIT_POINTS), detail::getMaxTranChunk());
+    std::vector<detail::BatchUnit> units;
+    units.emplace_back(jobs, results, forward);
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+        std::size_t const nPts = jobs[i].from.getSize<1>();
+        for (std::size_t begin = 0; begin < nPts;) {
+            if (units.back().getNPoints() >= unitPoints) {
+                units.emplace_back(jobs, results, forward);
+            }
+            std::size_t const end = std::min(nPts, begin + unitPoints - units.back().getNPoints());
+            units.back().add(i, begin, end);
+            begin = end;
+        }
+    }
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(units.size());
+    std::exception_ptr error;
+    try {
+        for (auto const &unit : units) {
+            futures.push_back(usePool->submit([&unit] { unit(); }));
+        }
+    } catch (...) {
+        // e.g. the pool is being destroyed; still wait for the units already submitted
+        error = std::current_exception();
+    }
+    // wait for every unit, since they refer to jobs and results, then report the first error
+    for (auto &future : futures) {
+        try {
+            future.get();
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return results;
+}
+
+}  // namespace ast
@@ -21,11 +21,37 @@
  */
 #include "astshim/detail/polyMapUtils.h"
 #include "astshim/ChebyMap.h"
+#include "astshim/Channel.h"
+#include "astshim/FitCache.h"
+#include "astshim/Instrumentation.h"
 #include "astshim/PolyMap.h"
+#include "astshim/Stream.h"
 
 namespace ast {
 namespace detail {
 
+namespace {
+
+// Fit the inverse (or forward) transform of a PolyMap or ChebyMap, without using the fit cache
+template <class AstMapT, class MapT>
+AstMapT *fitPolyTran(MapT const &mapping, bool forward, double acc, double maxacc, int maxorder,
+                     std::vector<double> const &lbnd, std::vector<double> const &ubnd) {
+    OpScope opScope("polyTran", mapping);
+    opScope.setAxes(mapping.getNIn(), mapping.getNOut());
+    opScope.setTol(acc);
+    void *outRawMap = astPolyTran(mapping.getRawPtr(), static_cast<int>(forward), acc, maxacc, maxorder,
+                                  lbnd.data(), ubnd.data());
+    // Failure should result in a null pointer, so calling assertOK is unlikely to do anything,
+    // but better to be sure and than risk missing an uncaught error.
+    assertOK(reinterpret_cast<AstObject *>(outRawMap));
+    if (!outRawMap) {
+        throw std::runtime_error("Could not compute an inverse mapping");
+    }
+    return reinterpret_cast<AstMapT *>(outRawMap);
+}
+
+}  // namespace
+
 template <class AstMapT, class MapT>
 AstMapT *polyTranImpl(MapT const &mapping, bool forward, double acc, double maxacc, int maxorder,
                       std::vector<double> const &lbnd, std::vector<double> const &ubnd) {
@@ -45,14 +71,24 @@ AstMapT *polyTranImpl(MapT const &mapping, bool forward, double acc, double maxa
         throw std::invalid_argument(os.str());
     }
 
-    void *outRawMap = astPolyTran(mapping.getRawPtr(), static_cast<int>(forward), acc, maxacc, maxorder,
-                                  lbnd.data(), ubnd.data());
-    // Failure should result in a null pointer, so calling assertOK is unlikely to do anything,
-    // but better to be sure and than risk missing an uncaught error.
-    assertOK(reinterpret_cast<AstObject *>(outRawMap));
-    if (!outRawMap) {
-        throw std::runtime_error("Could not compute an inverse mapping");
+    auto cache = getDefaultFitCache();
+    if (!cache) {
+        return fitPolyTran<AstMapT>(mapping, forward, acc, maxacc, maxorder, lbnd, ubnd);
     }
+    std::vector<double> params = {forward ? 1.0 : 0.0, acc, maxacc, static_cast<double>(maxorder)};
+    params.insert(params.end(), lbnd.begin(), lbnd.end());
+    params.insert(params.end(), ubnd.begin(), ubnd.end());
+    std::string const key = FitCache::makeKey("polyTran", mapping, formatFitParams(params));
+    std::string const text = cache->getOrCompute(key, [&]() {
+        auto rawFit = fitPolyTran<AstMapT>(mapping, forward, acc, maxacc, maxorder, lbnd, ubnd);
+        return Object::fromAstObject<MapT>(reinterpret_cast<AstObject *>(rawFit), false)->show(false);
+    });
+    // the cached text is a serialized mapping; read it and return a raw copy
+    StringStream stream(text);
+    Channel channel(stream);
+    auto fit = channel.read();
+    auto outRawMap = astCopy(fit->getRawPtr());
+    assertOK(reinterpret_cast<AstObject *>(outRawMap));
     return reinterpret_cast<AstMapT *>(outRawMap);
 }
 
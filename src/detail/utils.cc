@@ -19,19 +19,45 @@
  * the GNU General Public License along with this program.  If not,
  * see <https://www.lsstcorp.org/LegalNotices/>.
  */
+#include <atomic>
+
 #include "astshim/detail/utils.h"
 
 namespace ast {
 namespace detail {
+namespace {
+
+std::size_t const DEFAULT_MAX_TRAN_CHUNK = static_cast<std::size_t>(std::numeric_limits<int>::max());
+
+std::atomic<std::size_t> maxTranChunk(DEFAULT_MAX_TRAN_CHUNK);
+
+}  // namespace
+
+void astBadToNan(double *data, std::size_t size) {
+    double const nan = std::numeric_limits<double>::quiet_NaN();
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = data[i] == AST__BAD ? nan : data[i];
+    }
+}
+
+void nanToAstBad(double const *from, std::size_t size, double *to) {
+    for (std::size_t i = 0; i < size; ++i) {
+        // x != x is true only for NaN, and unlike std::isnan it does not stop vectorization
+        to[i] = from[i] != from[i] ? AST__BAD : from[i];
+    }
+}
+
+void astBadToNan(ast::Array2D const &arr) { astBadToNan(arr.getData(), arr.getNumElements()); }
+
+std::size_t getMaxTranChunk() { return maxTranChunk.load(); }
 
-void astBadToNan(ast::Array2D const &arr) {
-    for (auto i = arr.begin(); i != arr.end(); ++i) {
-        for (auto j = i->begin(); j != i->end(); ++j) {
-            if (*j == AST__BAD) {
-                *j = std::numeric_limits<double>::quiet_NaN();
-            }
-        }
+void setMaxTranChunk(std::size_t maxChunk) {
+    if (maxChunk > DEFAULT_MAX_TRAN_CHUNK) {
+        std::ostringstream os;
+        os << "maxChunk = " << maxChunk << " > " << DEFAULT_MAX_TRAN_CHUNK;
+        throw std::invalid_argument(os.str());
     }
+    maxTranChunk = maxChunk == 0 ? DEFAULT_MAX_TRAN_CHUNK : maxChunk;
 }
 
 std::string getClassName(AstObject const *rawObj) {
@@ -0,0 +1,319 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <cstring>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "astshim/detail/xmlUtils.h"
+
+namespace ast {
+namespace detail {
+namespace {
+
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+/*
+Parse a start tag (or empty-element tag), including the enclosing < and >
+
+@param[in] tag  Text of the tag
+@param[out] name  Qualified name of the element
+@param[out] attrs  Attributes, as (qualified name, value as written, quote character)
+*/
+void parseStartTag(std::string const &tag, std::string &name,
+                   std::vector<std::tuple<std::string, std::string, char>> &attrs) {
+    std::size_t i = 1;
+    std::size_t const end = tag.size() - 1;  // index of the final '>'
+    while (i < end && !isSpace(tag[i]) && tag[i] != '/') {
+        name.push_back(tag[i++]);
+    }
+    while (true) {
+        while (i < end && isSpace(tag[i])) {
+            ++i;
+        }
+        if (i >= end || tag[i] == '/') {
+            return;
+        }
+        std::size_t const nameStart = i;
+        while (i < end && tag[i] != '=' && !isSpace(tag[i])) {
+            ++i;
+        }
+        std::string attrName = tag.substr(nameStart, i - nameStart);
+        while (i < end && isSpace(tag[i])) {
+            ++i;
+        }
+        if (i >= end || tag[i] != '=') {
+            return;  // malformed; leave it to the parser
+        }
+        ++i;
+        while (i < end && isSpace(tag[i])) {
+            ++i;
+        }
+        if (i >= end || (tag[i] != '"' && tag[i] != '\'')) {
+            return;
+        }
+        char const quote = tag[i++];
+        std::size_t const valueEnd = tag.find(quote, i);
+        if (valueEnd == std::string::npos || valueEnd > end) {
+            return;
+        }
+        attrs.emplace_back(std::move(attrName), tag.substr(i, valueEnd - i), quote);
+        i = valueEnd + 1;
+    }
+}
+
+// Names of the AST classes that an XmlChan can write
+std::set<std::string> const AST_CLASS_NAMES = {
+        "Box",         "ChebyMap",    "Circle",      "CmpFrame",    "CmpMap",       "CmpRegion",
+        "DSBSpecFrame", "DssMap",     "Ellipse",     "FitsTable",   "FluxFrame",    "Frame",
+        "FrameSet",    "GrismMap",    "IntraMap",    "Interval",    "KeyMap",       "LutMap",
+        "MathMap",     "MatrixMap",   "Moc",         "NormMap",     "NullRegion",   "PcdMap",
+        "PermMap",     "PointList",   "PolyMap",     "Polygon",     "Prism",        "RateMap",
+        "SelectorMap", "ShiftMap",    "SkyFrame",    "SlaMap",      "SpecFluxFrame", "SpecFrame",
+        "SpecMap",     "SphMap",      "Stc",         "StcCatalogEntryLocation",     "StcObsDataLocation",
+        "StcResourceProfile",         "StcSearchLocation",          "SwitchMap",    "Table",
+        "TimeFrame",   "TimeMap",     "TranMap",     "UnitMap",     "UnitNormMap",  "WcsMap",
+        "WinMap",      "XphMap",      "ZoomMap",
+};
+
+}  // namespace
+
+char const *const AST_XML_NAMESPACE = "http://www.starlink.ac.uk/ast/xml/";
+
+void XmlSplitter::add(char const *text, std::size_t size) {
+    for (char const *ptr = text, *end = text + size; ptr != end; ++ptr) {
+        char const c = *ptr;
+        switch (_state) {
+            case State::TEXT:
+                if (c == '<') {
+                    _state = State::TAG;
+                    _markup.assign(1, c);
+                } else if (_objectDepth > 0) {
+                    _object.push_back(c);
+                } else if (!_scopes.empty()) {
+                    _element.push_back(c);
+                }
+                break;
+            case State::TAG:
+                _markup.push_back(c);
+                if (_quote != '\0') {
+                    if (c == _quote) {
+                        _quote = '\0';
+                    }
+                } else if (c == '"' || c == '\'') {
+                    _quote = c;
+                } else if (c == '>') {
+                    _endMarkup();
+                } else if (_markup == "<!--") {
+                    _state = State::COMMENT;
+                } else if (_markup == "<![CDATA[") {
+                    _state = State::CDATA;
+                } else if (_markup == "<?") {
+                    _state = State::PI;
+                }
+                break;
+            case State::COMMENT:
+                _markup.push_back(c);
+                if (c == '>' && _markupEndsWith("-->", 3)) {
+                    _endMarkup();
+                }
+                break;
+            case State::CDATA:
+                _markup.push_back(c);
+                if (c == '>' && _markupEndsWith("]]>", 3)) {
+                    _endMarkup();
+                }
+                break;
+            case State::PI:
+                _markup.push_back(c);
+                if (c == '>' && _markupEndsWith("?>", 2)) {
+                    _endMarkup();
+                }
+                break;
+        }
+    }
+}
+
+std::string XmlSplitter::pop() {
+    if (_segments.empty()) {
+        throw std::out_of_range("There is no complete text");
+    }
+    std::string segment = std::move(_segments.front());
+    _segments.pop_front();
+    return segment;
+}
+
+std::string XmlSplitter::popIncomplete() {
+    std::string text = std::move(_objectDepth > 0 ? _object : _element);
+    text += _markup;
+    _object.clear();
+    _element.clear();
+    _markup.clear();
+    _scopes.clear();
+    _state = State::TEXT;
+    _quote = '\0';
+    _objectDepth = 0;
+    return text;
+}
+
+void XmlSplitter::_endMarkup() {
+    bool const isTag = _state == State::TAG && _markup.size() > 1 && _markup[1] != '!' && _markup[1] != '?';
+    _state = State::TEXT;
+    _quote = '\0';
+    if (!isTag) {
+        // comment, CDATA section, processing instruction or declaration: only part of an element
+        _append(_markup);
+    } else if (_markup[1] == '/') {
+        // end tag; ignore an end tag without a start tag
+        if (!_scopes.empty()) {
+            _append(_markup);
+            bool const isObjectEnd = _objectDepth == _scopes.size();
+            _scopes.pop_back();
+            if (isObjectEnd) {
+                _segments.push_back(std::move(_object));
+                _object.clear();
+                _objectDepth = 0;
+            } else if (_scopes.empty()) {
+                if (_elementHasOther || !_elementHasObject) {
+                    _segments.push_back(std::move(_element));
+                }
+                _element.clear();
+            }
+        }
+    } else {
+        _startTag(_markup[_markup.size() - 2] == '/');
+    }
+    _markup.clear();
+}
+
+void XmlSplitter::_startTag(bool isEmptyElement) {
+    std::string name;
+    std::vector<std::tuple<std::string, std::string, char>> attrs;
+    parseStartTag(_markup, name, attrs);
+    std::vector<NamespaceDecl> decls;
+    for (auto const &attr : attrs) {
+        std::string const &attrName = std::get<0>(attr);
+        if (attrName == "xmlns") {
+            decls.push_back({"", std::get<1>(attr), std::get<2>(attr)});
+        } else if (attrName.compare(0, 6, "xmlns:") == 0) {
+            decls.push_back({attrName.substr(6), std::get<1>(attr), std::get<2>(attr)});
+        }
+    }
+
+    if (_scopes.empty()) {
+        _elementHasObject = false;
+        _elementHasOther = false;
+    }
+    if (_objectDepth == 0 && _isAstObject(name, decls)) {
+        _object = _markup;
+        _addInheritedDecls(decls, _object);
+        _elementHasObject = true;
+        if (isEmptyElement) {
+            _segments.push_back(std::move(_object));
+            _object.clear();
+        } else {
+            _objectDepth = _scopes.size() + 1;
+        }
+    } else {
+        bool const isTopLevel = _scopes.empty();
+        if (_objectDepth == 0 && !isTopLevel) {
+            _elementHasOther = true;
+        }
+        if (isTopLevel) {
+            _element = _markup;
+            if (isEmptyElement) {
+                _segments.push_back(std::move(_element));
+                _element.clear();
+            }
+        } else {
+            _append(_markup);
+        }
+    }
+    if (!isEmptyElement) {
+        _scopes.push_back(std::move(decls));
+    }
+}
+
+bool XmlSplitter::_isAstObject(std::string const &name, std::vector<NamespaceDecl> const &decls) const {
+    std::size_t const colon = name.find(':');
+    std::string const prefix = colon == std::string::npos ? "" : name.substr(0, colon);
+    // the innermost declaration of the prefix applies
+    NamespaceDecl const *decl = nullptr;
+    for (auto const &ownDecl : decls) {
+        if (ownDecl.prefix == prefix) {
+            decl = &ownDecl;
+        }
+    }
+    for (auto scope = _scopes.rbegin(); !decl && scope != _scopes.rend(); ++scope) {
+        for (auto const &scopeDecl : *scope) {
+            if (scopeDecl.prefix == prefix) {
+                decl = &scopeDecl;
+            }
+        }
+    }
+    if (decl && !decl->uri.empty()) {
+        return decl->uri == AST_XML_NAMESPACE;
+    }
+    return prefix.empty() && AST_CLASS_NAMES.count(name) > 0;
+}
+
+void XmlSplitter::_addInheritedDecls(std::vector<NamespaceDecl> const &decls, std::string &tag) const {
+    std::map<std::string, NamespaceDecl const *> inherited;
+    for (auto const &scope : _scopes) {
+        for (auto const &decl : scope) {
+            inherited[decl.prefix] = &decl;
+        }
+    }
+    for (auto const &decl : decls) {
+        inherited.erase(decl.prefix);
+    }
+    std::string text;
+    for (auto const &prefixDecl : inherited) {
+        NamespaceDecl const &decl = *prefixDecl.second;
+        text += decl.prefix.empty() ? " xmlns=" : " xmlns:" + decl.prefix + "=";
+        text += decl.quote + decl.uri + decl.quote;
+    }
+    // insert before the final ">" or "/>"
+    std::size_t pos = tag.size() - 1;
+    if (tag[pos - 1] == '/') {
+        --pos;
+    }
+    tag.insert(pos, text);
+}
+
+void XmlSplitter::_append(std::string const &text) {
+    if (_objectDepth > 0) {
+        _object += text;
+    } else if (!_scopes.empty()) {
+        _element += text;
+    }
+}
+
+bool XmlSplitter::_markupEndsWith(char const *suffix, std::size_t size) const {
+    return _markup.size() >= size && _markup.compare(_markup.size() - size, size, suffix) == 0;
+}
+
+}  // namespace detail
+}  // namespace ast
@@ -19,8 +19,13 @@
  * the GNU General Public License along with this program.  If not,
  * see <https://www.lsstcorp.org/LegalNotices/>.
  */
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "astshim/functional.h"
 #include "astshim/UnitMap.h"
@@ -29,6 +34,59 @@
 #include "astshim/SeriesMap.h"
 
 namespace ast {
+namespace {
+
+// Number of table entries tabulate1D starts with
+int const INITIAL_TABULATION_ENTRIES = 33;
+
+// Fractions of the way across each table interval at which tabulate1D measures the error
+int const N_VERIFY_FRACTIONS = 3;
+double const VERIFY_FRACTIONS[N_VERIFY_FRACTIONS] = {0.25, 0.5, 0.75};
+
+/*
+Evaluate a 1-dimensional mapping at the points `x`
+
+@throws std::runtime_error if any result is NaN
+*/
+std::vector<double> evaluate1D(Mapping const& mapping, std::vector<double> const& x) {
+    auto const result = mapping.applyForward(arrayFromVector(x, 1));
+    std::vector<double> y(result[0].begin(), result[0].end());
+    for (std::size_t i = 0; i < y.size(); ++i) {
+        if (std::isnan(y[i])) {
+            std::ostringstream os;
+            os << "mapping gives an invalid value at x = " << x[i];
+            throw std::runtime_error(os.str());
+        }
+    }
+    return y;
+}
+
+/*
+A polynomial in several variables, as a map of the powers of each variable to the coefficient
+*/
+using Polynomial = std::map<std::vector<int>, double>;
+
+Polynomial multiply(Polynomial const& a, Polynomial const& b) {
+    Polynomial product;
+    for (auto const& termA : a) {
+        for (auto const& termB : b) {
+            std::vector<int> powers = termA.first;
+            for (std::size_t i = 0; i < powers.size(); ++i) {
+                powers[i] += termB.first[i];
+            }
+            product[powers] += termA.second * termB.second;
+        }
+    }
+    return product;
+}
+
+void addTo(Polynomial& sum, Polynomial const& poly, double scale = 1.0) {
+    for (auto const& term : poly) {
+        sum[term.first] += scale * term.second;
+    }
+}
+
+}  // namespace
 
 std::shared_ptr<FrameSet> append(FrameSet const& first, FrameSet const& second) {
     std::shared_ptr<FrameSet> const merged = first.copy();
@@ -60,4 +118,125 @@ std::shared_ptr<Mapping> makeRadialMapping(std::vector<double> const& center, Ma
             unitNormMap.then(UnitMap(naxes).under(mapping1d)).then(*unitNormMap.inverted()));
 }
 
+std::shared_ptr<PolyMap> makeRadialPolyMap(std::vector<double> const& center,
+                                           std::vector<double> const& coeffs, std::string const& options) {
+    if (center.empty()) {
+        throw std::invalid_argument("center is empty");
+    }
+    for (std::size_t i = 0; i < coeffs.size(); i += 2) {
+        if (coeffs[i] != 0) {
+            throw std::invalid_argument("coeffs[" + std::to_string(i) + "] = " + std::to_string(coeffs[i]) +
+                                        " is not 0; only odd powers of radius are supported");
+        }
+    }
+    int const nAxes = center.size();
+    std::vector<int> const constantTerm(nAxes, 0);
+
+    // offset[i] = x_i - center_i and rSq = sum of offset[i]^2
+    std::vector<Polynomial> offset(nAxes);
+    Polynomial rSq;
+    for (int i = 0; i < nAxes; ++i) {
+        std::vector<int> linearTerm(nAxes, 0);
+        linearTerm[i] = 1;
+        offset[i][linearTerm] = 1.0;
+        offset[i][constantTerm] = -center[i];
+        addTo(rSq, multiply(offset[i], offset[i]));
+    }
+
+    // scale = r'/r = sum of coeffs[i] rSq^((i - 1)/2) for odd i
+    Polynomial scale;
+    Polynomial rSqPower = {{constantTerm, 1.0}};
+    for (std::size_t i = 1; i < coeffs.size(); i += 2) {
+        addTo(scale, rSqPower, coeffs[i]);
+        rSqPower = multiply(rSqPower, rSq);
+    }
+
+    // output_i = center_i + offset[i] * scale
+    std::vector<std::vector<double>> rows;
+    for (int i = 0; i < nAxes; ++i) {
+        Polynomial output = {{constantTerm, center[i]}};
+        addTo(output, multiply(offset[i], scale));
+        for (auto const& term : output) {
+            if (term.second == 0) {
+                continue;
+            }
+            std::vector<double> row = {term.second, static_cast<double>(i + 1)};
+            row.insert(row.end(), term.first.begin(), term.first.end());
+            rows.push_back(row);
+        }
+    }
+    if (rows.empty()) {
+        // every output is 0, but PolyMap needs at least one coefficient
+        std::vector<double> row(2 + nAxes, 0.0);
+        row[1] = 1;
+        rows.push_back(row);
+    }
+    Array2D coeffArr = ndarray::allocate(rows.size(), 2 + nAxes);
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        std::copy(rows[i].begin(), rows[i].end(), coeffArr[i].begin());
+    }
+    return std::make_shared<PolyMap>(coeffArr, nAxes, options);
+}
+
+Tabulation1D tabulate1D(Mapping const& mapping, double lo, double hi, double tol, int maxEntries) {
+    if (mapping.getNIn() != 1 || mapping.getNOut() != 1) {
+        std::ostringstream os;
+        os << "mapping has nIn = " << mapping.getNIn() << " and nOut = " << mapping.getNOut()
+           << "; both must be 1";
+        throw std::invalid_argument(os.str());
+    }
+    if (!(lo < hi)) {
+        std::ostringstream os;
+        os << "lo = " << lo << " must be less than hi = " << hi;
+        throw std::invalid_argument(os.str());
+    }
+    if (!(tol > 0)) {
+        throw std::invalid_argument("tol = " + std::to_string(tol) + " must be positive");
+    }
+    if (maxEntries < 2) {
+        throw std::invalid_argument("maxEntries = " + std::to_string(maxEntries) + " must be at least 2");
+    }
+
+    int nEntries = std::min(INITIAL_TABULATION_ENTRIES, maxEntries);
+    for (int iteration = 1;; ++iteration) {
+        double const inc = (hi - lo) / (nEntries - 1);
+        std::vector<double> x(nEntries);
+        for (int i = 0; i < nEntries; ++i) {
+            x[i] = lo + i * inc;
+        }
+        auto lutMap = std::make_shared<LutMap>(evaluate1D(mapping, x), lo, inc);
+
+        // measure the error within each interval of the table
+        std::vector<double> xVerify;
+        xVerify.reserve((nEntries - 1) * N_VERIFY_FRACTIONS);
+        for (int i = 0; i < nEntries - 1; ++i) {
+            for (double fraction : VERIFY_FRACTIONS) {
+                xVerify.push_back(lo + (i + fraction) * inc);
+            }
+        }
+        auto const exact = evaluate1D(mapping, xVerify);
+        auto const approx = lutMap->applyForward(arrayFromVector(xVerify, 1));
+        double maxError = 0;
+        for (std::size_t i = 0; i < exact.size(); ++i) {
+            double const error = std::abs(approx[0][i] - exact[i]);
+            maxError = std::isnan(error) ? HUGE_VAL : std::max(maxError, error);
+        }
+        if (maxError <= tol) {
+            return Tabulation1D{lutMap, lo, inc, nEntries, maxError, iteration};
+        }
+        if (nEntries >= maxEntries) {
+            std::ostringstream os;
+            os << "Cannot tabulate mapping to tol = " << tol << " with maxEntries = " << maxEntries
+               << " entries; max error = " << maxError;
+            throw std::runtime_error(os.str());
+        }
+
+        // the error of linear interpolation scales as the square of the spacing;
+        // aim a bit finer than needed, but don't refine too much at once based on a poor estimate
+        double const factor = std::min(std::max(1.1 * std::sqrt(maxError / tol), 1.5), 16.0);
+        double const newNEntries = std::ceil((nEntries - 1) * factor) + 1;
+        nEntries = newNEntries >= maxEntries ? maxEntries : static_cast<int>(newNEntries);
+    }
+}
+
 }  // namespace ast
@@ -0,0 +1,420 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "astshim/base.h"
+#include "astshim/Instrumentation.h"
+#include "astshim/TransformWorkspace.h"
+#include "astshim/transformFile.h"
+
+namespace ast {
+namespace {
+
+/// Throw std::runtime_error describing a failed system call, including the text for `errno`
+[[noreturn]] void throwSystemError(std::string const &what, std::string const &path) {
+    std::ostringstream os;
+    os << what << " " << path << " failed: " << std::strerror(errno);
+    throw std::runtime_error(os.str());
+}
+
+/**
+A file mapped into memory
+
+The file is unmapped and closed when this object is destroyed.
+*/
+class MappedFile {
+public:
+    /**
+    Map an existing file for reading
+
+    @param[in] path  Path of file
+    */
+    explicit MappedFile(std::string const &path) : _path(path), _fd(-1), _data(nullptr), _size(0) {
+        _fd = ::open(path.c_str(), O_RDONLY);
+        if (_fd < 0) {
+            throwSystemError("Opening", path);
+        }
+        struct stat statBuf;
+        if (::fstat(_fd, &statBuf) != 0) {
+            _close();
+            throwSystemError("Getting the size of", path);
+        }
+        _size = statBuf.st_size;
+        _map(PROT_READ);
+        if (_data) {
+            ::madvise(_data, _size, MADV_SEQUENTIAL);
+        }
+    }
+
+    /**
+    Create (or replace) a file of the specified size and map it for writing
+
+    @param[in] path  Path of file
+    @param[in] size  Size of file (bytes)
+    */
+    MappedFile(std::string const &path, std::size_t size) : _path(path), _fd(-1), _data(nullptr), _size(size) {
+        _fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+        if (_fd < 0) {
+            throwSystemError("Creating", path);
+        }
+        if (::ftruncate(_fd, size) != 0) {
+            _close();
+            throwSystemError("Resizing", path);
+        }
+        _map(PROT_READ | PROT_WRITE);
+    }
+
+    MappedFile(MappedFile const &) = delete;
+    MappedFile(MappedFile &&) = delete;
+    MappedFile &operator=(MappedFile const &) = delete;
+    MappedFile &operator=(MappedFile &&) = delete;
+
+    ~MappedFile() {
+        if (_data) {
+            ::munmap(_data, _size);
+        }
+        _close();
+    }
+
+    double *getData() const { return static_cast<double *>(_data); }
+
+    std::size_t getSize() const { return _size; }
+
+    /// Ask the operating system to start reading the pages that cover `nValues` values starting at `begin`
+    void prefetch(std::size_t begin, std::size_t nValues) const {
+        std::size_t const pageSize = ::sysconf(_SC_PAGESIZE);
+        std::size_t const startByte = (begin * sizeof(double) / pageSize) * pageSize;
+        std::size_t const endByte = std::min(_size, (begin + nValues) * sizeof(double));
+        if (_data && endByte > startByte) {
+            ::madvise(static_cast<char *>(_data) + startByte, endByte - startByte, MADV_WILLNEED);
+        }
+    }
+
+    /**
+    Release the pages that lie entirely within `nValues` values starting at `begin`
+
+    The data is retained (in the file or page cache); this only removes the pages from
+    the address space of the process, so they no longer count towards its memory use.
+    Pages that are shared with neighboring data are left alone.
+    */
+    void release(std::size_t begin, std::size_t nValues) const {
+        std::size_t const pageSize = ::sysconf(_SC_PAGESIZE);
+        std::size_t const startByte = ((begin * sizeof(double) + pageSize - 1) / pageSize) * pageSize;
+        std::size_t endByte = (begin + nValues) * sizeof(double);
+        if (endByte < _size) {
+            endByte = (endByte / pageSize) * pageSize;
+        }
+        if (_data && endByte > startByte) {
+            ::madvise(static_cast<char *>(_data) + startByte, endByte - startByte, MADV_DONTNEED);
+        }
+    }
+
+    /// Write all modified pages to the file
+    void sync() const {
+        if (_data && ::msync(_data, _size, MS_SYNC) != 0) {
+            throwSystemError("Writing", _path);
+        }
+    }
+
+private:
+    void _map(int prot) {
+        if (_size == 0) {
+            return;  // mmap rejects empty mappings, and there is nothing to transform
+        }
+        void *data = ::mmap(nullptr, _size, prot, MAP_SHARED, _fd, 0);
+        if (data == MAP_FAILED) {
+            _close();
+            throwSystemError("Memory-mapping", _path);
+        }
+        _data = data;
+    }
+
+    void _close() {
+        if (_fd >= 0) {
+            ::close(_fd);
+            _fd = -1;
+        }
+    }
+
+    std::string _path;
+    int _fd;
+    void *_data;
+    std::size_t _size;
+};
+
+/**
+Transform blocks of points from one mapped file to another, for use by one thread
+
+Blocks are claimed from a shared counter, so threads that finish early take more blocks.
+*/
+class BlockTransformer {
+public:
+    BlockTransformer(MappedFile const &inFile, MappedFile const &outFile, ColumnSpec const &spec,
+                     std::size_t nPoints, int nFromAxes, int nToAxes)
+            : _inFile(inFile),
+              _outFile(outFile),
+              _spec(spec),
+              _nPoints(nPoints),
+              _nFromAxes(nFromAxes),
+              _nToAxes(nToAxes),
+              _nBlocks((nPoints + spec.blockSize - 1) / spec.blockSize),
+              _nextBlock(0),
+              _nBadPoints(0),
+              _failed(false),
+              _mutex(),
+              _error() {}
+
+    std::size_t getNBlocks() const { return _nBlocks; }
+
+    std::size_t getNBadPoints() const { return _nBadPoints; }
+
+    /// Rethrow the first exception thrown by `run`, if any
+    void rethrow() const {
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+    }
+
+    /**
+    Transform blocks until there are none left or a transform fails
+
+    @param[in] mapping  Mapping to use; must be locked by the calling thread
+
+    Exceptions are caught and saved, and stop all threads; call rethrow after all threads finish.
+    */
+    void run(Mapping const &mapping) noexcept {
+        try {
+            TransformWorkspace workspace(mapping, _spec.blockSize);
+            std::size_t nBadPoints = 0;
+            while (!_failed) {
+                std::size_t const block = _nextBlock++;
+                if (block >= _nBlocks) {
+                    break;
+                }
+                nBadPoints += _transformBlock(mapping, workspace, block);
+            }
+            _nBadPoints += nBadPoints;
+        } catch (...) {
+            _saveError();
+        }
+    }
+
+    /**
+    Lock a copy of the mapping for use by the calling thread, call run, then unlock the copy
+
+    @param[in] mapping  Mapping to use; must not be locked by another thread
+    */
+    void runLocked(Mapping &mapping) noexcept {
+        try {
+            mapping.lock(true);
+        } catch (...) {
+            _saveError();
+            return;
+        }
+        run(mapping);
+        try {
+            mapping.unlock();
+        } catch (...) {
+            _saveError();
+        }
+    }
+
+private:
+    // Save the current exception, unless one has already been saved, and tell all threads to stop
+    void _saveError() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_error) {
+            _error = std::current_exception();
+        }
+        _failed = true;
+    }
+
+    // Transform one block and return the number of bad points
+    std::size_t _transformBlock(Mapping const &mapping, TransformWorkspace &workspace, std::size_t block) {
+        std::size_t const begin = block * _spec.blockSize;
+        std::size_t const nPts = std::min(_spec.blockSize, _nPoints - begin);
+        std::size_t const prefetchBegin = begin + _spec.prefetchBlocks * _spec.blockSize;
+        if ((_spec.prefetchBlocks > 0) && (prefetchBegin < _nPoints)) {
+            _forEachRange(prefetchBegin, std::min(_spec.blockSize, _nPoints - prefetchBegin), _nFromAxes,
+                          [this](std::size_t start, std::size_t n) { _inFile.prefetch(start, n); });
+        }
+
+        Array2D from = workspace.getInput(nPts, _spec.forward);
+        double const *inData = _inFile.getData();
+        for (int axis = 0; axis < _nFromAxes; ++axis) {
+            double *fromRow = from.getData() + axis * nPts;
+            for (std::size_t i = 0; i < nPts; ++i) {
+                double const val = inData[_index(begin + i, axis, _nFromAxes)];
+                fromRow[i] = (_spec.nanInputIsBad && std::isnan(val)) ? AST__BAD : val;
+            }
+        }
+        _forEachRange(begin, nPts, _nFromAxes,
+                      [this](std::size_t start, std::size_t n) { _inFile.release(start, n); });
+
+        Array2D to = _spec.forward ? mapping.applyForward(from, workspace) : mapping.applyInverse(from, workspace);
+
+        // bad values are NaN in the output of applyForward and applyInverse
+        bool const replaceBad = !std::isnan(_spec.badOutput);
+        std::vector<bool> isBad(nPts, false);
+        double *outData = _outFile.getData();
+        for (int axis = 0; axis < _nToAxes; ++axis) {
+            double const *toRow = to.getData() + axis * nPts;
+            for (std::size_t i = 0; i < nPts; ++i) {
+                double val = toRow[i];
+                if (std::isnan(val)) {
+                    isBad[i] = true;
+                    if (replaceBad) {
+                        val = _spec.badOutput;
+                    }
+                }
+                outData[_index(begin + i, axis, _nToAxes)] = val;
+            }
+        }
+        _forEachRange(begin, nPts, _nToAxes,
+                      [this](std::size_t start, std::size_t n) { _outFile.release(start, n); });
+        return std::count(isBad.begin(), isBad.end(), true);
+    }
+
+    // Return the index in a file of coordinate `axis` of point `point`
+    std::size_t _index(std::size_t point, int axis, int nAxes) const {
+        if (_spec.layout == ColumnLayout::INTERLEAVED) {
+            return point * nAxes + axis;
+        }
+        return axis * _nPoints + point;
+    }
+
+    // Call func(start, n) for each contiguous range of values in a file used by points [begin, begin + nPts)
+    template <typename Func>
+    void _forEachRange(std::size_t begin, std::size_t nPts, int nAxes, Func func) const {
+        if (_spec.layout == ColumnLayout::INTERLEAVED) {
+            func(begin * nAxes, nPts * nAxes);
+        } else {
+            for (int axis = 0; axis < nAxes; ++axis) {
+                func(axis * _nPoints + begin, nPts);
+            }
+        }
+    }
+
+    MappedFile const &_inFile;
+    MappedFile const &_outFile;
+    ColumnSpec const _spec;
+    std::size_t const _nPoints;
+    int const _nFromAxes;
+    int const _nToAxes;
+    std::size_t const _nBlocks;
+    std::atomic<std::size_t> _nextBlock;
+    std::atomic<std::size_t> _nBadPoints;
+    std::atomic<bool> _failed;
+    std::mutex _mutex;  // protects _error
+    std::exception_ptr _error;
+};
+
+}  // namespace
+
+TransformFileResult transformFile(Mapping const &mapping, std::string const &inputPath,
+                                  std::string const &outputPath, ColumnSpec const &spec) {
+    if (spec.blockSize == 0) {
+        throw std::invalid_argument("spec.blockSize must be positive");
+    }
+    if (spec.nThreads < 0) {
+        throw std::invalid_argument("spec.nThreads = " + std::to_string(spec.nThreads) + " < 0");
+    }
+    if (spec.prefetchBlocks < 0) {
+        throw std::invalid_argument("spec.prefetchBlocks = " + std::to_string(spec.prefetchBlocks) + " < 0");
+    }
+    if (inputPath == outputPath) {
+        throw std::invalid_argument("inputPath and outputPath must differ");
+    }
+    if (spec.forward ? !mapping.hasForward() : !mapping.hasInverse()) {
+        throw std::invalid_argument(spec.forward ? "The mapping has no forward transform"
+                                                 : "The mapping has no inverse transform");
+    }
+    int const nFromAxes = spec.forward ? mapping.getNIn() : mapping.getNOut();
+    int const nToAxes = spec.forward ? mapping.getNOut() : mapping.getNIn();
+
+    MappedFile const inFile(inputPath);
+    std::size_t const pointSize = nFromAxes * sizeof(double);
+    if (inFile.getSize() % pointSize != 0) {
+        std::ostringstream os;
+        os << "Size of " << inputPath << " = " << inFile.getSize() << " bytes is not a multiple of "
+           << pointSize << " bytes (" << nFromAxes << " doubles per point)";
+        throw std::invalid_argument(os.str());
+    }
+    std::size_t const nPoints = inFile.getSize() / pointSize;
+    MappedFile const outFile(outputPath, nPoints * nToAxes * sizeof(double));
+
+    detail::OpScope opScope("transformFile", mapping, nPoints);
+    opScope.setAxes(nFromAxes, nToAxes);
+    opScope.addBytes(inFile.getSize() + outFile.getSize());
+
+    BlockTransformer transformer(inFile, outFile, spec, nPoints, nFromAxes, nToAxes);
+    std::size_t nThreads = spec.nThreads > 0 ? spec.nThreads : std::thread::hardware_concurrency();
+    nThreads = std::max(std::size_t(1), std::min(nThreads, transformer.getNBlocks()));
+    if (nThreads == 1) {
+        transformer.run(mapping);
+    } else {
+        // AST objects may only be used by the thread that has locked them, so give each thread
+        // its own copy, unlocked here and locked by the thread that uses it
+        std::vector<std::shared_ptr<Mapping>> copies;
+        for (std::size_t i = 0; i < nThreads; ++i) {
+            copies.push_back(mapping.copy());
+            copies.back()->unlock();
+        }
+        std::vector<std::thread> threads;
+        for (auto &copy : copies) {
+            threads.emplace_back([&transformer, copy] { transformer.runLocked(*copy); });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        // lock the copies again so they can be annulled by this thread
+        for (auto &copy : copies) {
+            copy->lock(true);
+        }
+    }
+    transformer.rethrow();
+    outFile.sync();
+
+    TransformFileResult result;
+    result.nPoints = nPoints;
+    result.nBlocks = transformer.getNBlocks();
+    result.nBadPoints = transformer.getNBadPoints();
+    return result;
+}
+
+}  // namespace ast
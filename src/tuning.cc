@@ -0,0 +1,125 @@
+/*
+ * LSST Data Management System
+ * Copyright 2017 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "astshim/base.h"
+#include "astshim/tuning.h"
+
+namespace ast {
+namespace {
+
+/// Length of buffer for string-valued tuning parameters, including the terminating null
+int const TUNE_BUFFER_LEN = 200;
+
+/// Call astTuneC, returning the old value
+std::string tuneC(TuneStringParam param, char const *value) {
+    assertOK();
+    std::vector<char> buffer(TUNE_BUFFER_LEN, '\0');
+    astTuneC(getTuneName(param).c_str(), value, buffer.data(), TUNE_BUFFER_LEN);
+    assertOK();
+    return std::string(buffer.data());
+}
+
+}  // namespace
+
+std::string getTuneName(TuneParam param) {
+    switch (param) {
+        case TuneParam::ObjectCaching:
+            return "ObjectCaching";
+        case TuneParam::MemoryCaching:
+            return "MemoryCaching";
+    }
+    throw std::invalid_argument("Unknown tuning parameter");
+}
+
+std::string getTuneName(TuneStringParam param) {
+    switch (param) {
+        case TuneStringParam::HRDel:
+            return "HRDel";
+        case TuneStringParam::MRDel:
+            return "MRDel";
+        case TuneStringParam::LRDel:
+            return "LRDel";
+    }
+    throw std::invalid_argument("Unknown tuning parameter");
+}
+
+int tune(TuneParam param) {
+    assertOK();
+    int ret = astTune(getTuneName(param).c_str(), AST__TUNULL);
+    assertOK();
+    return ret;
+}
+
+int tune(TuneParam param, int value) {
+    if (value == AST__TUNULL) {
+        throw std::invalid_argument("value = AST__TUNULL is reserved for getting the current value");
+    }
+    assertOK();
+    int ret = astTune(getTuneName(param).c_str(), value);
+    assertOK();
+    return ret;
+}
+
+std::string tune(TuneStringParam param) { return tuneC(param, nullptr); }
+
+std::string tune(TuneStringParam param, std::string const &value) { return tuneC(param, value.c_str()); }
+
+ScopedTune::ScopedTune(TuneParam param, int value)
+        : _isString(false),
+          _restored(false),
+          _param(param),
+          _stringParam(),
+          _oldValue(tune(param, value)),
+          _oldStringValue() {}
+
+ScopedTune::ScopedTune(TuneStringParam param, std::string const &value)
+        : _isString(true),
+          _restored(false),
+          _param(),
+          _stringParam(param),
+          _oldValue(0),
+          _oldStringValue(tune(param, value)) {}
+
+ScopedTune::~ScopedTune() {
+    try {
+        restore();
+    } catch (...) {
+        // can't throw in a dtor
+    }
+}
+
+void ScopedTune::restore() {
+    if (_restored) {
+        return;
+    }
+    _restored = true;
+    if (_isString) {
+        tune(_stringParam, _oldStringValue);
+    } else {
+        tune(_param, _oldValue);
+    }
+}
+
+}  // namespace ast
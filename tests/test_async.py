@@ -0,0 +1,179 @@
+from __future__ import absolute_import, division, print_function
+import subprocess
+import sys
+import textwrap
+import threading
+import time
+import unittest
+
+import numpy as np
+from numpy.testing import assert_allclose
+
+import astshim as ast
+from astshim.test import MappingTestCase, makeForwardPolyMap, makeTwoWayPolyMap
+
+
+class TestAsync(MappingTestCase):
+
+    def setUp(self):
+        self.mapping = makeTwoWayPolyMap(2, 3)
+        self.indata = np.random.uniform(-1, 1, size=(2, 1000))
+        self.pool = ast.ThreadPool(2, 4)
+
+    def callAndWait(self, start):
+        """Call ``start(callback)`` and wait for the callback; return its (result, error)"""
+        done = threading.Event()
+        reply = []
+
+        def callback(result, error):
+            reply.append((result, error))
+            done.set()
+
+        start(callback)
+        self.assertTrue(done.wait(10))
+        return reply[0]
+
+    def test_ThreadPool(self):
+        self.assertEqual(self.pool.nThreads, 2)
+        self.assertEqual(self.pool.maxQueued, 4)
+        self.assertGreaterEqual(self.pool.nQueued, 0)
+
+        default = ast.getDefaultThreadPool()
+        self.assertGreater(default.nThreads, 0)
+        try:
+            ast.setDefaultThreadPool(self.pool)
+            self.assertEqual(ast.getDefaultThreadPool().nThreads, 2)
+        finally:
+            ast.setDefaultThreadPool(default)
+
+        with self.assertRaises(ValueError):
+            ast.ThreadPool(-1)
+
+    def test_Callbacks(self):
+        predOut = self.mapping.applyForward(self.indata)
+        result, error = self.callAndWait(
+            lambda callback: self.mapping.applyForwardAsync(self.indata, callback, pool=self.pool))
+        self.assertIsNone(error)
+        assert_allclose(result, predOut)
+
+        result, error = self.callAndWait(
+            lambda callback: self.mapping.applyInverseAsync(predOut, callback, pool=self.pool))
+        self.assertIsNone(error)
+        assert_allclose(result, self.mapping.applyInverse(predOut))
+
+        # the default pool is used if none is specified
+        result, error = self.callAndWait(lambda callback: self.mapping.applyForwardAsync(self.indata, callback))
+        self.assertIsNone(error)
+        assert_allclose(result, predOut)
+
+        predGrid = self.mapping.tranGridForward([0, 0], [3, 4], 0, 100, 20)
+        result, error = self.callAndWait(
+            lambda callback: self.mapping.tranGridForwardAsync([0, 0], [3, 4], 0, 100, 20, callback))
+        self.assertIsNone(error)
+        assert_allclose(result, predGrid)
+
+    def test_ManyTransforms(self):
+        """Submit more transforms than the pool can queue, to exercise backpressure"""
+        nTransforms = 20
+        replies = [None] * nTransforms
+        done = [threading.Event() for i in range(nTransforms)]
+
+        def makeCallback(i):
+            def callback(result, error):
+                replies[i] = (result, error)
+                done[i].set()
+            return callback
+
+        for i in range(nTransforms):
+            self.mapping.applyForwardAsync(self.indata * (i + 1), makeCallback(i), pool=self.pool)
+        for i in range(nTransforms):
+            self.assertTrue(done[i].wait(10))
+        for i, (result, error) in enumerate(replies):
+            self.assertIsNone(error)
+            assert_allclose(result, self.mapping.applyForward(self.indata * (i + 1)))
+
+    def test_DropPool(self):
+        """Dropping the last reference to a pool with pending callbacks must not deadlock
+
+        Run in a subprocess so that a deadlock fails the test instead of hanging it.
+        """
+        code = textwrap.dedent("""
+            import threading
+            import numpy as np
+            import astshim as ast
+            from astshim.test import makeTwoWayPolyMap
+
+            mapping = makeTwoWayPolyMap(2, 3)
+            indata = np.random.uniform(-1, 1, size=(2, 1000))
+            done = [threading.Event() for i in range(5)]
+
+            def makeCallback(i):
+                return lambda result, error: done[i].set()
+
+            # a temporary pool, dropped as soon as the call returns
+            mapping.applyForwardAsync(indata, makeCallback(0), pool=ast.ThreadPool(1))
+            pool = ast.ThreadPool(1)
+            for i in range(1, 5):
+                mapping.applyForwardAsync(indata, makeCallback(i), pool=pool)
+            del pool
+            assert all(event.wait(10) for event in done)
+        """)
+        process = subprocess.Popen([sys.executable, "-c", code])
+        deadline = time.time() + 60
+        while process.poll() is None and time.time() < deadline:
+            time.sleep(0.1)
+        if process.poll() is None:
+            process.kill()
+            process.wait()
+            self.fail("Dropping a ThreadPool with pending callbacks deadlocked")
+        self.assertEqual(process.returncode, 0)
+
+    def test_Errors(self):
+        token = ast.CancellationToken()
+        self.assertFalse(token.isCancelled)
+        token.cancel()
+        self.assertTrue(token.isCancelled)
+        result, error = self.callAndWait(
+            lambda callback: self.mapping.applyForwardAsync(self.indata, callback, token, self.pool))
+        self.assertIsNone(result)
+        self.assertIsInstance(error, ast.OperationCancelled)
+
+        # argument errors are reported immediately
+        with self.assertRaises(ValueError):
+            self.mapping.applyForwardAsync(np.zeros((3, 10)), lambda result, error: None)
+
+        # transform errors are reported to the callback
+        forwardOnly = makeForwardPolyMap(2, 3)
+        result, error = self.callAndWait(
+            lambda callback: forwardOnly.applyInverseAsync(np.zeros((3, 5)), callback, pool=self.pool))
+        self.assertIsNone(result)
+        self.assertIsInstance(error, RuntimeError)
+
+    @unittest.skipIf(sys.version_info < (3, 5), "asyncio with await requires Python 3.5")
+    def test_Asyncio(self):
+        import asyncio
+
+        loop = asyncio.new_event_loop()
+        try:
+            predOut = self.mapping.applyForward(self.indata)
+            future = ast.awaitApplyForward(self.mapping, self.indata, pool=self.pool, loop=loop)
+            assert_allclose(loop.run_until_complete(future), predOut)
+
+            future = ast.awaitApplyInverse(self.mapping, predOut, pool=self.pool, loop=loop)
+            assert_allclose(loop.run_until_complete(future), self.mapping.applyInverse(predOut))
+
+            future = ast.awaitTranGridForward(self.mapping, [0, 0], [3, 4], 0, 100, 20, loop=loop)
+            assert_allclose(loop.run_until_complete(future),
+                            self.mapping.tranGridForward([0, 0], [3, 4], 0, 100, 20))
+
+            token = ast.CancellationToken()
+            token.cancel()
+            future = ast.awaitApplyForward(self.mapping, self.indata, token=token, loop=loop)
+            with self.assertRaises(ast.OperationCancelled):
+                loop.run_until_complete(future)
+        finally:
+            loop.close()
+
+
+if __name__ == "__main__":
+    unittest.main()
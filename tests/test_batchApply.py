@@ -0,0 +1,83 @@
+from __future__ import absolute_import, division, print_function
+import unittest
+
+import numpy as np
+from numpy.testing import assert_allclose, assert_equal
+
+import astshim as ast
+from astshim.detail.testUtils import getMaxTranChunk, setMaxTranChunk
+from astshim.test import MappingTestCase, makeForwardPolyMap, makeTwoWayPolyMap
+
+
+class TestBatchApply(MappingTestCase):
+
+    def setUp(self):
+        self.pool = ast.ThreadPool(3)
+        self.mappings = [
+            makeTwoWayPolyMap(2, 2),
+            ast.ZoomMap(2, 1.5),
+            ast.ShiftMap([1.0, -2.0]),
+        ]
+        # a mix of sizes, so some jobs are split and others packed together
+        self.sizes = [0, 1, 5, 20000, 3, 70000, 17, 4096]
+        self.jobs = [(self.mappings[i % len(self.mappings)], np.random.uniform(-1, 1, size=(2, nPts)))
+                     for i, nPts in enumerate(self.sizes)]
+
+    def test_Forward(self):
+        results = ast.batchApply(self.jobs, pool=self.pool)
+        self.assertEqual(len(results), len(self.jobs))
+        for (mapping, indata), result in zip(self.jobs, results):
+            self.assertEqual(result.shape, (mapping.nOut, indata.shape[1]))
+            assert_allclose(result, mapping.applyForward(indata))
+
+    def test_Inverse(self):
+        results = ast.batchApply(self.jobs, forward=False, pool=self.pool)
+        self.assertEqual(len(results), len(self.jobs))
+        for (mapping, indata), result in zip(self.jobs, results):
+            assert_allclose(result, mapping.applyInverse(indata))
+
+    def test_DefaultPool(self):
+        results = ast.batchApply(self.jobs)
+        for (mapping, indata), result in zip(self.jobs, results):
+            assert_allclose(result, mapping.applyForward(indata))
+
+    def test_SmallChunks(self):
+        """Units of work are limited by the maximum number of points per AST call"""
+        oldChunk = getMaxTranChunk()
+        try:
+            setMaxTranChunk(1000)
+            results = ast.batchApply(self.jobs, pool=self.pool)
+        finally:
+            setMaxTranChunk(oldChunk)
+        for (mapping, indata), result in zip(self.jobs, results):
+            assert_allclose(result, mapping.applyForward(indata))
+
+    def test_BadPoints(self):
+        """Points AST cannot transform are NaN"""
+        mapping = ast.MathMap(2, 2, ["y1 = sqrt(x1)", "y2 = x2"], ["x1 = y1 * y1", "x2 = y2"])
+        indata = np.random.uniform(0, 1, size=(2, 10000))
+        indata[0, ::7] = -1
+        results = ast.batchApply([(mapping, indata)], pool=self.pool)
+        assert_equal(np.isnan(results[0][0]), indata[0] < 0)
+        assert_allclose(results[0], mapping.applyForward(indata))
+
+    def test_Empty(self):
+        self.assertEqual(ast.batchApply([], pool=self.pool), [])
+
+    def test_Errors(self):
+        # wrong number of axes in one job: nothing is transformed
+        badJobs = list(self.jobs)
+        badJobs.append((self.mappings[0], np.zeros((3, 10))))
+        with self.assertRaises(ValueError):
+            ast.batchApply(badJobs, pool=self.pool)
+
+        # a job without the requested transform
+        forwardOnly = makeForwardPolyMap(2, 2)
+        badJobs = list(self.jobs)
+        badJobs.append((forwardOnly, np.zeros((2, 10))))
+        with self.assertRaises(RuntimeError):
+            ast.batchApply(badJobs, forward=False, pool=self.pool)
+
+
+if __name__ == "__main__":
+    unittest.main()
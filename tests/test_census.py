@@ -0,0 +1,72 @@
+from __future__ import absolute_import, division, print_function
+import unittest
+
+import astshim as ast
+from astshim.test import MappingTestCase
+
+
+class TestCensus(MappingTestCase):
+
+    def setUp(self):
+        self.wasEnabled = ast.census(1)
+
+    def tearDown(self):
+        ast.census(self.wasEnabled)
+
+    def getEntry(self, className):
+        """Return the total count and bytes for the specified class"""
+        count = 0
+        nBytes = 0
+        for entry in ast.getCensus():
+            if entry.className == className:
+                count += entry.count
+                nBytes += entry.bytes
+        return count, nBytes
+
+    def test_CountAndRelease(self):
+        initialCount, initialBytes = self.getEntry("ZoomMap")
+        zoomMaps = [ast.ZoomMap(2, 1.0 + i) for i in range(5)]
+        count, nBytes = self.getEntry("ZoomMap")
+        self.assertEqual(count, initialCount + 5)
+        self.assertEqual(nBytes, initialBytes + sum(zm.objSize for zm in zoomMaps))
+        self.assertGreaterEqual(ast.getCensusHighWaterMark(), ast.getCensusBytes())
+
+        # a copy is a new AST object
+        zoomCopy = zoomMaps[0].copy()
+        self.assertEqual(self.getEntry("ZoomMap")[0], initialCount + 6)
+
+        # objects are released when the last reference goes away, even if the census is disabled
+        highWaterMark = ast.getCensusHighWaterMark()
+        ast.census(0)
+        del zoomMaps
+        del zoomCopy
+        self.assertEqual(self.getEntry("ZoomMap"), (initialCount, initialBytes))
+        self.assertEqual(ast.getCensusHighWaterMark(), highWaterMark)
+        ast.resetCensusHighWaterMark()
+        self.assertEqual(ast.getCensusHighWaterMark(), ast.getCensusBytes())
+
+        # objects created while the census is disabled are not counted
+        zoomMap = ast.ZoomMap(2, 3.0)
+        self.assertEqual(self.getEntry("ZoomMap")[0], initialCount)
+        del zoomMap
+
+    def test_Remeasure(self):
+        frameSet = ast.FrameSet(ast.Frame(2))
+        initialBytes = self.getEntry("FrameSet")[1]
+        frameSet.addFrame(ast.FrameSet.CURRENT, ast.ZoomMap(2, 1.5), ast.Frame(2))
+        self.assertEqual(self.getEntry("FrameSet")[1], initialBytes)
+        ast.getCensus(remeasure=True)
+        self.assertGreater(self.getEntry("FrameSet")[1], initialBytes)
+
+    def test_DeepSize(self):
+        zoomMap = ast.ZoomMap(2, 1.5)
+        shiftMap = ast.ShiftMap([1.0, 2.0])
+        seriesMap = zoomMap.then(shiftMap)
+        self.assertEqual(ast.deepSize([zoomMap]), zoomMap.objSize)
+        self.assertEqual(ast.deepSize([zoomMap, shiftMap, zoomMap]),
+                         zoomMap.objSize + shiftMap.objSize)
+        self.assertGreater(ast.deepSize([seriesMap]), ast.deepSize([zoomMap, shiftMap]))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -56,6 +56,78 @@ class TestChannel(MappingTestCase):
         sinkData2 = ss.getSinkData()
         self.assertEqual(sinkData1, sinkData2)
 
+    def makeObjects(self):
+        """Make a variety of objects, including nested ones"""
+        objects = [ast.ZoomMap(2, 0.1 * (i + 1), "ID=zoom%d" % (i,)) for i in range(20)]
+        frameSet = ast.FrameSet(ast.Frame(2, "Domain=A"))
+        frameSet.addFrame(ast.FrameSet.CURRENT, ast.ShiftMap([1.0, 2.0]), ast.Frame(2, "Domain=B"))
+        objects.append(frameSet)
+        objects.append(ast.ZoomMap(2, 3.0).then(ast.ShiftMap([1.0, 2.0])))
+        return objects
+
+    def writeObjects(self, objects, options=""):
+        ss = ast.StringStream()
+        channel = ast.Channel(ss, options)
+        for obj in objects:
+            channel.write(obj)
+        ss.sinkToSource()
+        return ss
+
+    def test_ReadAll(self):
+        objects = self.makeObjects()
+        for options in ("", "Comment=0, Full=-1", "Full=1"):
+            channel = ast.Channel(self.writeObjects(objects, options))
+            readObjects = channel.readAll()
+            self.assertEqual([obj.show() for obj in readObjects], [obj.show() for obj in objects])
+            self.assertEqual(channel.readAll(), [])
+
+        # a small pool and look-ahead window
+        pool = ast.ThreadPool(2)
+        channel = ast.Channel(self.writeObjects(objects))
+        readObjects = channel.readAll(pool, maxLookahead=1)
+        self.assertEqual([obj.show() for obj in readObjects], [obj.show() for obj in objects])
+
+        # objects already read with read are not read again
+        channel = ast.Channel(self.writeObjects(objects))
+        channel.read()
+        self.assertEqual(len(channel.readAll()), len(objects) - 1)
+
+        with self.assertRaises(ValueError):
+            ast.FitsChan(ast.StringStream()).readAll()
+
+    def test_ChannelReader(self):
+        objects = self.makeObjects()
+        reader = ast.ChannelReader(ast.Channel(self.writeObjects(objects)), maxLookahead=3)
+        self.assertEqual(reader.maxLookahead, 3)
+        self.assertEqual(reader.nRead, 0)
+        readObjects = list(reader)
+        self.assertEqual(reader.nRead, len(objects))
+        self.assertEqual([obj.show() for obj in readObjects], [obj.show() for obj in objects])
+
+        reader = ast.ChannelReader(ast.Channel(self.writeObjects(objects)), ast.ThreadPool(3))
+        self.assertEqual(reader.maxLookahead, 3 * ast.ChannelReader.DEFAULT_LOOKAHEAD_PER_THREAD)
+        first = next(reader)
+        self.assertEqual(first.show(), objects[0].show())
+        del reader  # objects still being decoded are freed
+
+    def test_ChannelReaderErrors(self):
+        objects = self.makeObjects()[:3]
+        text = self.writeObjects(objects).getSourceData()
+        # damage the second object
+        second = text.index("Begin ZoomMap", text.index("Begin ZoomMap") + 1)
+        damaged = text[:second] + "Begin NoSuchMap" + text[second + len("Begin ZoomMap"):]
+        reader = ast.ChannelReader(ast.Channel(ast.StringStream(damaged)))
+        self.assertEqual(next(reader).show(), objects[0].show())
+        with self.assertRaises(RuntimeError):
+            next(reader)
+        self.assertEqual(next(reader).show(), objects[2].show())
+
+        # a truncated object
+        truncated = text[:text.rfind("End")]
+        channel = ast.Channel(ast.StringStream(truncated))
+        with self.assertRaises(RuntimeError):
+            channel.readAll()
+
 
 if __name__ == "__main__":
     unittest.main()
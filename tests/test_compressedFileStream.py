@@ -0,0 +1,161 @@
+from __future__ import absolute_import, division, print_function
+import gzip
+import os
+import shutil
+import tempfile
+import unittest
+
+import astshim as ast
+from astshim.test import MappingTestCase, makeTwoWayPolyMap
+
+HAVE_GZIP = ast.CompressedFileStream.isAvailable(ast.Compression.GZIP)
+
+
+class TestCompressedFileStream(MappingTestCase):
+
+    def setUp(self):
+        self.directory = tempfile.mkdtemp()
+        frameSet = ast.FrameSet(ast.Frame(2, "Domain=PIXELS"))
+        frameSet.addFrame(ast.FrameSet.CURRENT, makeTwoWayPolyMap(2, 2), ast.Frame(2, "Domain=FOCAL"))
+        frameSet.addFrame(ast.FrameSet.CURRENT, ast.ZoomMap(2, 0.5), ast.Frame(2, "Domain=SKY"))
+        self.frameSet = frameSet
+
+    def tearDown(self):
+        shutil.rmtree(self.directory)
+
+    def writeObject(self, obj, path, compression, chanClass=ast.Channel, **kwargs):
+        stream = ast.CompressedFileStream(path, True, compression, **kwargs)
+        self.assertEqual(stream.path, path)
+        self.assertEqual(stream.compression, compression)
+        nObj = chanClass(stream).write(obj)
+        self.assertEqual(nObj, 1)
+        stream.close()
+
+    def readObject(self, path, chanClass=ast.Channel, **kwargs):
+        stream = ast.CompressedFileStream(path, **kwargs)
+        obj = chanClass(stream).read()
+        return obj, stream.compression
+
+    def test_RoundTrip(self):
+        for compression in (ast.Compression.NONE, ast.Compression.GZIP, ast.Compression.ZSTD):
+            if not ast.CompressedFileStream.isAvailable(compression):
+                continue
+            for chanClass in (ast.Channel, ast.XmlChan):
+                path = os.path.join(self.directory, "frameSet")
+                self.writeObject(self.frameSet, path, compression, chanClass)
+                obj, detected = self.readObject(path, chanClass)
+                self.assertEqual(detected, compression)
+                self.assertEqual(obj.show(), self.frameSet.show())
+
+    @unittest.skipUnless(HAVE_GZIP, "astshim was built without zlib")
+    def test_Gzip(self):
+        """Test compatibility with gzip files written or read by other software
+        """
+        plainPath = os.path.join(self.directory, "plain.txt")
+        ast.Channel(ast.FileStream(plainPath, True)).write(self.frameSet)
+        with open(plainPath, "rb") as f:
+            plainData = f.read()
+
+        path = os.path.join(self.directory, "frameSet.gz")
+        self.writeObject(self.frameSet, path, ast.Compression.GZIP, level=9)
+        with gzip.open(path, "rb") as f:
+            self.assertEqual(f.read(), plainData)
+        self.assertLess(os.path.getsize(path), len(plainData))
+
+        # concatenated gzip streams are read as one
+        gzipPath = os.path.join(self.directory, "gzip.gz")
+        with gzip.open(gzipPath, "wb") as f:
+            f.write(plainData[:100])
+        with gzip.open(gzipPath, "ab") as f:
+            f.write(plainData[100:])
+        obj, detected = self.readObject(gzipPath)
+        self.assertEqual(detected, ast.Compression.GZIP)
+        self.assertEqual(obj.show(), self.frameSet.show())
+
+        # uncompressed files are detected, and read like FileStream would
+        obj, detected = self.readObject(plainPath)
+        self.assertEqual(detected, ast.Compression.NONE)
+        self.assertEqual(obj.show(), self.frameSet.show())
+
+    @unittest.skipUnless(HAVE_GZIP, "astshim was built without zlib")
+    def test_SmallBuffers(self):
+        path = os.path.join(self.directory, "frameSet.gz")
+        self.writeObject(self.frameSet, path, ast.Compression.GZIP, bufferSize=7)
+        obj, detected = self.readObject(path, bufferSize=5)
+        self.assertEqual(obj.show(), self.frameSet.show())
+
+        with self.assertRaises(ValueError):
+            ast.CompressedFileStream(path, bufferSize=0)
+
+    @unittest.skipUnless(HAVE_GZIP, "astshim was built without zlib")
+    def test_Close(self):
+        path = os.path.join(self.directory, "frameSet.gz")
+        stream = ast.CompressedFileStream(path, True)
+        channel = ast.Channel(stream)
+        channel.write(self.frameSet)
+        stream.close()
+        stream.close()
+        with self.assertRaises(RuntimeError):
+            channel.write(self.frameSet)
+        obj, detected = self.readObject(path)
+        self.assertEqual(obj.show(), self.frameSet.show())
+
+    def test_Errors(self):
+        with self.assertRaises(RuntimeError):
+            ast.CompressedFileStream(os.path.join(self.directory, "missing.gz"))
+        with self.assertRaises(RuntimeError):
+            ast.CompressedFileStream(os.path.join(self.directory, "noDir", "a.gz"), True)
+        for compression, name in ((ast.Compression.GZIP, "a.gz"), (ast.Compression.ZSTD, "a.zst")):
+            if not ast.CompressedFileStream.isAvailable(compression):
+                with self.assertRaises(RuntimeError):
+                    ast.CompressedFileStream(os.path.join(self.directory, name), True, compression)
+        if not HAVE_GZIP:
+            return
+
+        # a truncated file cannot be read
+        path = os.path.join(self.directory, "frameSet.gz")
+        self.writeObject(self.frameSet, path, ast.Compression.GZIP)
+        with open(path, "rb") as f:
+            data = f.read()
+        with open(path, "wb") as f:
+            f.write(data[:len(data) // 2])
+        with self.assertRaises(RuntimeError):
+            self.readObject(path)
+
+    @unittest.skipUnless(HAVE_GZIP, "astshim was built without zlib")
+    def test_TruncatedBetweenObjects(self):
+        """A file that is cut between objects must not look like a shorter file
+        """
+        # one gzip stream per object, so the file can be cut in the header of the second stream
+        zoomMap = ast.ZoomMap(2, 1.5)
+        data = []
+        for i, obj in enumerate((self.frameSet, zoomMap)):
+            objPath = os.path.join(self.directory, "object%d.gz" % (i,))
+            self.writeObject(obj, objPath, ast.Compression.GZIP)
+            with open(objPath, "rb") as f:
+                data.append(f.read())
+        path = os.path.join(self.directory, "objects.gz")
+        with open(path, "wb") as f:
+            f.write(data[0] + data[1])
+        readObjects = ast.Channel(ast.CompressedFileStream(path)).readAll()
+        self.assertEqual([obj.show() for obj in readObjects], [self.frameSet.show(), zoomMap.show()])
+
+        with open(path, "wb") as f:
+            f.write(data[0] + data[1][:10])
+        stream = ast.CompressedFileStream(path)
+        channel = ast.Channel(stream)
+        self.assertEqual(channel.read().show(), self.frameSet.show())
+        # reading fails because of the truncation, not because there are no more objects
+        with self.assertRaises(RuntimeError) as cm:
+            channel.read()
+        self.assertIn("truncated", str(cm.exception))
+        with self.assertRaises(RuntimeError) as cm:
+            stream.close()
+        self.assertIn("truncated", str(cm.exception))
+        with self.assertRaises(RuntimeError) as cm:
+            ast.Channel(ast.CompressedFileStream(path)).readAll()
+        self.assertIn("truncated", str(cm.exception))
+
+
+if __name__ == "__main__":
+    unittest.main()
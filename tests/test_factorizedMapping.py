@@ -0,0 +1,110 @@
+from __future__ import absolute_import, division, print_function
+import unittest
+
+import numpy as np
+from numpy.testing import assert_allclose
+
+import astshim as ast
+from astshim.test import MappingTestCase
+
+
+class TestFactorizedMapping(MappingTestCase):
+
+    def setUp(self):
+        self.indata = np.random.uniform(-10, 10, size=(3, 100))
+
+    def checkFactors(self, mapping, factors):
+        """Check that factors cover the inputs and outputs once and agree with the mapping"""
+        self.assertEqual(sorted(i for f in factors for i in f.origIn), list(range(1, mapping.nIn + 1)))
+        self.assertEqual(sorted(i for f in factors for i in f.origOut), list(range(1, mapping.nOut + 1)))
+        indata = self.indata[:mapping.nIn]
+        outdata = mapping.applyForward(indata)
+        for factor in factors:
+            self.assertEqual(factor.splitMap.nIn, len(factor.origIn))
+            self.assertEqual(factor.splitMap.nOut, len(factor.origOut))
+            factorOut = factor.splitMap.applyForward(indata[[i - 1 for i in factor.origIn]])
+            assert_allclose(factorOut, outdata[[i - 1 for i in factor.origOut]])
+
+    def checkFactorized(self, mapping, nFactors):
+        factorized = ast.FactorizedMapping(mapping)
+        self.assertEqual(factorized.nIn, mapping.nIn)
+        self.assertEqual(factorized.nOut, mapping.nOut)
+        self.assertEqual(factorized.nFactors, nFactors)
+        self.assertEqual(factorized.isSeparable, nFactors > 1)
+        self.checkFactors(mapping, factorized.factors)
+
+        indata = self.indata[:mapping.nIn]
+        outdata = factorized.applyForward(indata)
+        assert_allclose(outdata, mapping.applyForward(indata))
+        if mapping.hasInverse:
+            self.assertTrue(factorized.hasInverse)
+            assert_allclose(factorized.applyInverse(outdata), mapping.applyInverse(outdata))
+        return factorized
+
+    def test_IndependentAxes(self):
+        zoomMap = ast.ZoomMap(3, 1.5)
+        factors = zoomMap.factorize()
+        self.assertEqual([f.origIn for f in factors], [[1], [2], [3]])
+        self.assertEqual([f.origOut for f in factors], [[1], [2], [3]])
+        self.checkFactorized(zoomMap, 3)
+
+    def test_Groups(self):
+        # a 2-D rotation (inseparable) beside a 1-D shift
+        rotation = ast.MatrixMap(np.array([[0.6, -0.8], [0.8, 0.6]]))
+        mapping = rotation.under(ast.ShiftMap([5.0]))
+        factors = mapping.factorize()
+        self.assertEqual([f.origIn for f in factors], [[1, 2], [3]])
+        self.assertEqual([f.origOut for f in factors], [[1, 2], [3]])
+        self.checkFactorized(mapping, 2)
+
+        # permute the axes so groups use non-adjacent rows
+        inPerm = ast.PermMap([2, 3, 1], [3, 1, 2])
+        outPerm = ast.PermMap([3, 1, 2], [2, 3, 1])
+        permuted = inPerm.then(mapping).then(outPerm)
+        factorized = self.checkFactorized(permuted, 2)
+        for factor in factorized.factors:
+            self.assertEqual(len(factor.origIn), len(factor.origOut))
+
+    def test_Unsplittable(self):
+        rotation = ast.MatrixMap(np.array([[0.6, -0.8], [0.8, 0.6]]))
+        factors = rotation.factorize()
+        self.assertEqual(len(factors), 1)
+        self.assertEqual(factors[0].origIn, [1, 2])
+        self.assertEqual(factors[0].origOut, [1, 2])
+        self.checkFactorized(rotation, 1)
+
+        # an output that is a constant is fed by no input, so the mapping is not split
+        permMap = ast.PermMap([1, 2], [1, -1, 2], [7.5])
+        factors = permMap.factorize()
+        self.assertEqual(len(factors), 1)
+        self.assertEqual(factors[0].origOut, [1, 2, 3])
+        factorized = ast.FactorizedMapping(permMap)
+        assert_allclose(factorized.applyForward(self.indata[:2]), permMap.applyForward(self.indata[:2]))
+
+    def test_Tabulate1DFactors(self):
+        # a costly 1-D mapping beside an inseparable 2-D group
+        rotation = ast.MatrixMap(np.array([[0.6, -0.8], [0.8, 0.6]]))
+        mathMap = ast.MathMap(1, 1, ["y = exp(x / 30) + sin(x / 5)"], ["x = y"])
+        mapping = rotation.under(mathMap)
+        factorized = ast.FactorizedMapping(mapping)
+        self.assertEqual(factorized.nFactors, 2)
+        tol = 1e-6
+        nTabulated = factorized.tabulate1DFactors([-10, -10, -10], [10, 10, 10], tol)
+        self.assertEqual(nTabulated, 1)
+        self.assertEqual(factorized.factors[1].splitMap.className, "LutMap")
+        assert_allclose(factorized.applyForward(self.indata), mapping.applyForward(self.indata),
+                        atol=tol * 1.5)
+
+        with self.assertRaises(ValueError):
+            factorized.tabulate1DFactors([-10, -10], [10, 10], tol)
+
+    def test_Errors(self):
+        factorized = ast.FactorizedMapping(ast.ZoomMap(2, 1.5))
+        with self.assertRaises(ValueError):
+            factorized.applyForward(self.indata)
+        with self.assertRaises(ValueError):
+            factorized.applyInverse(self.indata)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,197 @@
+from __future__ import absolute_import, division, print_function
+import os
+import shutil
+import struct
+import tempfile
+import time
+import unittest
+
+import numpy as np
+from numpy.testing import assert_allclose, assert_equal
+
+import astshim as ast
+from astshim.test import MappingTestCase
+
+
+class TestFitCache(MappingTestCase):
+
+    def setUp(self):
+        self.directory = tempfile.mkdtemp()
+        self.oldDefaultCache = ast.getDefaultFitCache()
+        coeff_f = np.array([
+            [1., 1, 1, 0],
+            [1., 1, 0, 1],
+            [1., 2, 1, 0],
+            [-1., 2, 0, 1]
+        ])
+        self.polyMap = ast.PolyMap(coeff_f, 2, "IterInverse=0")
+        self.indata = np.array([
+            [0.1, 0.2, 0.3],
+            [0.0, 0.1, 0.2],
+        ])
+
+    def tearDown(self):
+        ast.setDefaultFitCache(self.oldDefaultCache)
+        shutil.rmtree(self.directory)
+
+    def fitPolyMap(self):
+        return self.polyMap.polyTran(False, 1.0e-10, 1.0e-10, 4, [-1.0, -1.0], [1.0, 1.0])
+
+    def test_PolyTran(self):
+        uncachedFit = self.fitPolyMap()
+
+        cache = ast.FitCache(self.directory)
+        ast.setDefaultFitCache(cache)
+        self.assertEqual(cache.directory, self.directory)
+        self.assertEqual(cache.maxBytes, ast.FitCache.DEFAULT_MAX_BYTES)
+
+        fit1 = self.fitPolyMap()
+        self.assertEqual((cache.nHits, cache.nMisses, cache.nWrites, cache.nErrors), (0, 1, 1, 0))
+        self.assertGreater(cache.getBytes(), 0)
+        fit2 = self.fitPolyMap()
+        self.assertEqual((cache.nHits, cache.nMisses), (1, 1))
+        self.assertEqual(fit1.show(), uncachedFit.show())
+        self.assertEqual(fit2.show(), uncachedFit.show())
+        self.assertEqual(fit2.className, "PolyMap")
+        assert_allclose(fit2.applyInverse(fit2.applyForward(self.indata)), self.indata, atol=1e-10)
+
+        # different fit parameters are a different entry
+        self.polyMap.polyTran(False, 1.0e-9, 1.0e-9, 4, [-1.0, -1.0], [1.0, 1.0])
+        self.assertEqual((cache.nHits, cache.nMisses), (1, 2))
+
+        # another cache using the same directory (e.g. in another process) sees the results
+        cache2 = ast.FitCache(self.directory)
+        ast.setDefaultFitCache(cache2)
+        fit3 = self.fitPolyMap()
+        self.assertEqual((cache2.nHits, cache2.nMisses), (1, 0))
+        self.assertEqual(fit3.show(), uncachedFit.show())
+
+    def test_ChebyMapPolyTran(self):
+        ast.setDefaultFitCache(ast.FitCache(self.directory))
+        coeff_f = np.array([
+            [1.0, 1, 1, 0],
+            [0.5, 2, 0, 1],
+        ])
+        chebyMap = ast.ChebyMap(coeff_f, 2, [-1.0, -1.0], [1.0, 1.0])
+        fit1 = chebyMap.polyTran(False, 1.0e-10, 1.0e-10, 4, [-1.0, -1.0], [1.0, 1.0])
+        fit2 = chebyMap.polyTran(False, 1.0e-10, 1.0e-10, 4, [-1.0, -1.0], [1.0, 1.0])
+        self.assertEqual(ast.getDefaultFitCache().nHits, 1)
+        self.assertEqual(fit2.className, "ChebyMap")
+        self.assertEqual(fit1.show(), fit2.show())
+
+    def test_Approximations(self):
+        cache = ast.FitCache(self.directory)
+        ast.setDefaultFitCache(cache)
+        zoomMap = ast.ZoomMap(2, 1.5)
+
+        fit1 = zoomMap.linearApprox([0, 0], [10, 10], 1e-5)
+        fit2 = zoomMap.linearApprox([0, 0], [10, 10], 1e-5)
+        self.assertEqual((cache.nHits, cache.nMisses), (1, 1))
+        assert_equal(fit1, fit2)
+        assert_allclose(fit2, [[0, 0], [1.5, 0], [0, 1.5]])
+
+        qa1 = ast.QuadApprox(zoomMap, [0, 0], [10, 10])
+        qa2 = ast.QuadApprox(zoomMap, [0, 0], [10, 10])
+        self.assertEqual((cache.nHits, cache.nMisses), (2, 2))
+        assert_equal(qa1.fit, qa2.fit)
+        self.assertEqual(qa1.rms, qa2.rms)
+
+        # failures are not cached
+        with self.assertRaises(RuntimeError):
+            self.polyMap.linearApprox([-1, -1], [1, 1], 1e-10)
+        self.assertEqual(cache.nWrites, 2)
+
+    def test_DamagedFile(self):
+        cache = ast.FitCache(self.directory)
+        ast.setDefaultFitCache(cache)
+        fit1 = self.fitPolyMap()
+        paths = [os.path.join(self.directory, name) for name in os.listdir(self.directory)]
+        self.assertEqual(len(paths), 1)
+        with open(paths[0], "r+b") as f:
+            f.seek(-4, os.SEEK_END)
+            f.write(b"oops")
+
+        # the damaged file is ignored and replaced
+        fit2 = self.fitPolyMap()
+        self.assertEqual((cache.nHits, cache.nMisses, cache.nErrors), (0, 2, 1))
+        self.assertEqual(fit1.show(), fit2.show())
+        self.fitPolyMap()
+        self.assertEqual(cache.nHits, 1)
+
+    def test_DamagedPayloadSize(self):
+        cache = ast.FitCache(self.directory)
+        ast.setDefaultFitCache(cache)
+        fit1 = self.fitPolyMap()
+        paths = [os.path.join(self.directory, name) for name in os.listdir(self.directory)]
+        self.assertEqual(len(paths), 1)
+        # the payload size follows the 8-byte magic and the 8-byte key check;
+        # make it huge, leaving the magic and key check intact
+        with open(paths[0], "r+b") as f:
+            f.seek(16)
+            f.write(struct.pack("=Q", 2**62))
+
+        # the file is treated as damaged instead of failing to allocate the payload
+        fit2 = self.fitPolyMap()
+        self.assertEqual((cache.nHits, cache.nMisses, cache.nErrors), (0, 2, 1))
+        self.assertEqual(fit1.show(), fit2.show())
+
+    def test_Trim(self):
+        cache = ast.FitCache(self.directory, maxBytes=100)
+        data = b"x" * 60
+        cache.getOrCompute("a", lambda: data)
+        self.assertEqual(cache.getOrCompute("a", lambda: b""), data)
+        self.assertEqual(cache.nHits, 1)
+        self.assertLessEqual(cache.getBytes(), 100)
+
+        # make sure the first entry is older, even on file systems with coarse timestamps
+        oldTime = time.time() - 10
+        pathA = os.path.join(self.directory, os.listdir(self.directory)[0])
+        os.utime(pathA, (oldTime, oldTime))
+
+        # adding a second entry exceeds the limit, so the first is deleted
+        cache.getOrCompute("b", lambda: data)
+        self.assertLessEqual(cache.getBytes(), 100)
+        self.assertEqual(len(os.listdir(self.directory)), 1)
+        self.assertFalse(os.path.exists(pathA))
+
+        cache.clear()
+        self.assertEqual(cache.getBytes(), 0)
+
+    def test_TrimStaleTempFiles(self):
+        cache = ast.FitCache(self.directory)
+        stalePath = os.path.join(self.directory, ".tmp.stale")
+        freshPath = os.path.join(self.directory, ".tmp.fresh")
+        for path in (stalePath, freshPath):
+            with open(path, "wb") as f:
+                f.write(b"partial")
+        oldTime = time.time() - 2 * 60 * 60
+        os.utime(stalePath, (oldTime, oldTime))
+
+        # the stale file was left by a process that died; the fresh one may still be in use
+        cache.trim()
+        self.assertFalse(os.path.exists(stalePath))
+        self.assertTrue(os.path.exists(freshPath))
+        self.assertEqual(cache.getBytes(), 0)
+
+    def test_MakeKey(self):
+        zoomMap = ast.ZoomMap(2, 1.5)
+        key = ast.FitCache.makeKey("op", zoomMap, "1 2")
+        self.assertEqual(key, ast.FitCache.makeKey("op", zoomMap.copy(), "1 2"))
+        self.assertNotEqual(key, ast.FitCache.makeKey("op", zoomMap, "1 3"))
+        self.assertNotEqual(key, ast.FitCache.makeKey("op", ast.ZoomMap(2, 1.6), "1 2"))
+
+    def test_CreateDirectory(self):
+        directory = os.path.join(self.directory, "a", "b")
+        cache = ast.FitCache(directory)
+        self.assertTrue(os.path.isdir(directory))
+        self.assertEqual(cache.getBytes(), 0)
+
+        filePath = os.path.join(self.directory, "aFile")
+        with open(filePath, "w") as f:
+            f.write("not a directory")
+        with self.assertRaises(RuntimeError):
+            ast.FitCache(filePath)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,128 @@
+from __future__ import absolute_import, division, print_function
+import unittest
+
+import numpy as np
+from numpy.testing import assert_allclose
+
+import astshim as ast
+from astshim.test import MappingTestCase
+
+
+class TestFrameSetRouter(MappingTestCase):
+
+    def setUp(self):
+        self.frameDict = ast.FrameDict(ast.Frame(2, "Domain=PIXELS"))
+        self.frameDict.addFrame("PIXELS", ast.ZoomMap(2, 0.5), ast.Frame(2, "Domain=FOCAL_PLANE"))
+        self.frameDict.addFrame("FOCAL_PLANE", ast.ShiftMap([1.0, -2.0]), ast.Frame(2, "Domain=FIELD_ANGLE"))
+        self.frameDict.addFrame("PIXELS", ast.ShiftMap([0.25, 0.5]), ast.Frame(2, "Domain=ACTUAL_PIXELS"))
+        self.domains = ["PIXELS", "FOCAL_PLANE", "FIELD_ANGLE", "ACTUAL_PIXELS"]
+        self.indata = np.random.uniform(-100, 100, size=(2, 50))
+
+    def test_Basics(self):
+        router = ast.FrameSetRouter(self.frameDict)
+        self.assertEqual(router.nFrame, 4)
+        self.assertTrue(router.simplify)
+        self.assertEqual(router.getAllDomains(), set(self.domains))
+        self.assertTrue(router.hasDomain("field_angle"))
+        self.assertFalse(router.hasDomain("SKY"))
+        self.assertEqual(router.getIndex("focal_plane"), 2)
+        self.assertEqual(router.nMaterialized, 0)
+        self.assertEqual(router.nHits, 0)
+        self.assertEqual(router.nMisses, 0)
+
+        # the FrameSet is copied
+        self.frameDict.removeFrame("ACTUAL_PIXELS")
+        self.assertEqual(router.nFrame, 4)
+
+        # a plain FrameSet may also be used
+        router = ast.FrameSetRouter(ast.FrameSet(self.frameDict))
+        self.assertEqual(router.nFrame, 3)
+
+        # frames with duplicate domains cannot be routed by domain
+        frameSet = ast.FrameSet(ast.Frame(2, "Domain=A"), ast.UnitMap(2), ast.Frame(2, "Domain=A"))
+        with self.assertRaises(ValueError):
+            ast.FrameSetRouter(frameSet)
+
+    def test_LazyMappings(self):
+        router = ast.FrameSetRouter(self.frameDict)
+        for fromDomain in self.domains:
+            for toDomain in self.domains:
+                desired = self.frameDict.getMapping(fromDomain, toDomain).applyForward(self.indata)
+                assert_allclose(router.transform(fromDomain, toDomain, self.indata), desired)
+                self.assertTrue(router.isMaterialized(fromDomain, toDomain))
+        nPairs = len(self.domains)**2
+        self.assertEqual(router.nMaterialized, nPairs)
+        self.assertEqual(router.nMisses, nPairs)
+        self.assertEqual(router.nHits, 0)
+
+        # repeat lookups use the cache
+        assert_allclose(router.transform("PIXELS", "FIELD_ANGLE", self.indata),
+                        self.frameDict.getMapping("PIXELS", "FIELD_ANGLE").applyForward(self.indata))
+        assert_allclose(router.transform(2, 1, self.indata),
+                        self.frameDict.getMapping(2, 1).applyForward(self.indata))
+        self.assertEqual(router.nMaterialized, nPairs)
+        self.assertEqual(router.nHits, 2)
+
+        # BASE and CURRENT refer to the same cached mappings as their indices
+        self.assertTrue(router.isMaterialized(ast.FrameSet.BASE, ast.FrameSet.CURRENT))
+        assert_allclose(router.transform(ast.FrameSet.BASE, ast.FrameSet.CURRENT, self.indata),
+                        self.frameDict.getMapping().applyForward(self.indata))
+        self.assertEqual(router.nHits, 3)
+
+        router.clear()
+        self.assertEqual(router.nMaterialized, 0)
+        self.assertEqual(router.nHits, 0)
+        self.assertEqual(router.nMisses, 0)
+        self.assertFalse(router.isMaterialized("PIXELS", "FIELD_ANGLE"))
+
+    def test_Simplify(self):
+        router = ast.FrameSetRouter(self.frameDict)
+        mapping = router.getMapping("PIXELS", "FIELD_ANGLE")
+        self.assertTrue(mapping.isSimple)
+        self.assertEqual(router.nMisses, 1)
+
+        # getMapping returns a copy, so modifying it does not affect the router
+        mapping.ident = "modified"
+        self.assertNotEqual(router.getMapping("PIXELS", "FIELD_ANGLE").ident, "modified")
+        self.assertEqual(router.nHits, 1)
+
+        router = ast.FrameSetRouter(self.frameDict, simplify=False)
+        self.assertFalse(router.simplify)
+        mapping = router.getMapping("PIXELS", "FIELD_ANGLE")
+        self.assertFalse(mapping.isSimple)
+        assert_allclose(mapping.applyForward(self.indata),
+                        self.frameDict.getMapping("PIXELS", "FIELD_ANGLE").applyForward(self.indata))
+
+    def test_Precompute(self):
+        router = ast.FrameSetRouter(self.frameDict)
+        router.precompute([("PIXELS", "FIELD_ANGLE"), ("FIELD_ANGLE", "PIXELS"), ("pixels", "field_angle")])
+        self.assertEqual(router.nMaterialized, 2)
+        self.assertEqual(router.nMisses, 2)
+        self.assertEqual(router.nHits, 0)
+        self.assertTrue(router.isMaterialized("FIELD_ANGLE", "PIXELS"))
+        self.assertFalse(router.isMaterialized("PIXELS", "FOCAL_PLANE"))
+
+        router.precomputeAll()
+        nFrame = len(self.domains)
+        self.assertEqual(router.nMaterialized, nFrame * (nFrame - 1))
+        self.assertEqual(router.nHits, 0)
+
+    def test_Errors(self):
+        router = ast.FrameSetRouter(self.frameDict)
+        with self.assertRaises(IndexError):
+            router.transform("PIXELS", "SKY", self.indata)
+        with self.assertRaises(IndexError):
+            router.getMapping(-5, 1)
+        with self.assertRaises(IndexError):
+            router.getMapping(1, 5)
+        with self.assertRaises(IndexError):
+            router.precompute([("PIXELS", "FOCAL_PLANE"), ("PIXELS", "SKY")])
+        # pairs before the bad one are computed
+        self.assertTrue(router.isMaterialized("PIXELS", "FOCAL_PLANE"))
+        with self.assertRaises(ValueError):
+            router.transform("PIXELS", "FOCAL_PLANE", np.zeros((3, 5)))
+        self.assertEqual(router.nMaterialized, 1)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,200 @@
+from __future__ import absolute_import, division, print_function
+import json
+import os
+import tempfile
+import unittest
+
+import numpy as np
+
+import astshim as ast
+from astshim.test import MappingTestCase
+
+
+class TestInstrumentation(MappingTestCase):
+
+    def setUp(self):
+        self.wasEnabled = ast.instrumentation(1)
+        ast.resetInstrumentationStats()
+
+    def tearDown(self):
+        ast.instrumentation(self.wasEnabled)
+        ast.resetInstrumentationStats()
+
+    def getStats(self, operation, className, ident=""):
+        """Return the OpStats for the specified key, or None if not found"""
+        for stats in ast.getInstrumentationStats():
+            if (stats.operation, stats.className, stats.ident) == (operation, className, ident):
+                return stats
+        return None
+
+    def test_EnableDisable(self):
+        self.assertTrue(ast.instrumentation())
+        self.assertTrue(ast.instrumentation(0))
+        self.assertFalse(ast.instrumentation())
+
+        zoommap = ast.ZoomMap(2, 1.5)
+        zoommap.applyForward(np.zeros([2, 10]))
+        self.assertEqual(ast.getInstrumentationStats(), [])
+
+        self.assertFalse(ast.instrumentation(1))
+        self.assertTrue(ast.instrumentation())
+
+    def test_TranCounters(self):
+        zoommap = ast.ZoomMap(2, 1.5)
+        nPoints = 25
+        zoommap.applyForward(np.zeros([2, nPoints]))
+        zoommap.applyForward(np.zeros([2, nPoints]))
+        zoommap.applyInverse(np.zeros([2, nPoints]))
+
+        stats = self.getStats("tranForward", "ZoomMap")
+        self.assertEqual(stats.calls, 2)
+        self.assertEqual(stats.points, 2*nPoints)
+        self.assertGreater(stats.nanoseconds, 0)
+        self.assertEqual(stats.bytes, 0)
+        stats = self.getStats("tranInverse", "ZoomMap")
+        self.assertEqual(stats.calls, 1)
+        self.assertEqual(stats.points, nPoints)
+
+        # tag a mapping with an ident to get separate counters
+        zoommap.ident = "hot"
+        zoommap.applyForward(np.zeros([2, nPoints]))
+        stats = self.getStats("tranForward", "ZoomMap", "hot")
+        self.assertEqual(stats.calls, 1)
+        self.assertEqual(stats.points, nPoints)
+        self.assertEqual(self.getStats("tranForward", "ZoomMap").calls, 2)
+
+        ast.resetInstrumentationStats()
+        self.assertEqual(ast.getInstrumentationStats(), [])
+
+    def test_CachedCounters(self):
+        """Test that the counters cached for each object follow changes to its ident
+        and are not reused for new objects
+        """
+        zoommap = ast.ZoomMap(2, 1.5)
+        data = np.zeros([2, 5])
+        zoommap.applyForward(data)
+        zoommap.set("Ident=a")
+        zoommap.applyForward(data)
+        zoommap.clear("Ident")
+        zoommap.applyForward(data)
+        self.assertEqual(self.getStats("tranForward", "ZoomMap").calls, 2)
+        self.assertEqual(self.getStats("tranForward", "ZoomMap", "a").calls, 1)
+
+        # Ident may be set along with other attributes, in any case
+        zoommap.set("Report=0, IDENT=d")
+        zoommap.applyForward(data)
+        self.assertEqual(self.getStats("tranForward", "ZoomMap", "d").calls, 1)
+        zoommap.set("Report=0")
+        zoommap.applyForward(data)
+        self.assertEqual(self.getStats("tranForward", "ZoomMap", "d").calls, 2)
+        zoommap.clear("Ident")
+
+        # new objects may be allocated where freed ones were
+        for i in range(20):
+            mapping = ast.ShiftMap([1.0, 2.0]) if i % 2 else ast.ZoomMap(2, 1.5, "Ident=b")
+            mapping.applyForward(data)
+            del mapping
+        self.assertEqual(self.getStats("tranForward", "ShiftMap").calls, 10)
+        self.assertEqual(self.getStats("tranForward", "ZoomMap", "b").calls, 10)
+
+        # the counters cached while enabled are not used after instrumentation is re-enabled
+        ast.instrumentation(0)
+        zoommap.ident = "c"
+        ast.instrumentation(1)
+        zoommap.applyForward(data)
+        self.assertEqual(self.getStats("tranForward", "ZoomMap", "c").calls, 1)
+
+    def test_OtherOperations(self):
+        shiftmap = ast.ShiftMap([1.0, 2.0])
+        shiftmap.tranGridForward([0, 0], [3, 4], 0, 100, 4*5)
+        self.assertEqual(self.getStats("tranGridForward", "ShiftMap").points, 4*5)
+
+        shiftmap.linearApprox([0, 0], [1, 1], 1e-5)
+        self.assertEqual(self.getStats("linearApprox", "ShiftMap").calls, 1)
+
+        ast.MapBox(shiftmap, [0, 0], [1, 1])
+        self.assertEqual(self.getStats("mapBox", "ShiftMap").calls, 1)
+
+    def test_ChannelCounters(self):
+        zoommap = ast.ZoomMap(2, 1.5)
+        outstream = ast.StringStream()
+        outchan = ast.Channel(outstream)
+        outchan.write(zoommap)
+        nBytes = len(outstream.getSinkData())
+        stats = self.getStats("write", "Channel")
+        self.assertEqual(stats.calls, 1)
+        self.assertEqual(stats.bytes, nBytes)
+
+        outstream.sinkToSource()
+        inchan = ast.Channel(outstream)
+        inchan.read()
+        stats = self.getStats("read", "Channel")
+        self.assertEqual(stats.calls, 1)
+        self.assertGreater(stats.bytes, 0)
+
+        fitsChan = ast.FitsChan(ast.StringStream())
+        cards = "".join("%-80s" % card for card in ("NAXIS   = 2", "NAXIS1  = 100"))
+        fitsChan.putCards(cards)
+        stats = self.getStats("putCards", "FitsChan")
+        self.assertEqual(stats.calls, 1)
+        self.assertEqual(stats.bytes, len(cards))
+
+
+
+class TestTracing(MappingTestCase):
+
+    def setUp(self):
+        self.wasEnabled = ast.tracing(1)
+        ast.clearTrace()
+
+    def tearDown(self):
+        ast.tracing(self.wasEnabled)
+        ast.clearTrace()
+
+    def getEvents(self):
+        return json.loads(ast.getTraceJson())["traceEvents"]
+
+    def test_TraceEvents(self):
+        zoommap = ast.ZoomMap(2, 1.5, "Ident=myzoom")
+        nPoints = 7
+        zoommap.applyForward(np.zeros([2, nPoints]))
+        zoommap.simplified()
+        events = self.getEvents()
+        self.assertEqual(len(events), 2)
+
+        event = events[0]
+        self.assertEqual(event["name"], "tranForward")
+        self.assertEqual(event["ph"], "X")
+        self.assertGreaterEqual(event["dur"], 0)
+        self.assertIn("tid", event)
+        self.assertEqual(event["args"]["className"], "ZoomMap")
+        self.assertEqual(event["args"]["ident"], "myzoom")
+        self.assertEqual(event["args"]["nPts"], nPoints)
+        self.assertEqual(event["args"]["nIn"], 2)
+        self.assertEqual(event["args"]["nOut"], 2)
+        self.assertEqual(events[1]["name"], "simplified")
+
+        ast.clearTrace()
+        self.assertEqual(self.getEvents(), [])
+
+        self.assertTrue(ast.tracing(0))
+        zoommap.applyForward(np.zeros([2, nPoints]))
+        self.assertEqual(self.getEvents(), [])
+
+    def test_WriteTrace(self):
+        shiftmap = ast.ShiftMap([1.0, 2.0])
+        shiftmap.tranGridForward([0, 0], [3, 4], 0.5, 100, 4*5)
+        dirName = tempfile.mkdtemp()
+        path = os.path.join(dirName, "trace.json")
+        ast.writeTrace(path)
+        with open(path) as f:
+            events = json.load(f)["traceEvents"]
+        os.remove(path)
+        os.rmdir(dirName)
+        self.assertEqual(len(events), 1)
+        self.assertEqual(events[0]["name"], "tranGridForward")
+        self.assertEqual(events[0]["args"]["tol"], 0.5)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -113,6 +113,48 @@ class TestMakeRadialMapping(MappingTestCase):
         with self.assertRaises(RuntimeError):
             ast.makeRadialMapping([], mapping1d)
 
+    def test_MakeRadialPolyMap(self):
+        """Test that makeRadialPolyMap matches makeRadialMapping with a polynomial mapping1d"""
+        coeffs = [0.0, 1.0, 0.0, 2.5e-4, 0.0, -3.0e-8]
+        coeff_f = np.array([[coeff, 1, power] for power, coeff in enumerate(coeffs) if coeff != 0])
+        mapping1d = ast.PolyMap(coeff_f, 1)
+
+        for center in (
+            [0.0],
+            [1.1],
+            [0.0, 0.0],
+            [-5.5, 4.7],
+            [0.0, 0.0, 0.0],
+            [1.1, 2.2, -3.3],
+        ):
+            naxes = len(center)
+            in_data = self.in_data_full[0:naxes]
+
+            radial_map = ast.makeRadialPolyMap(center, coeffs)
+            self.assertEqual(radial_map.className, "PolyMap")
+            self.assertEqual(radial_map.nIn, naxes)
+            self.assertEqual(radial_map.nOut, naxes)
+            self.assertTrue(radial_map.hasForward)
+            self.assertTrue(radial_map.hasInverse)
+            self.assertTrue(radial_map.iterInverse)
+
+            desired_out_data = ast.makeRadialMapping(center, mapping1d).applyForward(in_data)
+            npt.assert_allclose(radial_map.applyForward(in_data), desired_out_data, atol=1e-10)
+            self.checkRoundTrip(radial_map, in_data)
+            self.checkMappingPersistence(radial_map, in_data)
+
+        # without an iterative inverse there is no inverse
+        radial_map = ast.makeRadialPolyMap([1.0, 2.0], coeffs, "IterInverse=0")
+        self.assertFalse(radial_map.hasInverse)
+
+    def test_MakeRadialPolyMapErrorHandling(self):
+        """Test error handling in makeRadialPolyMap"""
+        with self.assertRaises(ValueError):
+            ast.makeRadialPolyMap([], [0.0, 1.0])
+        for coeffs in ([1.0, 1.0], [0.0, 1.0, 0.5], [0.0, 1.0, 0.0, 0.1, 0.2]):
+            with self.assertRaises(ValueError):
+                ast.makeRadialPolyMap([0.0, 0.0], coeffs)
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -2,9 +2,10 @@ from __future__ import absolute_import, division, print_function
 import unittest
 
 import numpy as np
-from numpy.testing import assert_allclose
+from numpy.testing import assert_allclose, assert_array_equal
 
 import astshim as ast
+from astshim.detail.testUtils import getMaxTranChunk, setMaxTranChunk
 from astshim.test import MappingTestCase, makeTwoWayPolyMap
 
 
@@ -139,6 +140,75 @@ class TestMapping(MappingTestCase):
         self.assertTrue(simpmap.hasForward)
         self.assertTrue(simpmap.hasInverse)
 
+    def test_MappingExplain(self):
+        # set Ident to prevent simplification from merging the component mappings
+        polyMap = makeTwoWayPolyMap(2, 3)
+        polyMap.ident = "poly"
+        lutMap = ast.LutMap([1.0, 2.0, 4.0, 8.0], 0, 1, "Ident=lut")
+        zoomMap = ast.ZoomMap(2, 2.0, "Ident=zoom")
+        mapping = polyMap.then(lutMap.under(zoomMap))
+
+        explanation = mapping.explain(nPoints=100, lbnd=[0, 0], ubnd=[1, 1])
+        self.assertEqual(explanation.className, "SeriesMap")
+        self.assertEqual(explanation.nIn, 2)
+        self.assertEqual(explanation.nOut, 3)
+        self.assertEqual(len(explanation.children), 2)
+        polyCost, parallelCost = explanation.children
+        self.assertEqual(polyCost.className, "PolyMap")
+        self.assertEqual(polyCost.ident, "poly")
+        self.assertEqual(polyCost.properties["order"], 2)
+        self.assertEqual(polyCost.properties["nTerms"], 6)
+        self.assertEqual(polyCost.properties["iterative"], 0)
+        self.assertEqual(parallelCost.className, "ParallelMap")
+        lutCost, zoomCost = parallelCost.children
+        self.assertEqual(lutCost.className, "LutMap")
+        self.assertEqual(lutCost.properties["lutSize"], 4)
+        self.assertEqual(zoomCost.className, "ZoomMap")
+        self.assertEqual(len(zoomCost.children), 0)
+        self.assertAlmostEqual(explanation.modelledCost, polyCost.modelledCost + parallelCost.modelledCost)
+        for cost in (explanation, polyCost, parallelCost, lutCost, zoomCost):
+            self.assertGreater(cost.measuredCost, 0)
+            self.assertEqual(cost.cost, cost.measuredCost)
+        self.assertIn("PolyMap \"poly\"", str(explanation))
+
+        # the inverse transform applies the components in reverse order; only model the costs
+        explanation = mapping.explain(forward=False, nPoints=0)
+        self.assertEqual(explanation.nIn, 3)
+        self.assertEqual(explanation.nOut, 2)
+        self.assertEqual(explanation.children[0].className, "ParallelMap")
+        self.assertEqual(explanation.children[1].className, "PolyMap")
+        self.assertTrue(np.isnan(explanation.measuredCost))
+        self.assertEqual(explanation.cost, explanation.modelledCost)
+        self.assertGreater(explanation.cost, 0)
+
+        # simplification can leave an inverted compound mapping, whose components are not inverted
+        zoomPoly = ast.ZoomMap(2, 2.0, "Ident=zoom").then(makeTwoWayPolyMap(2, 3)).inverted()
+        for forward, childNames in ((True, ["PolyMap", "ZoomMap"]), (False, ["ZoomMap", "PolyMap"])):
+            explanation = zoomPoly.explain(forward=forward, nPoints=100)
+            self.assertEqual(explanation.className, "SeriesMap")
+            self.assertEqual([child.className for child in explanation.children], childNames)
+            firstCost, secondCost = explanation.children
+            self.assertEqual(firstCost.nIn, 3 if forward else 2)
+            self.assertEqual(firstCost.nOut, 2)
+            self.assertEqual(secondCost.nOut, 2 if forward else 3)
+            for cost in (explanation, firstCost, secondCost):
+                self.assertGreater(cost.measuredCost, 0)
+
+        parallel = makeTwoWayPolyMap(2, 3).under(ast.ZoomMap(1, 2.0, "Ident=zoom")).inverted()
+        explanation = parallel.explain(nPoints=100)
+        self.assertEqual(explanation.nIn, 4)
+        self.assertEqual(explanation.nOut, 3)
+        polyCost, zoomCost = explanation.children
+        self.assertEqual((polyCost.nIn, polyCost.nOut), (3, 2))
+        self.assertEqual((zoomCost.nIn, zoomCost.nOut), (1, 1))
+        for cost in (explanation, polyCost, zoomCost):
+            self.assertGreater(cost.measuredCost, 0)
+
+        with self.assertRaises(ValueError):
+            mapping.explain(lbnd=[0, 0, 0])
+        with self.assertRaises(ValueError):
+            mapping.explain(nPoints=-1)
+
     def test_MapSplit(self):
         """Test MapSplit for a simple case"""
         for i in range(self.nin):
@@ -148,6 +218,173 @@ class TestMapping(MappingTestCase):
             self.assertEqual(split.splitMap.nOut, 1)
             self.assertEqual(split.origOut[0], i + 1)
 
+    def test_ApplyInPlace(self):
+        """Test applyForwardInPlace and applyInverseInPlace, with and without a workspace
+        """
+        # a MatrixMap with off-diagonal terms needs every input axis to compute each output axis
+        mapping = ast.MatrixMap(np.array([[1.0, 2.0], [3.0, 4.0]]))
+        indata = np.array([
+            [1.0, 2.0, -6.0, 30.0, 0.0],
+            [3.0, 99.0, -5.0, 21.0, 0.0],
+        ], dtype=float)
+        predOut = mapping.applyForward(indata)
+        workspace = ast.TransformWorkspace(mapping)
+
+        for args in ((), (workspace,)):
+            data = indata.copy()
+            mapping.applyForwardInPlace(data, *args)
+            assert_allclose(data, predOut)
+            mapping.applyInverseInPlace(data, *args)
+            assert_allclose(data, indata)
+
+        # in-place transforms require nIn == nOut
+        polyMap = makeTwoWayPolyMap(2, 3)
+        with self.assertRaises(ValueError):
+            polyMap.applyForwardInPlace(indata.copy())
+
+    def test_TransformWorkspace(self):
+        """Test transforming several batches using a TransformWorkspace
+        """
+        mapping = makeTwoWayPolyMap(2, 3)
+        workspace = ast.TransformWorkspace(mapping, 10)
+        self.assertEqual(workspace.nIn, 2)
+        self.assertEqual(workspace.nOut, 3)
+        self.assertEqual(workspace.capacity, 10)
+        self.assertEqual(workspace.nAllocations, 1)
+
+        # batches no larger than the initial size reuse the buffers
+        for nPoints in (10, 3, 7, 0):
+            indata = workspace.getInput(nPoints)
+            self.assertEqual(indata.shape, (2, nPoints))
+            indata[:] = np.random.uniform(-1, 1, size=(2, nPoints))
+            outdata = mapping.applyForward(indata, workspace)
+            self.assertEqual(outdata.shape, (3, nPoints))
+            assert_allclose(outdata, mapping.applyForward(indata.copy()))
+            self.assertEqual(workspace.nAllocations, 1)
+
+            # the inverse uses the same buffers with the axes swapped
+            outcopy = outdata.copy()
+            backdata = mapping.applyInverse(outcopy, workspace)
+            self.assertEqual(backdata.shape, (2, nPoints))
+            assert_allclose(backdata, mapping.applyInverse(outcopy))
+            self.assertEqual(workspace.nAllocations, 1)
+
+        # a larger batch grows the buffers
+        indata = np.random.uniform(-1, 1, size=(2, 25))
+        outdata = mapping.applyForward(indata, workspace)
+        assert_allclose(outdata, mapping.applyForward(indata))
+        self.assertGreaterEqual(workspace.capacity, 25)
+        self.assertEqual(workspace.nAllocations, 2)
+
+        # a workspace cannot be used with a mapping with different nIn or nOut
+        with self.assertRaises(ValueError):
+            self.zoommap.applyForward(indata, workspace)
+        with self.assertRaises(ValueError):
+            self.zoommap.applyForwardInPlace(indata, workspace)
+
+    def test_TranChunks(self):
+        """Test transforming arrays with more points than fit in one AST call
+
+        Real arrays with more than 2^31 points are too large for a unit test,
+        so reduce the maximum number of points per AST call instead.
+        """
+        mapping = makeTwoWayPolyMap(2, 3)
+        # use a view into a larger array, as for a section of a large catalog
+        bigArr = np.random.uniform(-1, 1, size=(2, 300))
+        indata = bigArr[:, 50:150]
+        predOut = mapping.applyForward(indata)
+        predBack = mapping.applyInverse(predOut)
+        gridLbnd = [-3, 2]
+        gridUbnd = [6, 6]
+        nGridPts = 10 * 5
+        predGrid = mapping.tranGridForward(gridLbnd, gridUbnd, 0, 100, nGridPts)
+
+        oldMaxChunk = getMaxTranChunk()
+        try:
+            # 7 and 3 do not divide the number of points or a grid row evenly;
+            # 3 is smaller than a grid row, so the grid must be split along both axes
+            for maxChunk in (7, 3, 1):
+                setMaxTranChunk(maxChunk)
+                self.assertEqual(getMaxTranChunk(), maxChunk)
+                outdata = mapping.applyForward(indata)
+                assert_allclose(outdata, predOut)
+                assert_allclose(mapping.applyInverse(predOut), predBack)
+                assert_allclose(mapping.tranGridForward(gridLbnd, gridUbnd, 0, 100, nGridPts), predGrid)
+        finally:
+            setMaxTranChunk(oldMaxChunk)
+
+        setMaxTranChunk(0)
+        self.assertEqual(getMaxTranChunk(), 2**31 - 1)
+        with self.assertRaises(ValueError):
+            setMaxTranChunk(2**31)
+
+    def test_ApplyFloat32(self):
+        """Test Mapping.applyForward and applyInverse with float32 arrays
+        """
+        mapping = makeTwoWayPolyMap(2, 3)
+        # more points than one block of the float transform, not a multiple of the block size
+        indata = np.random.uniform(-1, 1, size=(2, 2500)).astype(np.float32)
+        predOut = mapping.applyForward(indata.astype(np.float64))
+        outdata = mapping.applyForward(indata)
+        self.assertEqual(outdata.dtype, np.float32)
+        self.assertEqual(outdata.shape, (3, 2500))
+        assert_allclose(outdata, predOut, rtol=1e-6, atol=1e-6)
+
+        predBack = mapping.applyInverse(outdata.astype(np.float64))
+        backdata = mapping.applyInverse(outdata)
+        self.assertEqual(backdata.dtype, np.float32)
+        assert_allclose(backdata, predBack, rtol=1e-6, atol=1e-6)
+
+        # float64 arrays still use double precision
+        self.assertEqual(mapping.applyForward(indata.astype(np.float64)).dtype, np.float64)
+
+        # NaN is preserved
+        nanData = np.array([[1.0, np.nan], [2.0, 3.0]], dtype=np.float32)
+        outNan = self.zoommap.applyForward(nanData)
+        assert_allclose(outNan[:, 0], [1.3, 2.6], rtol=1e-6)
+        self.assertTrue(np.isnan(outNan[0, 1]))
+
+        self.assertEqual(mapping.applyForward(np.zeros((2, 0), dtype=np.float32)).shape, (3, 0))
+        with self.assertRaises(ValueError):
+            mapping.applyForward(np.zeros((3, 5), dtype=np.float32))
+
+    def test_NanInputIsBad(self):
+        """Test TransformWorkspace.nanInputIsBad and the replacement of AST__BAD with NaN in pieces
+        """
+        mapping = makeTwoWayPolyMap(2, 2)
+        # more points than AST is given at a time, with NaN in both the first and last piece
+        indata = np.random.uniform(-1, 1, size=(2, 5000))
+        indata[0, 3] = np.nan
+        indata[1, 4998] = np.nan
+        finite = np.all(np.isfinite(indata), axis=0)
+        incopy = indata.copy()
+        predOut = mapping.applyForward(indata)
+        self.assertTrue(np.all(np.isnan(predOut[:, 3])))
+        self.assertTrue(np.all(np.isnan(predOut[:, 4998])))
+
+        workspace = ast.TransformWorkspace(mapping)
+        self.assertFalse(workspace.nanInputIsBad)
+        workspace.nanInputIsBad = True
+        self.assertTrue(workspace.nanInputIsBad)
+        # the option only affects transforms that use the workspace
+        self.assertFalse(ast.TransformWorkspace(mapping).nanInputIsBad)
+
+        oldMaxChunk = getMaxTranChunk()
+        try:
+            for maxChunk in (0, 7):
+                setMaxTranChunk(maxChunk)
+                outdata = mapping.applyForward(indata, workspace)
+                assert_array_equal(indata, incopy)
+                assert_allclose(outdata[:, finite], predOut[:, finite])
+                self.assertTrue(np.all(np.isnan(outdata[:, ~finite])))
+
+                inPlace = indata.copy()
+                mapping.applyForwardInPlace(inPlace, workspace)
+                assert_allclose(inPlace[:, finite], predOut[:, finite])
+                self.assertTrue(np.all(np.isnan(inPlace[:, ~finite])))
+        finally:
+            setMaxTranChunk(oldMaxChunk)
+
     def test_ZeroPoints(self):
         """Test that Mapping.applyForward and applyInverse can handle zero points
         """
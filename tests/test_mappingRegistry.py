@@ -0,0 +1,109 @@
+from __future__ import absolute_import, division, print_function
+import unittest
+
+import numpy as np
+from numpy.testing import assert_allclose
+
+import astshim as ast
+from astshim.test import MappingTestCase, makeTwoWayPolyMap
+
+
+class TestMappingRegistry(MappingTestCase):
+
+    def setUp(self):
+        self.polyMap = makeTwoWayPolyMap(2, 2)
+
+    def test_Intern(self):
+        registry = ast.MappingRegistry()
+        self.assertEqual(registry.nEntries, 0)
+        self.assertEqual(registry.bytes, 0)
+
+        shared = registry.intern(self.polyMap)
+        self.assertEqual(shared.show(), self.polyMap.show())
+        self.assertEqual(registry.nEntries, 1)
+        self.assertEqual(registry.nLookups, 1)
+        self.assertEqual(registry.nHits, 0)
+        self.assertGreater(registry.bytes, 0)
+        self.assertEqual(registry.bytesSaved, 0)
+
+        # a copy is structurally identical, so the shared instance is reused
+        polyMapCopy = self.polyMap.copy()
+        sharedCopy = registry.intern(polyMapCopy)
+        self.assertEqual(sharedCopy.show(), shared.show())
+        self.assertEqual(registry.nEntries, 1)
+        self.assertEqual(registry.nLookups, 2)
+        self.assertEqual(registry.nHits, 1)
+        self.assertEqual(registry.bytesSaved, polyMapCopy.objSize)
+
+        # a different mapping gets its own entry
+        zoomMap = ast.ZoomMap(2, 1.5)
+        sharedZoom = registry.intern(zoomMap)
+        self.assertEqual(sharedZoom.className, "ZoomMap")
+        self.assertEqual(registry.nEntries, 2)
+        self.assertEqual(registry.nHits, 1)
+
+        # mappings that differ only in an attribute are distinct
+        zoomMap.ident = "zoom"
+        registry.intern(zoomMap)
+        self.assertEqual(registry.nEntries, 3)
+
+        # Python gets a copy, so changing it does not change the shared instance
+        sharedZoom.ident = "changed"
+        self.assertEqual(registry.intern(ast.ZoomMap(2, 1.5)).ident, "")
+        self.assertEqual(registry.nEntries, 3)
+        self.assertEqual(registry.nHits, 2)
+
+        registry.clear()
+        self.assertEqual(registry.nEntries, 0)
+        self.assertEqual(registry.nLookups, 0)
+        self.assertEqual(registry.bytes, 0)
+        self.assertEqual(registry.bytesSaved, 0)
+
+    def test_Purge(self):
+        registry = ast.MappingRegistry()
+        # the router keeps a reference to the shared instance of the PolyMap
+        frameDict = ast.FrameDict(ast.Frame(2, "Domain=PIXELS"))
+        frameDict.addFrame("PIXELS", self.polyMap, ast.Frame(2, "Domain=FOCAL_PLANE"))
+        router = ast.FrameSetRouter(frameDict, registry=registry)
+        router.precompute([("PIXELS", "FOCAL_PLANE")])
+        registry.intern(ast.ZoomMap(2, 1.5))
+        self.assertEqual(registry.nEntries, 2)
+        bytesBefore = registry.bytes
+
+        # only the ZoomMap is referenced by the registry alone
+        self.assertEqual(registry.purge(), 1)
+        self.assertEqual(registry.nEntries, 1)
+        self.assertLess(registry.bytes, bytesBefore)
+
+        del router
+        self.assertEqual(registry.purge(), 1)
+        self.assertEqual(registry.nEntries, 0)
+        self.assertEqual(registry.bytes, 0)
+
+    def test_FrameSetRouter(self):
+        """Routers for FrameSets with a common distortion share its mapping"""
+        registry = ast.MappingRegistry()
+        indata = np.random.uniform(-1, 1, size=(2, 20))
+        routers = []
+        for i in range(5):
+            frameDict = ast.FrameDict(ast.Frame(2, "Domain=PIXELS"))
+            frameDict.addFrame("PIXELS", self.polyMap, ast.Frame(2, "Domain=FOCAL_PLANE"))
+            frameDict.addFrame("FOCAL_PLANE", ast.ShiftMap([i, 2.0 * i]), ast.Frame(2, "Domain=SKY"))
+            router = ast.FrameSetRouter(frameDict, registry=registry)
+            self.assertIs(router.registry, registry)
+            assert_allclose(router.transform("PIXELS", "FOCAL_PLANE", indata),
+                            self.polyMap.applyForward(indata))
+            router.precompute([("FOCAL_PLANE", "SKY")])
+            routers.append(router)
+
+        # one shared distortion plus one distinct shift per FrameSet
+        self.assertEqual(registry.nLookups, 10)
+        self.assertEqual(registry.nEntries, 6)
+        self.assertEqual(registry.nHits, 4)
+        self.assertGreater(registry.bytesSaved, 0)
+
+        self.assertIsNone(ast.FrameSetRouter(frameDict).registry)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -1,5 +1,6 @@
 from __future__ import absolute_import, division, print_function
 import multiprocessing
+import pickle
 import unittest
 
 import numpy as np
@@ -166,6 +167,32 @@ class TestObject(ObjectTestCase):
         results = pool.map(ast.UnitMap, params)
         self.assertEqual(results, [ast.UnitMap(naxes)]*numProcesses)
 
+    def test_submoduleAliases(self):
+        """Test that the modules each class used to live in still work,
+        including for unpickling
+        """
+        import astshim.mapping
+        from astshim.keyMap.keyMap import KeyMap
+        self.assertIs(astshim.mapping.Mapping, ast.Mapping)
+        self.assertIs(KeyMap, ast.KeyMap)
+        self.assertEqual(ast.ZoomMap.__module__, "astshim.zoomMap")
+        self.assertEqual(ast.ObjectMaker.__module__, "astshim.object")
+        # a function takes precedence over a submodule of the same name, as it always has
+        self.assertTrue(callable(ast.census))
+
+        obj = ast.ZoomMap(2, 1.3)
+        # a protocol 0 pickle of obj, as written when astshim had one extension module per class
+        state = obj.show(False).replace("\\", "\\u005c").replace("\n", "\\u000a")
+        oldPickle = b"castshim.object\nObjectMaker\n(tR(V" + state.encode("raw_unicode_escape") + b"\ntR."
+        self.assertEqual(pickle.loads(oldPickle), obj)
+
+        newPickle = pickle.dumps(obj, 2)
+        self.assertIn(b"astshim.object", newPickle)
+        self.assertEqual(pickle.loads(newPickle), obj)
+        # pickles that refer to the extension module itself can be read, too
+        extPickle = newPickle.replace(b"astshim.object", b"astshim._astshimLib")
+        self.assertEqual(pickle.loads(extPickle), obj)
+
     def test_show(self):
         # pick an object with no floats so we don't have to worry
         # about the float representation
@@ -0,0 +1,70 @@
+from __future__ import absolute_import, division, print_function
+import unittest
+
+import numpy as np
+from numpy.testing import assert_allclose
+
+import astshim as ast
+from astshim.test import MappingTestCase
+
+
+class TestTabulate1D(MappingTestCase):
+
+    def setUp(self):
+        self.mathMap = ast.MathMap(1, 1, ["y = exp(x / 3) + sin(x)"], ["x = y"])
+        self.lo = -2.0
+        self.hi = 5.0
+
+    def checkTabulation(self, mapping, tabulation, tol):
+        self.assertIsInstance(tabulation.lutMap, ast.LutMap)
+        self.assertLessEqual(tabulation.maxError, tol)
+        self.assertGreaterEqual(tabulation.nEntries, 2)
+        self.assertGreaterEqual(tabulation.nIterations, 1)
+        self.assertAlmostEqual(tabulation.start, self.lo)
+        self.assertAlmostEqual(tabulation.start + (tabulation.nEntries - 1) * tabulation.inc, self.hi)
+
+        # check the error at points that were not used to verify the table
+        x = np.random.uniform(self.lo, self.hi, size=1000)
+        approx = tabulation.lutMap.applyForward(x)
+        exact = mapping.applyForward(x)
+        self.assertLessEqual(np.max(np.abs(approx - exact)), tol * 1.5)
+
+    def test_Tolerance(self):
+        previousNEntries = 0
+        for tol in (1e-2, 1e-4, 1e-6):
+            tabulation = ast.tabulate1D(self.mathMap, self.lo, self.hi, tol)
+            self.checkTabulation(self.mathMap, tabulation, tol)
+            self.assertGreater(tabulation.nEntries, previousNEntries)
+            previousNEntries = tabulation.nEntries
+
+    def test_Linear(self):
+        """A linear mapping is tabulated exactly by the first table"""
+        zoomMap = ast.ZoomMap(1, 2.5)
+        tabulation = ast.tabulate1D(zoomMap, self.lo, self.hi, 1e-10)
+        self.assertEqual(tabulation.nIterations, 1)
+        self.checkTabulation(zoomMap, tabulation, 1e-10)
+        # a monotonic table has an inverse
+        self.assertTrue(tabulation.lutMap.hasInverse)
+
+    def test_Errors(self):
+        with self.assertRaises(ValueError):
+            ast.tabulate1D(ast.ZoomMap(2, 2.5), self.lo, self.hi, 1e-3)
+        with self.assertRaises(ValueError):
+            ast.tabulate1D(self.mathMap, self.hi, self.lo, 1e-3)
+        with self.assertRaises(ValueError):
+            ast.tabulate1D(self.mathMap, self.lo, self.hi, 0)
+        with self.assertRaises(ValueError):
+            ast.tabulate1D(self.mathMap, self.lo, self.hi, 1e-3, maxEntries=1)
+
+        # too few entries allowed to reach the tolerance
+        with self.assertRaises(RuntimeError):
+            ast.tabulate1D(self.mathMap, self.lo, self.hi, 1e-8, maxEntries=100)
+
+        # the mapping is invalid within the range
+        sqrtMap = ast.MathMap(1, 1, ["y = sqrt(x)"], ["x = y * y"])
+        with self.assertRaises(RuntimeError):
+            ast.tabulate1D(sqrtMap, -1.0, 1.0, 1e-3)
+
+
+if __name__ == "__main__":
+    unittest.main()
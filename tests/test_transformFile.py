@@ -0,0 +1,112 @@
+from __future__ import absolute_import, division, print_function
+import os
+import shutil
+import tempfile
+import unittest
+
+import numpy as np
+from numpy.testing import assert_allclose, assert_array_equal
+
+import astshim as ast
+from astshim.test import MappingTestCase, makeTwoWayPolyMap
+
+
+class TestTransformFile(MappingTestCase):
+
+    def setUp(self):
+        self.dirName = tempfile.mkdtemp()
+        self.inPath = os.path.join(self.dirName, "in.dat")
+        self.outPath = os.path.join(self.dirName, "out.dat")
+        self.mapping = makeTwoWayPolyMap(2, 3)
+        self.nPoints = 1001
+        self.indata = np.random.uniform(-1, 1, size=(2, self.nPoints))
+
+    def tearDown(self):
+        shutil.rmtree(self.dirName)
+
+    def writeInput(self, data, layout):
+        """Write data with dimensions (nAxes, nPoints) to the input file"""
+        if layout == ast.ColumnLayout.INTERLEAVED:
+            data = data.T
+        np.ascontiguousarray(data).tofile(self.inPath)
+
+    def readOutput(self, nAxes, layout):
+        """Read the output file and return data with dimensions (nAxes, nPoints)"""
+        data = np.fromfile(self.outPath)
+        if layout == ast.ColumnLayout.INTERLEAVED:
+            return data.reshape(-1, nAxes).T
+        return data.reshape(nAxes, -1)
+
+    def test_Layouts(self):
+        """Test both layouts, both directions, and single- and multi-threaded processing"""
+        for layout in (ast.ColumnLayout.INTERLEAVED, ast.ColumnLayout.COLUMNS):
+            for forward in (True, False):
+                for nThreads in (1, 3):
+                    spec = ast.ColumnSpec()
+                    spec.layout = layout
+                    spec.forward = forward
+                    spec.blockSize = 100
+                    spec.nThreads = nThreads
+                    if forward:
+                        indata = self.indata
+                        predOut = self.mapping.applyForward(indata)
+                    else:
+                        indata = self.mapping.applyForward(self.indata)
+                        predOut = self.mapping.applyInverse(indata)
+                    self.writeInput(indata, layout)
+
+                    result = ast.transformFile(self.mapping, self.inPath, self.outPath, spec)
+                    self.assertEqual(result.nPoints, self.nPoints)
+                    self.assertEqual(result.nBlocks, 11)
+                    self.assertEqual(result.nBadPoints, 0)
+                    outdata = self.readOutput(predOut.shape[0], layout)
+                    assert_allclose(outdata, predOut)
+
+    def test_BadValues(self):
+        """Test NaN inputs and the value used for bad outputs"""
+        zoomMap = ast.ZoomMap(2, 3.0)
+        indata = self.indata.copy()
+        indata[0, 5] = np.nan
+        indata[1, 17] = np.nan
+        self.writeInput(indata, ast.ColumnLayout.INTERLEAVED)
+
+        spec = ast.ColumnSpec()
+        result = ast.transformFile(zoomMap, self.inPath, self.outPath, spec)
+        self.assertEqual(result.nBadPoints, 2)
+        outdata = self.readOutput(2, ast.ColumnLayout.INTERLEAVED)
+        self.assertTrue(np.isnan(outdata[0, 5]))
+        self.assertTrue(np.isnan(outdata[1, 17]))
+        good = np.isfinite(indata)
+        assert_allclose(outdata[good], indata[good] * 3.0)
+
+        badValue = -99.0
+        spec.badOutput = badValue
+        result = ast.transformFile(zoomMap, self.inPath, self.outPath, spec)
+        self.assertEqual(result.nBadPoints, 2)
+        outdata = self.readOutput(2, ast.ColumnLayout.INTERLEAVED)
+        assert_array_equal(outdata[~good], [badValue, badValue])
+        self.assertFalse(np.any(np.isnan(outdata)))
+
+    def test_EmptyFile(self):
+        open(self.inPath, "wb").close()
+        result = ast.transformFile(self.mapping, self.inPath, self.outPath)
+        self.assertEqual(result.nPoints, 0)
+        self.assertEqual(os.path.getsize(self.outPath), 0)
+
+    def test_Errors(self):
+        self.writeInput(self.indata, ast.ColumnLayout.INTERLEAVED)
+        # the input size must be a whole number of points
+        with self.assertRaises(ValueError):
+            ast.transformFile(ast.ZoomMap(3, 2.0), self.inPath, self.outPath)
+        with self.assertRaises(ValueError):
+            ast.transformFile(self.mapping, self.inPath, self.inPath)
+        spec = ast.ColumnSpec()
+        spec.blockSize = 0
+        with self.assertRaises(ValueError):
+            ast.transformFile(self.mapping, self.inPath, self.outPath, spec)
+        with self.assertRaises(RuntimeError):
+            ast.transformFile(self.mapping, os.path.join(self.dirName, "missing.dat"), self.outPath)
+
+
+if __name__ == "__main__":
+    unittest.main()
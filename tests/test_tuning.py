@@ -0,0 +1,57 @@
+from __future__ import absolute_import, division, print_function
+import unittest
+
+import astshim as ast
+from astshim.test import MappingTestCase
+
+
+class TestTuning(MappingTestCase):
+
+    def test_TuneInt(self):
+        for param in (ast.TuneParam.ObjectCaching, ast.TuneParam.MemoryCaching):
+            initialValue = ast.tune(param)
+            oldValue = ast.tune(param, 1)
+            self.assertEqual(oldValue, initialValue)
+            self.assertEqual(ast.tune(param), 1)
+            self.assertEqual(ast.tune(param, initialValue), 1)
+            self.assertEqual(ast.tune(param), initialValue)
+
+    def test_TuneString(self):
+        param = ast.TuneStringParam.HRDel
+        initialValue = ast.tune(param)
+        self.assertEqual(ast.tune(param, "%-%^50+%s70+h%+"), initialValue)
+        self.assertEqual(ast.tune(param), "%-%^50+%s70+h%+")
+        ast.tune(param, initialValue)
+        self.assertEqual(ast.tune(param), initialValue)
+
+    def test_TuneName(self):
+        self.assertEqual(ast.getTuneName(ast.TuneParam.ObjectCaching), "ObjectCaching")
+        self.assertEqual(ast.getTuneName(ast.TuneParam.MemoryCaching), "MemoryCaching")
+        self.assertEqual(ast.getTuneName(ast.TuneStringParam.LRDel), "LRDel")
+
+    def test_ScopedTune(self):
+        param = ast.TuneParam.ObjectCaching
+        initialValue = ast.tune(param)
+        with ast.ScopedTune(param, 1):
+            self.assertEqual(ast.tune(param), 1)
+            # objects still work normally while caching is enabled
+            for i in range(10):
+                shiftMap = ast.ShiftMap([float(i), 0.0])
+                self.assertAlmostEqual(shiftMap.applyForward([1.0, 2.0])[0], 1.0 + i)
+        self.assertEqual(ast.tune(param), initialValue)
+
+        scopedTune = ast.ScopedTune(param, 1)
+        self.assertEqual(ast.tune(param), 1)
+        scopedTune.restore()
+        self.assertEqual(ast.tune(param), initialValue)
+        scopedTune.restore()
+        self.assertEqual(ast.tune(param), initialValue)
+
+        with self.assertRaises(RuntimeError):
+            with ast.ScopedTune(param, 1):
+                raise RuntimeError("test exception")
+        self.assertEqual(ast.tune(param), initialValue)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -1,5 +1,6 @@
 from __future__ import absolute_import, division, print_function
 import os.path
+import re
 import unittest
 
 import astshim as ast
@@ -43,6 +44,70 @@ class TestXmlChan(ObjectTestCase):
         zoommap = ast.ZoomMap(1, 0.5)
         self.checkXmlPersistence(sstream=sstream, chan=chan, obj=zoommap)
 
+    def test_XmlChanReadAll(self):
+        objects = [ast.ZoomMap(2, 0.5 * (i + 1)) for i in range(10)]
+        frameSet = ast.FrameSet(ast.Frame(2, "Domain=A"))
+        frameSet.addFrame(ast.FrameSet.CURRENT, ast.ShiftMap([1.0, 2.0]), ast.Frame(2, "Domain=B"))
+        objects.append(frameSet)
+        for options in ("", 'XmlFormat="QUOTED"', 'XmlPrefix="foo"'):
+            sstream = ast.StringStream()
+            chan = ast.XmlChan(sstream, options)
+            for obj in objects:
+                chan.write(obj)
+            sstream.sinkToSource()
+
+            # an XML declaration and comments between objects are skipped
+            text = '<?xml version="1.0"?>\n<!-- objects -->\n' + sstream.getSourceData()
+            readObjects = ast.XmlChan(ast.StringStream(text)).readAll(maxLookahead=2)
+            self.assertEqual([obj.show() for obj in readObjects], [obj.show() for obj in objects])
+
+            # all on one line
+            reader = ast.ChannelReader(ast.XmlChan(ast.StringStream(text.replace("\n", " "))))
+            self.assertEqual([obj.show() for obj in reader], [obj.show() for obj in objects])
+
+        # a single line much longer than the blocks the reader reads, so objects span blocks
+        manyObjects = [ast.ZoomMap(2, 0.5 * (i + 1)) for i in range(1000)]
+        sstream = ast.StringStream()
+        chan = ast.XmlChan(sstream)
+        for obj in manyObjects:
+            chan.write(obj)
+        sstream.sinkToSource()
+        line = sstream.getSourceData().replace("\n", " ")
+        self.assertGreater(len(line), 128 * 1024)
+        readObjects = ast.XmlChan(ast.StringStream(line)).readAll()
+        self.assertEqual([obj.show() for obj in readObjects], [obj.show() for obj in manyObjects])
+
+        # a truncated document
+        truncated = text[:text.rfind("</")]
+        with self.assertRaises(RuntimeError):
+            ast.XmlChan(ast.StringStream(truncated)).readAll()
+
+    def test_XmlChanReadAllWrapped(self):
+        """Test reading objects nested in an element that is not an AST object
+        """
+        objects = [ast.ZoomMap(2, 0.5 * (i + 1)) for i in range(5)]
+        objects.append(ast.SeriesMap(ast.ShiftMap([1.0, 2.0]), ast.UnitMap(2)))
+        for options in ("", 'XmlPrefix="foo"'):
+            sstream = ast.StringStream()
+            chan = ast.XmlChan(sstream, options)
+            for obj in objects:
+                chan.write(obj)
+            sstream.sinkToSource()
+            text = sstream.getSourceData()
+
+            wrapped = '<?xml version="1.0"?>\n<objects>\n<group>\n%s</group>\n</objects>\n' % (text,)
+            readObjects = ast.XmlChan(ast.StringStream(wrapped)).readAll(maxLookahead=2)
+            self.assertEqual([obj.show() for obj in readObjects], [obj.show() for obj in objects])
+
+            # the namespace of the objects may be declared by the enclosing element
+            if options:
+                nsDecl = re.search(r'\s(xmlns:foo="[^"]*")', text).group(1)
+                body = re.sub(r"\s" + re.escape(nsDecl), "", text)
+                self.assertNotIn(nsDecl, body)
+                wrapped = "<objects %s>\n%s</objects>\n" % (nsDecl, body)
+                reader = ast.ChannelReader(ast.XmlChan(ast.StringStream(wrapped)))
+                self.assertEqual([obj.show() for obj in reader], [obj.show() for obj in objects])
+
     def checkXmlPersistence(self, sstream, chan, obj):
         """Check that an Ast object can be persisted and unpersisted
         """